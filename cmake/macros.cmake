@@ -91,3 +91,24 @@ function (add_catch_test testname)
         add_dependencies(check ${testname})
     endif ( ENABLE_UNIT_TESTS OR ENABLE_BENCHMARK_TESTS )
 endfunction (add_catch_test)
+
+# benchmarks are not run by check; make benchmark runs them all and writes
+# the results in Catch's xml format to benchmark/<name>.xml in the build tree
+function (add_benchmark testname)
+    if ( ENABLE_BENCHMARK_TESTS )
+        set(multiValueArgs SOURCES LIBS)
+        cmake_parse_arguments(Bench "" "" "${multiValueArgs}" ${ARGN})
+        add_executable(${testname}
+            EXCLUDE_FROM_ALL
+            ${testname}.cc
+            ${Bench_SOURCES}
+            $<TARGET_OBJECTS:catch_main>
+        )
+        target_link_libraries(${testname} PRIVATE ${Bench_LIBS})
+        add_custom_target(run_${testname}
+            COMMAND ${testname} -r xml -o ${BENCHMARK_OUTPUT_DIR}/${testname}.xml
+            DEPENDS ${testname}
+        )
+        add_dependencies(benchmark run_${testname})
+    endif ( ENABLE_BENCHMARK_TESTS )
+endfunction (add_benchmark)
@@ -14,6 +14,7 @@ test_big_endian(WORDS_BIGENDIAN)
 #--------------------------------------------------------------------------
 
 check_function_exists(malloc_trim HAVE_MALLOC_TRIM)
+check_function_exists(malloc_usable_size HAVE_MALLOC_USABLE_SIZE)
 check_function_exists(memrchr HAVE_MEMRCHR)
 check_function_exists(sigaction HAVE_SIGACTION)
 check_function_exists(basename_r HAVE_BASENAME_R)
@@ -21,6 +21,13 @@
 #define CODECS_CHECKSUM_H
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CHECKSUM_SIMD
+#endif
 
 #include <protocols/protocol_ids.h>
 
@@ -79,94 +86,109 @@ inline uint16_t ip_cksum(const uint16_t* buf, std::size_t len);
  */
 namespace detail
 {
-inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
+// the one's complement sum of 16 bit words can be taken over 32 bit words
+// and folded since 2^16 == 1 mod 2^16 - 1.  the sums are kept in 64 bit
+// lanes so they never overflow.
+
+inline uint64_t sum_words(const uint8_t*& p, std::size_t& len)
+{
+    uint64_t sum = 0;
+
+    while ( len >= 4 )
+    {
+        uint32_t w;
+        memcpy(&w, p, sizeof(w));
+        sum += w;
+        p += 4;
+        len -= 4;
+    }
+    return sum;
+}
+
+#ifdef CHECKSUM_SIMD
+inline uint64_t sum_sse2(const uint8_t*& p, std::size_t& len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+
+    while ( len >= 16 )
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, zero));
+        p += 16;
+        len -= 16;
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    return lanes[0] + lanes[1];
+}
+
+__attribute__((target("avx2")))
+inline uint64_t sum_avx2(const uint8_t*& p, std::size_t& len)
 {
-    const uint16_t* sp = buf;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc0 = zero;
+    __m256i acc1 = zero;
 
-    // if pointer is 16 bit aligned calculate checksum in tight loop...
-    // gcc 5.4 -O3 generates unaligned quadword instructions that crash; fixed in gcc 8.0.1
-    if ( !( reinterpret_cast<std::uintptr_t>(sp) & 0x01 ) )
+    while ( len >= 64 )
     {
-        while ( len > 1 )
-        {
-            cksum += *sp++;
-            len -= 2;
-        }
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)p);
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)(p + 32));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+        acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v1, zero));
+        acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v1, zero));
+        p += 64;
+        len -= 64;
     }
-    else if ( len > 1 )
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+inline bool use_avx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+#endif
+
+inline uint16_t cksum_add(const uint16_t* buf, std::size_t len, uint32_t cksum)
+{
+    const uint8_t* p = (const uint8_t*)buf;
+    uint64_t sum = cksum;
+
+#ifdef CHECKSUM_SIMD
+    if ( len >= 128 and use_avx2() )
+        sum += sum_avx2(p, len);
+
+    if ( len >= 16 )
+        sum += sum_sse2(p, len);
+#endif
+
+    sum += sum_words(p, len);
+
+    if ( len & 0x02 )
     {
-        std::size_t sn = ((len / 2) & 0xF);  // == len/2 % 16
-        std::size_t n = (((len / 2) + 15) / 16);   // ceiling of (len / 2) / 16
-
-        switch (sn)
-        {
-        case 0:
-            sn = 16;
-            cksum += sp[15];    // fallthrough
-        case 15:
-            cksum += sp[14];    // fallthrough
-        case 14:
-            cksum += sp[13];    // fallthrough
-        case 13:
-            cksum += sp[12];    // fallthrough
-        case 12:
-            cksum += sp[11];    // fallthrough
-        case 11:
-            cksum += sp[10];    // fallthrough
-        case 10:
-            cksum += sp[9];     // fallthrough
-        case 9:
-            cksum += sp[8];     // fallthrough
-        case 8:
-            cksum  += sp[7];    // fallthrough
-        case 7:
-            cksum += sp[6];     // fallthrough
-        case 6:
-            cksum += sp[5];     // fallthrough
-        case 5:
-            cksum += sp[4];     // fallthrough
-        case 4:
-            cksum += sp[3];     // fallthrough
-        case 3:
-            cksum += sp[2];     // fallthrough
-        case 2:
-            cksum += sp[1];     // fallthrough
-        case 1:
-            cksum += sp[0];
-        }
-        sp += sn;
-
-        /* unroll loop using Duff's device. */
-        while (--n > 0)
-        {
-            cksum += sp[0];
-            cksum += sp[1];
-            cksum += sp[2];
-            cksum += sp[3];
-            cksum += sp[4];
-            cksum += sp[5];
-            cksum += sp[6];
-            cksum += sp[7];
-            cksum += sp[8];
-            cksum += sp[9];
-            cksum += sp[10];
-            cksum += sp[11];
-            cksum += sp[12];
-            cksum += sp[13];
-            cksum += sp[14];
-            cksum += sp[15];
-            sp += 16;
-        }
+        uint16_t w;
+        memcpy(&w, p, sizeof(w));
+        sum += w;
+        p += 2;
     }
 
     // if len is odd, sum in the last byte...
     if ( len & 0x01 )
-        cksum += *((const uint8_t*) sp);
+        sum += *p;
 
-    cksum  = (cksum >> 16) + (cksum & 0x0000ffff);
-    cksum += (cksum >> 16);
+    sum = (sum >> 32) + (sum & 0xffffffff);
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum += (sum >> 16);
 
-    return (uint16_t)(~cksum);
+    return (uint16_t)(~sum);
 }
 
 inline void add_ipv4_pseudoheader(const Pseudoheader& ph4, uint32_t& cksum)
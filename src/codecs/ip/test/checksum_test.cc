@@ -0,0 +1,140 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// checksum_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <arpa/inet.h>
+
+#include <random>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "codecs/ip/checksum.h"
+
+// the straightforward 16 bit word sum from RFC 1071
+static uint16_t ref_cksum(const uint8_t* p, std::size_t len, uint32_t sum = 0)
+{
+    while ( len > 1 )
+    {
+        uint16_t w;
+        memcpy(&w, p, sizeof(w));
+        sum += w;
+        p += 2;
+        len -= 2;
+    }
+
+    if ( len )
+        sum += *p;
+
+    sum = (sum >> 16) + (sum & 0xffff);
+    sum += (sum >> 16);
+
+    return (uint16_t)(~sum);
+}
+
+static std::vector<uint8_t> make_buf(std::size_t len, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> buf(len + 1);
+
+    for ( auto& b : buf )
+        b = rng();
+
+    return buf;
+}
+
+TEST_CASE("lengths and alignments", "[checksum]")
+{
+    std::vector<uint8_t> buf = make_buf(2048, 1);
+
+    // odd offsets too, as the codecs get them with odd length headers
+    for ( unsigned off = 0; off < 2; ++off )
+    {
+        const uint8_t* p = buf.data() + off;
+
+        for ( std::size_t len = 0; len < 2048; ++len )
+        {
+            uint16_t expected = ref_cksum(p, len);
+            CHECK(checksum::cksum_add((const uint16_t*)p, len) == expected);
+        }
+    }
+}
+
+TEST_CASE("extremes", "[checksum]")
+{
+    std::vector<uint8_t> zero(1500, 0x00);
+    std::vector<uint8_t> ones(65535, 0xff);
+
+    CHECK(checksum::cksum_add((const uint16_t*)zero.data(), zero.size()) == 0xffff);
+    CHECK(checksum::cksum_add((const uint16_t*)ones.data(), ones.size()) ==
+        ref_cksum(ones.data(), ones.size()));
+
+    // a nonzero sum that folds to 0xffff must give 0, not 0xffff
+    uint16_t w[2] = { 0xfffe, 0x0001 };
+    CHECK(checksum::cksum_add(w, sizeof(w)) == 0);
+}
+
+TEST_CASE("verify", "[checksum]")
+{
+    std::vector<uint8_t> buf = make_buf(1460, 2);
+
+    // a buffer holding its own checksum sums to zero
+    buf[16] = buf[17] = 0;
+    uint16_t c = checksum::cksum_add((const uint16_t*)buf.data(), 1460);
+    memcpy(&buf[16], &c, sizeof(c));
+
+    CHECK(checksum::cksum_add((const uint16_t*)buf.data(), 1460) == 0);
+
+    checksum::Pseudoheader ph;
+    ph.hdr.sip = 0x0100000a;
+    ph.hdr.dip = 0x0200000a;
+    ph.hdr.zero = 0;
+    ph.hdr.protocol = IpProtocol::TCP;
+    ph.hdr.len = htons(1460);
+
+    uint32_t sum = 0;
+    for ( auto h : ph.arr )
+        sum += h;
+
+    CHECK(checksum::tcp_cksum((const uint16_t*)buf.data(), 1460, ph) ==
+        ref_cksum(buf.data(), 1460, sum));
+}
+
+#ifdef BENCHMARK_TEST
+TEST_CASE("checksum benchmarks", "[checksum]")
+{
+    std::vector<uint8_t> buf = make_buf(1460, 3);
+
+    BENCHMARK("reference 1460")
+    { return ref_cksum(buf.data(), 1460); };
+
+    BENCHMARK("cksum_add 1460")
+    { return checksum::cksum_add((const uint16_t*)buf.data(), 1460); };
+
+    BENCHMARK("cksum_add 1460 unaligned")
+    { return checksum::cksum_add((const uint16_t*)(buf.data() + 1), 1459); };
+
+    BENCHMARK("cksum_add 40")
+    { return checksum::cksum_add((const uint16_t*)buf.data(), 40); };
+}
+#endif
+
@@ -28,11 +28,13 @@
 using namespace snort;
 
 extern const BaseApi* file_connector[];
+extern const BaseApi* shm_connector[];
 extern const BaseApi* tcp_connector[];
 
 void load_connectors()
 {
     PluginManager::load_plugins(file_connector);
+    PluginManager::load_plugins(shm_connector);
     PluginManager::load_plugins(tcp_connector);
 }
 
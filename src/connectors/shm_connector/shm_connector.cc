@@ -0,0 +1,433 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2015-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shm_connector.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "log/messages.h"
+#include "main/thread.h"
+#include "profiler/profiler_defs.h"
+#include "utils/util.h"
+
+#include "shm_connector_module.h"
+
+using namespace snort;
+
+// the ring counters are shared with another process
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shm_connector requires lock free 64 bit atomics");
+
+/* Globals ****************************************************************/
+
+THREAD_LOCAL ShmConnectorStats shm_connector_stats;
+THREAD_LOCAL ProfileStats shm_connector_perfstats;
+
+static inline uint64_t record_size(uint32_t length)
+{ return (sizeof(ShmConnectorMsgHdr) + (uint64_t)length + 7) & ~(uint64_t)7; }
+
+ShmConnectorMsgHandle::ShmConnectorMsgHandle(const uint32_t length) : source(HEAP)
+{
+    connector_msg.length = length;
+    connector_msg.data = new uint8_t[length];
+}
+
+ShmConnectorMsgHandle::ShmConnectorMsgHandle(
+    uint8_t* data, uint32_t length, uint64_t end, Source source) : end(end), source(source)
+{
+    connector_msg.length = length;
+    connector_msg.data = data;
+}
+
+ShmConnectorMsgHandle::~ShmConnectorMsgHandle()
+{
+    if ( source == HEAP )
+        delete[] connector_msg.data;
+}
+
+ShmConnectorCommon::ShmConnectorCommon(ShmConnectorConfig::ShmConnectorConfigSet* conf)
+{
+    config_set = (ConnectorConfig::ConfigSet*)conf;
+}
+
+ShmConnectorCommon::~ShmConnectorCommon()
+{
+    for ( auto conf : *config_set )
+        delete conf;
+
+    config_set->clear();
+    delete config_set;
+}
+
+ShmConnector::ShmConnector(ShmConnectorConfig* cfg, uint8_t* segment, size_t segment_size) :
+    segment(segment), segment_size(segment_size)
+{
+    config = cfg;
+
+    ShmSegmentHdr* hdr = (ShmSegmentHdr*)segment;
+    size = hdr->ring_size.load(std::memory_order_relaxed);
+    mask = size - 1;
+
+    unsigned tx = ( cfg->side == ShmConnectorConfig::A ) ? 0 : 1;
+    unsigned rx = tx ^ 1;
+
+    uint8_t* data = segment + sizeof(ShmSegmentHdr);
+
+    tx_ring = &hdr->ring[tx];
+    tx_data = data + tx * size;
+    tx_pos = tx_ring->head.load(std::memory_order_relaxed);
+
+    rx_ring = &hdr->ring[rx];
+    rx_data = data + rx * size;
+    rx_pos = rx_ring->tail.load(std::memory_order_relaxed);
+}
+
+ShmConnector::~ShmConnector()
+{
+    munmap(segment, segment_size);
+}
+
+// returns nullptr if the ring is full
+ShmConnectorMsgHdr* ShmConnector::reserve(uint32_t length)
+{
+    const uint64_t need = record_size(length);
+    const uint64_t tail = tx_ring->tail.load(std::memory_order_acquire);
+    uint64_t pos = tx_pos;
+    uint64_t room = size - (pos & mask);
+
+    if ( need > room )
+    {
+        if ( pos + room + need - tail > size )
+            return nullptr;
+
+        ShmConnectorMsgHdr* skip = (ShmConnectorMsgHdr*)(tx_data + (pos & mask));
+        skip->connector_msg_length = room - sizeof(ShmConnectorMsgHdr);
+        skip->flags = ShmConnectorMsgHdr::SKIP;
+        pos += room;
+    }
+    else if ( pos + need - tail > size )
+        return nullptr;
+
+    ShmConnectorMsgHdr* hdr = (ShmConnectorMsgHdr*)(tx_data + (pos & mask));
+    hdr->connector_msg_length = length;
+    hdr->flags = 0;
+    tx_pos = pos + need;
+
+    return hdr;
+}
+
+ConnectorMsgHandle* ShmConnector::alloc_message(const uint32_t length, const uint8_t** data)
+{
+    ShmConnectorMsgHandle* msg;
+    ShmConnectorMsgHdr* hdr = nullptr;
+
+    // once one message is on the heap, later ones go there too so that
+    // nothing is reserved ahead of it and published before it is written
+    if ( get_connector_direction() != Connector::CONN_RECEIVE and !tx_heap_held )
+        hdr = reserve(length);
+
+    if ( hdr )
+        msg = new ShmConnectorMsgHandle((uint8_t*)(hdr + 1), length, tx_pos,
+            ShmConnectorMsgHandle::TRANSMIT_RING);
+    else
+    {
+        msg = new ShmConnectorMsgHandle(length);
+        ++tx_heap_held;
+    }
+
+    *data = msg->connector_msg.data;
+
+    return msg;
+}
+
+void ShmConnector::discard_message(ConnectorMsgHandle* msg)
+{
+    ShmConnectorMsgHandle* smsg = (ShmConnectorMsgHandle*)msg;
+
+    if ( smsg->source == ShmConnectorMsgHandle::RECEIVE_RING )
+    {
+        rx_ring->tail.store(smsg->end, std::memory_order_release);
+        --rx_held;
+    }
+    else if ( smsg->source == ShmConnectorMsgHandle::TRANSMIT_RING )
+    {
+        // the space is already taken so pass it along as a skip
+        ShmConnectorMsgHdr* hdr = (ShmConnectorMsgHdr*)smsg->connector_msg.data - 1;
+        hdr->flags = ShmConnectorMsgHdr::SKIP;
+        tx_ring->head.store(smsg->end, std::memory_order_release);
+    }
+    else
+        --tx_heap_held;
+
+    delete smsg;
+}
+
+bool ShmConnector::transmit_message(ConnectorMsgHandle* msg)
+{
+    ShmConnectorMsgHandle* smsg = (ShmConnectorMsgHandle*)msg;
+    uint64_t end = smsg->end;
+
+    // the ring was full when this was allocated so try again
+    if ( smsg->source == ShmConnectorMsgHandle::HEAP )
+    {
+        ShmConnectorMsgHdr* hdr = nullptr;
+        --tx_heap_held;
+
+        if ( get_connector_direction() != Connector::CONN_RECEIVE )
+            hdr = reserve(smsg->connector_msg.length);
+
+        if ( !hdr )
+        {
+            shm_connector_stats.drops++;
+            delete smsg;
+            return false;
+        }
+        memcpy(hdr + 1, smsg->connector_msg.data, smsg->connector_msg.length);
+        end = tx_pos;
+    }
+
+    tx_ring->head.store(end, std::memory_order_release);
+    shm_connector_stats.messages++;
+
+    delete smsg;
+    return true;
+}
+
+// Receiving from the ring never blocks.  Either a message is there or not.
+ConnectorMsgHandle* ShmConnector::receive_message(bool)
+{
+    if ( get_connector_direction() == Connector::CONN_TRANSMIT )
+        return nullptr;
+
+    const uint64_t head = rx_ring->head.load(std::memory_order_acquire);
+
+    while ( rx_pos < head )
+    {
+        const ShmConnectorMsgHdr* hdr = (ShmConnectorMsgHdr*)(rx_data + (rx_pos & mask));
+
+        // the partner can rewrite the header at any time so the length is
+        // read exactly once and only the checked copy is used
+        const uint32_t msg_len = *(const volatile uint32_t*)&hdr->connector_msg_length;
+        const uint64_t len = record_size(msg_len);
+
+        // don't trust the partner to stay within the ring
+        if ( len > size - (rx_pos & mask) or len > head - rx_pos )
+        {
+            ErrorMessage("shm_connector: invalid message length %u, discarding ring content\n",
+                msg_len);
+            rx_pos = head;
+        }
+        else
+        {
+            rx_pos += len;
+
+            if ( !(hdr->flags & ShmConnectorMsgHdr::SKIP) )
+            {
+                ++rx_held;
+                shm_connector_stats.messages++;
+
+                return new ShmConnectorMsgHandle((uint8_t*)(hdr + 1), msg_len,
+                    rx_pos, ShmConnectorMsgHandle::RECEIVE_RING);
+            }
+        }
+
+        // nothing held so skipped space can be released now
+        if ( !rx_held )
+            rx_ring->tail.store(rx_pos, std::memory_order_release);
+    }
+
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------
+// api stuff
+//-------------------------------------------------------------------------
+
+static Module* mod_ctor()
+{
+    return new ShmConnectorModule;
+}
+
+static void mod_dtor(Module* m)
+{
+    delete m;
+}
+
+// Both sides open the same file and either may get there first.  The file is
+// sized by whoever creates it; the header is checked once it is mapped.
+// /dev/shm is world writable so only a regular file of our own is used;
+// a link or a segment planted by another user is refused.
+static uint8_t* map_segment(const std::string& path, size_t len)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW, 0600);
+
+    if ( fd < 0 )
+    {
+        ErrorMessage("shm_connector: can't open %s: %s\n", path.c_str(), get_error(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+
+    if ( fstat(fd, &st) )
+    {
+        ErrorMessage("shm_connector: can't stat %s: %s\n", path.c_str(), get_error(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    if ( !S_ISREG(st.st_mode) or st.st_uid != geteuid() )
+    {
+        ErrorMessage("shm_connector: %s is not a regular file owned by this user\n",
+            path.c_str());
+        close(fd);
+        return nullptr;
+    }
+
+    if ( !st.st_size and ftruncate(fd, len) )
+    {
+        ErrorMessage("shm_connector: can't size %s: %s\n", path.c_str(), get_error(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    if ( st.st_size and (size_t)st.st_size != len )
+    {
+        ErrorMessage("shm_connector: %s is the wrong size for ring_size\n", path.c_str());
+        close(fd);
+        return nullptr;
+    }
+
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( p == MAP_FAILED )
+    {
+        ErrorMessage("shm_connector: can't map %s: %s\n", path.c_str(), get_error(errno));
+        return nullptr;
+    }
+
+    return (uint8_t*)p;
+}
+
+// set the field if this side is first else check that it matches
+static bool check_or_set(std::atomic<uint32_t>& field, uint32_t value)
+{
+    uint32_t expected = 0;
+    return field.compare_exchange_strong(expected, value) or expected == value;
+}
+
+// Create a per-thread object
+static Connector* shm_connector_tinit(ConnectorConfig* config)
+{
+    ShmConnectorConfig* cfg = (ShmConnectorConfig*)config;
+
+    uint32_t ring_size = 4096;
+
+    while ( ring_size < cfg->ring_size )
+        ring_size <<= 1;
+
+    std::string path = SHM_CONNECTOR_DIR SHM_CONNECTOR_NAME "_";
+    path += cfg->name;
+    path += "_";
+    path += std::to_string(get_instance_id());
+
+    const size_t len = ShmConnector::get_segment_size(ring_size);
+    uint8_t* segment = map_segment(path, len);
+
+    if ( !segment )
+        return nullptr;
+
+    ShmSegmentHdr* hdr = (ShmSegmentHdr*)segment;
+
+    if ( !check_or_set(hdr->version, SHM_FORMAT_VERSION) or
+        !check_or_set(hdr->ring_size, ring_size) )
+    {
+        ErrorMessage("shm_connector: %s has a different version or ring_size\n", path.c_str());
+        munmap(segment, len);
+        return nullptr;
+    }
+
+    return new ShmConnector(cfg, segment, len);
+}
+
+static void shm_connector_tterm(Connector* connector)
+{
+    ShmConnector* shm_conn = (ShmConnector*)connector;
+
+    delete shm_conn;
+}
+
+static ConnectorCommon* shm_connector_ctor(Module* m)
+{
+    ShmConnectorModule* mod = (ShmConnectorModule*)m;
+    ShmConnectorCommon* shm_connector_common = new ShmConnectorCommon(
+        mod->get_and_clear_config());
+
+    return shm_connector_common;
+}
+
+static void shm_connector_dtor(ConnectorCommon* c)
+{
+    ShmConnectorCommon* sc = (ShmConnectorCommon*)c;
+    delete sc;
+}
+
+const ConnectorApi shm_connector_api =
+{
+    {
+        PT_CONNECTOR,
+        sizeof(ConnectorApi),
+        CONNECTOR_API_VERSION,
+        0,
+        API_RESERVED,
+        API_OPTIONS,
+        SHM_CONNECTOR_NAME,
+        SHM_CONNECTOR_HELP,
+        mod_ctor,
+        mod_dtor
+    },
+    0,
+    nullptr,
+    nullptr,
+    shm_connector_tinit,
+    shm_connector_tterm,
+    shm_connector_ctor,
+    shm_connector_dtor
+};
+
+#ifdef BUILDING_SO
+SO_PUBLIC const BaseApi* snort_plugins[] =
+#else
+const BaseApi* shm_connector[] =
+#endif
+{
+    &shm_connector_api.base,
+    nullptr
+};
+
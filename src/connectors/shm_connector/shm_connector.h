@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2015-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector.h
+
+#ifndef SHM_CONNECTOR_H
+#define SHM_CONNECTOR_H
+
+#include <atomic>
+
+#include "framework/connector.h"
+
+#include "shm_connector_config.h"
+
+#define SHM_FORMAT_VERSION (1)
+#define SHM_CONNECTOR_DIR "/dev/shm/"
+
+//-------------------------------------------------------------------------
+// shared memory layout
+//-------------------------------------------------------------------------
+
+// A segment holds one ring for each side.  Each ring is a single producer,
+// single consumer byte ring: head is only written by the side transmitting
+// on the ring and tail only by the side receiving.  Both count up without
+// wrapping so head - tail is the number of bytes in use.
+struct ShmRing
+{
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+};
+
+// The segment file starts out zeroed, which is a valid pair of empty rings.
+// Whichever side gets there first fills in the version and ring size.
+struct ShmSegmentHdr
+{
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> ring_size;
+    ShmRing ring[2];
+};
+
+// Messages start on 8 byte boundaries and never wrap.  If a message doesn't
+// fit before the end of the ring, the remainder is filled with a skip record.
+struct ShmConnectorMsgHdr
+{
+    static constexpr uint32_t SKIP = 0x1;
+
+    uint32_t connector_msg_length;
+    uint32_t flags;
+};
+
+//-------------------------------------------------------------------------
+// class stuff
+//-------------------------------------------------------------------------
+
+class ShmConnectorMsgHandle : public snort::ConnectorMsgHandle
+{
+public:
+    enum Source { HEAP, TRANSMIT_RING, RECEIVE_RING };
+
+    ShmConnectorMsgHandle(const uint32_t length);
+    ShmConnectorMsgHandle(uint8_t* data, uint32_t length, uint64_t end, Source);
+    ~ShmConnectorMsgHandle();
+
+    snort::ConnectorMsg connector_msg;
+
+    // ring position just past the message
+    uint64_t end = 0;
+    Source source;
+};
+
+class ShmConnectorCommon : public snort::ConnectorCommon
+{
+public:
+    ShmConnectorCommon(ShmConnectorConfig::ShmConnectorConfigSet*);
+    ~ShmConnectorCommon();
+};
+
+// Messages are allocated in place in the transmit ring and received in
+// place from the receive ring, so nothing is copied.  Allocated messages
+// must be transmitted or discarded in the order allocated and received
+// messages must be discarded in the order received.  If the transmit ring
+// is full when a message is allocated, the message is built on the heap
+// and copied in at transmit, or dropped if there is still no room.
+class ShmConnector : public snort::Connector
+{
+public:
+    ShmConnector(ShmConnectorConfig*, uint8_t* segment, size_t segment_size);
+    ~ShmConnector() override;
+
+    snort::ConnectorMsgHandle* alloc_message(const uint32_t, const uint8_t**) override;
+    void discard_message(snort::ConnectorMsgHandle*) override;
+    bool transmit_message(snort::ConnectorMsgHandle*) override;
+    snort::ConnectorMsgHandle* receive_message(bool) override;
+
+    snort::ConnectorMsg* get_connector_msg(snort::ConnectorMsgHandle* handle) override
+    { return( &((ShmConnectorMsgHandle*)handle)->connector_msg ); }
+    Direction get_connector_direction() override
+    { return( ((const ShmConnectorConfig*)config)->direction ); }
+
+    static size_t get_segment_size(uint32_t ring_size)
+    { return sizeof(ShmSegmentHdr) + 2 * (size_t)ring_size; }
+
+private:
+    ShmConnectorMsgHdr* reserve(uint32_t length);
+
+    uint8_t* segment;
+    size_t segment_size;
+
+    uint64_t size;
+    uint64_t mask;
+
+    ShmRing* tx_ring;
+    uint8_t* tx_data;
+    uint64_t tx_pos;    // end of the last message allocated
+    unsigned tx_heap_held = 0;
+
+    ShmRing* rx_ring;
+    uint8_t* rx_data;
+    uint64_t rx_pos;    // end of the last message received
+    unsigned rx_held = 0;
+};
+
+#endif
+
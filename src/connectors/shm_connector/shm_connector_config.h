@@ -0,0 +1,46 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2015-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector_config.h
+
+#ifndef SHM_CONNECTOR_CONFIG_H
+#define SHM_CONNECTOR_CONFIG_H
+
+#include <string>
+#include <vector>
+
+#include "framework/connector.h"
+
+class ShmConnectorConfig : public snort::ConnectorConfig
+{
+public:
+    // each end of a duplex channel transmits on the ring of its side
+    enum Side { A, B };
+
+    ShmConnectorConfig()
+    { direction = snort::Connector::CONN_DUPLEX; }
+
+    std::string name;
+    Side side = A;
+    uint32_t ring_size = 1024 * 1024;
+
+    typedef std::vector<ShmConnectorConfig*> ShmConnectorConfigSet;
+};
+
+#endif
+
@@ -0,0 +1,66 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2015-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector_module.h
+
+#ifndef SHM_CONNECTOR_MODULE_H
+#define SHM_CONNECTOR_MODULE_H
+
+#include "framework/module.h"
+
+#include "shm_connector_config.h"
+
+#define SHM_CONNECTOR_NAME "shm_connector"
+#define SHM_CONNECTOR_HELP "implement the shared memory ring based connector"
+
+struct ShmConnectorStats
+{
+    PegCount messages;
+    PegCount drops;
+};
+
+extern THREAD_LOCAL ShmConnectorStats shm_connector_stats;
+extern THREAD_LOCAL snort::ProfileStats shm_connector_perfstats;
+
+class ShmConnectorModule : public snort::Module
+{
+public:
+    ShmConnectorModule();
+    ~ShmConnectorModule() override;
+
+    bool set(const char*, snort::Value&, snort::SnortConfig*) override;
+    bool begin(const char*, int, snort::SnortConfig*) override;
+    bool end(const char*, int, snort::SnortConfig*) override;
+
+    ShmConnectorConfig::ShmConnectorConfigSet* get_and_clear_config();
+
+    const PegInfo* get_pegs() const override;
+    PegCount* get_counts() const override;
+
+    snort::ProfileStats* get_profile() const override;
+
+    Usage get_usage() const override
+    { return GLOBAL; }
+
+private:
+    ShmConnectorConfig::ShmConnectorConfigSet* config_set;
+    ShmConnectorConfig* config;
+};
+
+#endif
+
@@ -0,0 +1,142 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2015-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector_module_test.cc
+// unit test main
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "connectors/shm_connector/shm_connector_module.h"
+#include "profiler/profiler.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+THREAD_LOCAL ShmConnectorStats shm_connector_stats;
+THREAD_LOCAL ProfileStats shm_connector_perfstats;
+
+void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
+void show_stats(PegCount*, const PegInfo*, const IndexVec&, const char*, FILE*) { }
+
+namespace snort
+{
+char* snort_strdup(const char* s)
+{ return strdup(s); }
+}
+
+TEST_GROUP(shm_connector_module)
+{
+};
+
+TEST(shm_connector_module, test)
+{
+    Value connector_val("shm");
+    Value name_val("ha");
+    Value side_val("b");
+    Value direction_val("transmit");
+    Value ring_size_val((double)8192);
+    Parameter connector_param =
+        {"connector", Parameter::PT_STRING, nullptr, nullptr, "connector"};
+    Parameter name_param =
+        {"name", Parameter::PT_STRING, nullptr, nullptr, "name"};
+    Parameter side_param =
+        {"side", Parameter::PT_ENUM, "a | b", nullptr, "side"};
+    Parameter direction_param =
+        {"direction", Parameter::PT_ENUM, "receive | transmit | duplex", nullptr, "direction"};
+    Parameter ring_size_param =
+        {"ring_size", Parameter::PT_INT, "4096:1073741824", nullptr, "ring_size"};
+
+    ShmConnectorModule module;
+
+    connector_val.set(&connector_param);
+    name_val.set(&name_param);
+    side_val.set(&side_param);
+    CHECK( side_param.validate(side_val) == true );
+    direction_val.set(&direction_param);
+    CHECK( direction_param.validate(direction_val) == true );
+    ring_size_val.set(&ring_size_param);
+    CHECK( ring_size_param.validate(ring_size_val) == true );
+
+    module.begin("shm_connector", 0, nullptr);
+    module.begin("shm_connector", 1, nullptr);
+    module.set("shm_connector.connector", connector_val, nullptr);
+    module.set("shm_connector.name", name_val, nullptr);
+    module.set("shm_connector.side", side_val, nullptr);
+    module.set("shm_connector.direction", direction_val, nullptr);
+    module.set("shm_connector.ring_size", ring_size_val, nullptr);
+    module.end("shm_connector", 1, nullptr);
+    module.end("shm_connector", 0, nullptr);
+
+    ShmConnectorConfig::ShmConnectorConfigSet* config_set = module.get_and_clear_config();
+
+    CHECK(config_set != nullptr);
+
+    CHECK(config_set->size() == 1);
+
+    ShmConnectorConfig config = *(config_set->front());
+    CHECK(config.connector_name == "shm");
+    CHECK(config.name == "ha");
+    CHECK(config.side == ShmConnectorConfig::B);
+    CHECK(config.direction == Connector::CONN_TRANSMIT);
+    CHECK(config.ring_size == 8192);
+
+    CHECK(module.get_pegs() != nullptr );
+    CHECK(module.get_counts() != nullptr );
+    CHECK(module.get_profile() != nullptr );
+
+    for ( auto conf : *config_set )
+        delete conf;
+
+    config_set->clear();
+    delete config_set;
+}
+
+TEST(shm_connector_module, defaults)
+{
+    ShmConnectorModule module;
+
+    module.begin("shm_connector", 0, nullptr);
+    module.begin("shm_connector", 1, nullptr);
+    module.end("shm_connector", 1, nullptr);
+    module.end("shm_connector", 0, nullptr);
+
+    ShmConnectorConfig::ShmConnectorConfigSet* config_set = module.get_and_clear_config();
+
+    CHECK(config_set->size() == 1);
+
+    ShmConnectorConfig config = *(config_set->front());
+    CHECK(config.side == ShmConnectorConfig::A);
+    CHECK(config.direction == Connector::CONN_DUPLEX);
+    CHECK(config.ring_size == 1024 * 1024);
+
+    for ( auto conf : *config_set )
+        delete conf;
+
+    config_set->clear();
+    delete config_set;
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
@@ -0,0 +1,332 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2015-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// shm_connector_test.cc
+// unit test main
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "connectors/shm_connector/shm_connector.h"
+#include "connectors/shm_connector/shm_connector_module.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+extern const BaseApi* shm_connector;
+const ConnectorApi* shmc_api = nullptr;
+
+static unsigned s_instance = 0;
+
+ShmConnectorConfig a_config;
+ShmConnectorConfig b_config;
+
+Connector* a_side;
+Connector* b_side;
+
+void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
+void show_stats(PegCount*, const PegInfo*, const IndexVec&, const char*, FILE*) { }
+
+namespace snort
+{
+unsigned get_instance_id()
+{ return s_instance; }
+
+const char* get_error(int)
+{ return ""; }
+
+void ErrorMessage(const char*, ...) { }
+void LogMessage(const char*, ...) { }
+}
+
+ShmConnectorModule::ShmConnectorModule() :
+    Module("SHMC", "SHMC Help", nullptr)
+{ }
+
+ShmConnectorConfig::ShmConnectorConfigSet* ShmConnectorModule::get_and_clear_config()
+{
+    ShmConnectorConfig::ShmConnectorConfigSet* config_set = new ShmConnectorConfig::ShmConnectorConfigSet;
+
+    return config_set;
+}
+
+ShmConnectorModule::~ShmConnectorModule() = default;
+
+ProfileStats* ShmConnectorModule::get_profile() const { return nullptr; }
+
+bool ShmConnectorModule::set(const char*, Value&, SnortConfig*) { return true; }
+bool ShmConnectorModule::begin(const char*, int, SnortConfig*) { return true; }
+bool ShmConnectorModule::end(const char*, int, SnortConfig*) { return true; }
+
+const PegInfo* ShmConnectorModule::get_pegs() const { return nullptr; }
+PegCount* ShmConnectorModule::get_counts() const { return nullptr; }
+
+static std::string segment_path()
+{
+    std::string path = SHM_CONNECTOR_DIR SHM_CONNECTOR_NAME "_";
+    path += a_config.name;
+    path += "_";
+    path += std::to_string(s_instance);
+    return path;
+}
+
+static bool send(Connector* conn, uint32_t len, uint8_t fill)
+{
+    const uint8_t* data = nullptr;
+    ConnectorMsgHandle* handle = conn->alloc_message(len, &data);
+    memset((uint8_t*)data, fill, len);
+    return conn->transmit_message(handle);
+}
+
+// returns the message length or 0 if there is none
+static uint32_t recv(Connector* conn, uint8_t fill)
+{
+    ConnectorMsgHandle* handle = conn->receive_message(false);
+
+    if ( !handle )
+        return 0;
+
+    ConnectorMsg* msg = conn->get_connector_msg(handle);
+    uint32_t len = msg->length;
+
+    for ( uint32_t i = 0; i < len; i++ )
+        CHECK(msg->data[i] == fill);
+
+    conn->discard_message(handle);
+    return len;
+}
+
+TEST_GROUP(shm_connector)
+{
+    void setup() override
+    {
+        s_instance = 0;
+        shmc_api = (const ConnectorApi*) shm_connector;
+        a_config.connector_name = "shm-a";
+        a_config.name = "test_" + std::to_string(getpid());
+        a_config.side = ShmConnectorConfig::A;
+        a_config.ring_size = 4096;
+        b_config = a_config;
+        b_config.connector_name = "shm-b";
+        b_config.side = ShmConnectorConfig::B;
+        memset(&shm_connector_stats, 0, sizeof(shm_connector_stats));
+    }
+
+    void teardown() override
+    {
+        unlink(segment_path().c_str());
+    }
+};
+
+TEST(shm_connector, mod_ctor_dtor)
+{
+    CHECK(shm_connector != nullptr);
+    Module* mod = shm_connector->mod_ctor();
+    CHECK(mod != nullptr);
+    shm_connector->mod_dtor(mod);
+}
+
+TEST(shm_connector, mod_instance_ctor_dtor)
+{
+    Module* mod = shm_connector->mod_ctor();
+    ConnectorCommon* connector_common = shmc_api->ctor(mod);
+    CHECK(connector_common != nullptr);
+    shmc_api->dtor(connector_common);
+    shm_connector->mod_dtor(mod);
+}
+
+TEST(shm_connector, duplex)
+{
+    a_side = shmc_api->tinit(&a_config);
+    b_side = shmc_api->tinit(&b_config);
+    CHECK(a_side != nullptr);
+    CHECK(b_side != nullptr);
+    CHECK(a_side->get_connector_direction() == Connector::CONN_DUPLEX);
+
+    CHECK(recv(b_side, 0) == 0);
+
+    CHECK(send(a_side, 10, 0xaa));
+    CHECK(send(b_side, 20, 0xbb));
+    CHECK(recv(a_side, 0xbb) == 20);
+    CHECK(recv(b_side, 0xaa) == 10);
+    CHECK(recv(a_side, 0) == 0);
+    CHECK(recv(b_side, 0) == 0);
+    CHECK(shm_connector_stats.messages == 4);
+
+    shmc_api->tterm(a_side);
+    shmc_api->tterm(b_side);
+}
+
+TEST(shm_connector, wrap)
+{
+    a_side = shmc_api->tinit(&a_config);
+    b_side = shmc_api->tinit(&b_config);
+
+    // 1000 byte messages take 1008 bytes so every 4th one wraps
+    for ( unsigned i = 0; i < 20; i++ )
+    {
+        CHECK(send(a_side, 1000, (uint8_t)i));
+        CHECK(recv(b_side, (uint8_t)i) == 1000);
+    }
+    CHECK(shm_connector_stats.drops == 0);
+
+    shmc_api->tterm(a_side);
+    shmc_api->tterm(b_side);
+}
+
+TEST(shm_connector, full)
+{
+    a_side = shmc_api->tinit(&a_config);
+    b_side = shmc_api->tinit(&b_config);
+
+    for ( unsigned i = 0; i < 4; i++ )
+        CHECK(send(a_side, 1000, (uint8_t)i));
+
+    // allocated on the heap and still no room at transmit
+    CHECK(!send(a_side, 1000, 4));
+    CHECK(shm_connector_stats.drops == 1);
+
+    // allocated on the heap and copied in once there is room
+    const uint8_t* data = nullptr;
+    ConnectorMsgHandle* handle = a_side->alloc_message(1000, &data);
+    memset((uint8_t*)data, 5, 1000);
+    CHECK(recv(b_side, 0) == 1000);
+    CHECK(a_side->transmit_message(handle));
+
+    for ( unsigned i = 1; i < 4; i++ )
+        CHECK(recv(b_side, (uint8_t)i) == 1000);
+
+    CHECK(recv(b_side, 5) == 1000);
+    CHECK(recv(b_side, 0) == 0);
+
+    shmc_api->tterm(a_side);
+    shmc_api->tterm(b_side);
+}
+
+TEST(shm_connector, discard_allocated)
+{
+    a_side = shmc_api->tinit(&a_config);
+    b_side = shmc_api->tinit(&b_config);
+
+    const uint8_t* data = nullptr;
+    ConnectorMsgHandle* handle = a_side->alloc_message(100, &data);
+    a_side->discard_message(handle);
+    CHECK(send(a_side, 50, 0xcc));
+
+    CHECK(recv(b_side, 0xcc) == 50);
+    CHECK(recv(b_side, 0) == 0);
+
+    shmc_api->tterm(a_side);
+    shmc_api->tterm(b_side);
+}
+
+TEST(shm_connector, restart)
+{
+    a_side = shmc_api->tinit(&a_config);
+    b_side = shmc_api->tinit(&b_config);
+
+    CHECK(send(a_side, 10, 0xaa));
+    shmc_api->tterm(b_side);
+
+    // queued messages are still there when the receiver comes back
+    b_side = shmc_api->tinit(&b_config);
+    CHECK(recv(b_side, 0xaa) == 10);
+
+    shmc_api->tterm(a_side);
+    shmc_api->tterm(b_side);
+}
+
+TEST(shm_connector, ring_size_mismatch)
+{
+    a_side = shmc_api->tinit(&a_config);
+    CHECK(a_side != nullptr);
+
+    b_config.ring_size = 8192;
+    b_side = shmc_api->tinit(&b_config);
+    CHECK(b_side == nullptr);
+
+    shmc_api->tterm(a_side);
+}
+
+TEST(shm_connector, symlink)
+{
+    std::string target = segment_path() + "_target";
+    CHECK(symlink(target.c_str(), segment_path().c_str()) == 0);
+
+    a_side = shmc_api->tinit(&a_config);
+    CHECK(a_side == nullptr);
+
+    // the link was not followed
+    CHECK(access(target.c_str(), F_OK) != 0);
+}
+
+TEST(shm_connector, not_regular)
+{
+    CHECK(mkfifo(segment_path().c_str(), 0600) == 0);
+
+    a_side = shmc_api->tinit(&a_config);
+    CHECK(a_side == nullptr);
+}
+
+TEST(shm_connector, simplex)
+{
+    a_config.direction = Connector::CONN_TRANSMIT;
+    b_config.direction = Connector::CONN_RECEIVE;
+
+    a_side = shmc_api->tinit(&a_config);
+    b_side = shmc_api->tinit(&b_config);
+
+    CHECK(send(a_side, 10, 0xaa));
+    CHECK(recv(a_side, 0) == 0);
+    CHECK(!send(b_side, 10, 0xbb));
+    CHECK(recv(b_side, 0xaa) == 10);
+
+    shmc_api->tterm(a_side);
+    shmc_api->tterm(b_side);
+
+    a_config.direction = Connector::CONN_DUPLEX;
+    b_config.direction = Connector::CONN_DUPLEX;
+}
+
+TEST_GROUP(shm_connector_msg_handle)
+{
+};
+
+TEST(shm_connector_msg_handle, test)
+{
+    ShmConnectorMsgHandle handle(12);
+    CHECK(handle.connector_msg.length == 12);
+    CHECK(handle.connector_msg.data != nullptr);
+    CHECK(handle.source == ShmConnectorMsgHandle::HEAP);
+}
+
+int main(int argc, char** argv)
+{
+    int return_value = CommandLineTestRunner::RunAllTests(argc, argv);
+    return return_value;
+}
+
@@ -27,11 +27,15 @@
 #include <netdb.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <cerrno>
+
 #include "log/messages.h"
 #include "main/thread.h"
 #include "profiler/profiler_defs.h"
+#include "utils/util.h"
 
 #include "tcp_connector_module.h"
 
@@ -262,22 +266,47 @@ bool TcpConnector::transmit_message(ConnectorMsgHandle* msg)
 
     TcpConnectorMsgHdr tcpc_hdr(tmsg->connector_msg.length);
 
-    if ( send( sock_fd, (const char*)&tcpc_hdr, sizeof(tcpc_hdr), 0 ) != sizeof(tcpc_hdr) )
-    {
-        ErrorMessage("TcpConnector: failed to transmit header\n");
-        delete tmsg;
-        return false;
-    }
+    // header and data go out in one call
+    struct iovec iov[2];
+    iov[0].iov_base = &tcpc_hdr;
+    iov[0].iov_len = sizeof(tcpc_hdr);
+    iov[1].iov_base = tmsg->connector_msg.data;
+    iov[1].iov_len = tmsg->connector_msg.length;
 
-    if ( send( sock_fd, (const char*)tmsg->connector_msg.data, tmsg->connector_msg.length, 0 ) !=
-        tmsg->connector_msg.length )
+    struct iovec* vec = iov;
+    int cnt = 2;
+
+    // a stream socket may take less than the whole frame so write the rest
+    // until it is all gone; stopping part way would break the framing
+    while ( cnt )
     {
-        delete tmsg;
-        return false;
+        ssize_t sent = writev(sock_fd, vec, cnt);
+
+        if ( sent < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            ErrorMessage("TcpConnector: failed to transmit message: %s\n", get_error(errno));
+            delete tmsg;
+            return false;
+        }
+
+        while ( cnt and (size_t)sent >= vec->iov_len )
+        {
+            sent -= vec->iov_len;
+            ++vec;
+            --cnt;
+        }
+
+        if ( cnt )
+        {
+            vec->iov_base = (uint8_t*)vec->iov_base + sent;
+            vec->iov_len -= sent;
+        }
     }
 
     delete tmsg;
-
     return true;
 }
 
@@ -29,8 +29,15 @@
 #include <netdb.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <deque>
+#include <vector>
+
 #include <CppUTest/CommandLineTestRunner.h>
 #include <CppUTest/TestHarness.h>
 
@@ -54,8 +61,10 @@ static int s_rec_error = 0;
 static int s_rec_error_size = -1;
 static bool s_rec_return_zero = false;
 
-static int s_send_ret_header = sizeof(TcpConnectorMsgHdr);
-static int s_send_ret_other = 0;
+// each writev takes at most the next limit, all if there are none left;
+// a negative limit fails the call with -limit as errno
+static std::deque<ssize_t> s_writev_limits;
+static std::vector<uint8_t> s_written;
 
 TcpConnectorConfig connector_config;
 
@@ -75,15 +84,36 @@ unsigned get_instance_id()
 
 void ErrorMessage(const char*, ...) { }
 void LogMessage(const char*, ...) { }
+const char* get_error(int) { return ""; }
 }
 
 int connect (int, const struct sockaddr*, socklen_t) { return s_connect_return; }
-ssize_t send (int, const void*, size_t n, int)
+ssize_t writev (int, const struct iovec* iov, int iovcnt)
 {
-    if ( n == sizeof(TcpConnectorMsgHdr) )
-        return s_send_ret_header;
-    else
-        return s_send_ret_other;
+    ssize_t limit = SSIZE_MAX;
+
+    if ( !s_writev_limits.empty() )
+    {
+        limit = s_writev_limits.front();
+        s_writev_limits.pop_front();
+    }
+
+    if ( limit < 0 )
+    {
+        errno = -limit;
+        return -1;
+    }
+
+    ssize_t n = 0;
+
+    for ( int i = 0; i < iovcnt and n < limit; ++i )
+    {
+        size_t len = std::min(iov[i].iov_len, (size_t)(limit - n));
+        const uint8_t* b = (const uint8_t*)iov[i].iov_base;
+        s_written.insert(s_written.end(), b, b + len);
+        n += len;
+    }
+    return n;
 }
 
 int poll (struct pollfd* fds, nfds_t nfds, int)
@@ -155,11 +185,9 @@ static void set_normal_status()
     s_bind_return = 0;
     s_listen_return = 0;
     s_accept_return = 2;
-    s_send_ret_header = sizeof(TcpConnectorMsgHdr);
-    s_send_ret_other = 0;
     s_connect_return = 1;
-    s_send_ret_header = sizeof(TcpConnectorMsgHdr);
-    s_send_ret_other = 0;
+    s_writev_limits.clear();
+    s_written.clear();
     s_poll_error = false;
     s_poll_undesirable = false;
     s_poll_data_available = false;
@@ -534,18 +562,74 @@ TEST(tcp_connector_tinit_tterm_call, alloc_discard)
     tcpc->discard_message(handle);
 }
 
+// the frame on the wire is the header followed by the message
+static bool check_frame(const uint8_t* data, uint32_t len)
+{
+    TcpConnectorMsgHdr hdr(len);
+
+    return s_written.size() == sizeof(hdr) + len and
+        !memcmp(s_written.data(), &hdr, sizeof(hdr)) and
+        !memcmp(s_written.data() + sizeof(hdr), data, len);
+}
+
+static TcpConnectorMsgHandle* alloc_filled(TcpConnector* tcpc, uint32_t len, const uint8_t*& data)
+{
+    TcpConnectorMsgHandle* handle = (TcpConnectorMsgHandle*)(tcpc->alloc_message(len, &data));
+    CHECK(data != nullptr);
+    CHECK(handle->connector_msg.length == len);
+    CHECK(handle->connector_msg.data == data);
+
+    for ( uint32_t i = 0; i < len; ++i )
+        ((uint8_t*)data)[i] = (uint8_t)i;
+
+    return handle;
+}
+
 TEST(tcp_connector_tinit_tterm_call, alloc_transmit)
 {
     const uint8_t* data = nullptr;
     TcpConnector* tcpc = (TcpConnector*)connector;
     set_normal_status();
 
-    TcpConnectorMsgHandle* handle = (TcpConnectorMsgHandle*)(tcpc->alloc_message(40,&data));
-    CHECK(data != nullptr);
-    CHECK(handle->connector_msg.length == 40);
-    s_send_ret_other = 40;
-    CHECK(handle->connector_msg.data == data);
+    TcpConnectorMsgHandle* handle = alloc_filled(tcpc, 40, data);
     CHECK(tcpc->transmit_message(handle) == true);
+
+    uint8_t copy[40];
+    for ( unsigned i = 0; i < sizeof(copy); ++i )
+        copy[i] = (uint8_t)i;
+    CHECK(check_frame(copy, sizeof(copy)));
+}
+
+TEST(tcp_connector_tinit_tterm_call, alloc_transmit_partial_header)
+{
+    const uint8_t* data = nullptr;
+    TcpConnector* tcpc = (TcpConnector*)connector;
+    set_normal_status();
+
+    TcpConnectorMsgHandle* handle = alloc_filled(tcpc, 40, data);
+    s_writev_limits = { 1, (ssize_t)sizeof(TcpConnectorMsgHdr) - 2, 1, 0, 7 };
+    CHECK(tcpc->transmit_message(handle) == true);
+
+    uint8_t copy[40];
+    for ( unsigned i = 0; i < sizeof(copy); ++i )
+        copy[i] = (uint8_t)i;
+    CHECK(check_frame(copy, sizeof(copy)));
+}
+
+TEST(tcp_connector_tinit_tterm_call, alloc_transmit_partial_body)
+{
+    const uint8_t* data = nullptr;
+    TcpConnector* tcpc = (TcpConnector*)connector;
+    set_normal_status();
+
+    TcpConnectorMsgHandle* handle = alloc_filled(tcpc, 40, data);
+    s_writev_limits = { (ssize_t)sizeof(TcpConnectorMsgHdr) + 30, -EINTR, 5 };
+    CHECK(tcpc->transmit_message(handle) == true);
+
+    uint8_t copy[40];
+    for ( unsigned i = 0; i < sizeof(copy); ++i )
+        copy[i] = (uint8_t)i;
+    CHECK(check_frame(copy, sizeof(copy)));
 }
 
 TEST(tcp_connector_tinit_tterm_call, alloc_transmit_header_fail)
@@ -554,13 +638,10 @@ TEST(tcp_connector_tinit_tterm_call, alloc_transmit_header_fail)
     TcpConnector* tcpc = (TcpConnector*)connector;
     set_normal_status();
 
-    TcpConnectorMsgHandle* handle = (TcpConnectorMsgHandle*)(tcpc->alloc_message(40,&data));
-    CHECK(data != nullptr);
-    CHECK(handle->connector_msg.length == 40);
-    s_send_ret_header = sizeof(TcpConnectorMsgHdr)-1;
-    s_send_ret_other = 40;
-    CHECK(handle->connector_msg.data == data);
+    TcpConnectorMsgHandle* handle = alloc_filled(tcpc, 40, data);
+    s_writev_limits = { -EPIPE };
     CHECK(tcpc->transmit_message(handle) == false);
+    CHECK(s_written.empty());
 }
 
 TEST(tcp_connector_tinit_tterm_call, alloc_transmit_body_fail)
@@ -569,12 +650,10 @@ TEST(tcp_connector_tinit_tterm_call, alloc_transmit_body_fail)
     TcpConnector* tcpc = (TcpConnector*)connector;
     set_normal_status();
 
-    TcpConnectorMsgHandle* handle = (TcpConnectorMsgHandle*)(tcpc->alloc_message(40,&data));
-    CHECK(data != nullptr);
-    CHECK(handle->connector_msg.length == 40);
-    s_send_ret_other = 30;
-    CHECK(handle->connector_msg.data == data);
+    TcpConnectorMsgHandle* handle = alloc_filled(tcpc, 40, data);
+    s_writev_limits = { (ssize_t)sizeof(TcpConnectorMsgHdr) + 30, -EPIPE };
     CHECK(tcpc->transmit_message(handle) == false);
+    CHECK(s_written.size() == sizeof(TcpConnectorMsgHdr) + 30);
 }
 
 TEST(tcp_connector_tinit_tterm_call, alloc_transmit_no_sock)
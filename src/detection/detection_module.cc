@@ -90,6 +90,11 @@ static const Parameter detection_params[] =
     { "pcre_override", Parameter::PT_BOOL, nullptr, "true",
       "enable pcre match limit overrides when pattern matching (ie ignore /O)" },
 
+#ifdef HAVE_HYPERSCAN
+    { "pcre_prefilter", Parameter::PT_BOOL, nullptr, "false",
+      "screen pcre options on each buffer with one hyperscan prefilter scan" },
+#endif
+
 #ifdef HAVE_HYPERSCAN
     { "pcre_to_regex", Parameter::PT_BOOL, nullptr, "false",
       "enable the use of regex instead of pcre for compatible expressions" },
@@ -199,6 +204,9 @@ bool DetectionModule::set(const char*, Value& v, SnortConfig* sc)
         sc->pcre_override = v.get_bool();
 
 #ifdef HAVE_HYPERSCAN
+    else if ( v.is("pcre_prefilter") )
+        sc->pcre_prefilter = v.get_bool();
+
     else if ( v.is("pcre_to_regex") )
         sc->pcre_to_regex = v.get_bool();
 #endif
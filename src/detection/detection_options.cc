@@ -32,8 +32,10 @@
 
 #include "detection_options.h"
 
-#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "filters/detection_filter.h"
 #include "framework/cursor.h"
@@ -148,7 +150,7 @@ public:
     }
 };
 
-static uint32_t detection_option_tree_hash(detection_option_tree_node_t* node)
+static uint32_t detection_option_tree_hash(const detection_option_tree_node_t* node)
 {
     assert(node);
 
@@ -326,25 +328,104 @@ void print_option_tree(detection_option_tree_node_t* node, int level)
 #endif
 }
 
-void* add_detection_option_tree(SnortConfig* sc, detection_option_tree_node_t* option_tree)
+//-------------------------------------------------------------------------
+// option tree deduplication
+//
+// trees are finished by the mpse compile threads.  each thread deduplicates
+// the trees it builds in a set of its own and remembers where they are
+// referenced.  the sets are merged into the config's tree hash after the
+// threads are joined, so the threads never contend on the shared table.
+//-------------------------------------------------------------------------
+
+struct TreeHash
 {
-    static std::mutex build_mutex;
-    std::lock_guard<std::mutex> lock(build_mutex);
+    size_t operator()(const detection_option_tree_node_t* node) const
+    { return detection_option_tree_hash(node); }
+};
 
+struct TreeEqual
+{
+    bool operator()(
+        const detection_option_tree_node_t* r, const detection_option_tree_node_t* l) const
+    { return detection_option_tree_compare(r, l); }
+};
+
+struct DetectionOptionTreeSet
+{
+    std::unordered_set<detection_option_tree_node_t*, TreeHash, TreeEqual> trees;
+    std::vector<detection_option_tree_node_t**> refs;
+};
+
+static THREAD_LOCAL DetectionOptionTreeSet* tree_set = nullptr;
+
+static void* insert_detection_option_tree(SnortConfig* sc, detection_option_tree_node_t* node)
+{
     if ( !sc->detection_option_tree_hash_table )
         sc->detection_option_tree_hash_table = DetectionTreeHashTableNew();
 
     detection_option_key_t key;
-    key.option_data = (void*)option_tree;
+    key.option_data = (void*)node;
     key.option_type = RULE_OPTION_TYPE_LEAF_NODE;
 
     if ( void* p = sc->detection_option_tree_hash_table->get_user_data(&key) )
         return p;
 
-    sc->detection_option_tree_hash_table->insert(&key, option_tree);
+    sc->detection_option_tree_hash_table->insert(&key, node);
     return nullptr;
 }
 
+void add_detection_option_tree(SnortConfig* sc, detection_option_tree_node_t** ref)
+{
+    detection_option_tree_node_t* node = *ref;
+    detection_option_tree_node_t* dup;
+
+    if ( tree_set )
+    {
+        auto ins = tree_set->trees.emplace(node);
+        dup = ins.second ? nullptr : *ins.first;
+        tree_set->refs.emplace_back(ref);
+    }
+    else
+        dup = (detection_option_tree_node_t*)insert_detection_option_tree(sc, node);
+
+    if ( dup )
+    {
+        // FIXIT-L delete dup_node and keep original?
+        free_detection_option_tree(node);
+        *ref = dup;
+    }
+}
+
+DetectionOptionTreeSet* new_detection_option_tree_set()
+{ return new DetectionOptionTreeSet; }
+
+void set_detection_option_tree_set(DetectionOptionTreeSet* set)
+{ tree_set = set; }
+
+void merge_detection_option_tree_set(SnortConfig* sc, DetectionOptionTreeSet* set)
+{
+    std::unordered_map<detection_option_tree_node_t*, detection_option_tree_node_t*> dups;
+
+    for ( auto* node : set->trees )
+    {
+        if ( void* dup = insert_detection_option_tree(sc, node) )
+        {
+            dups[node] = (detection_option_tree_node_t*)dup;
+            free_detection_option_tree(node);
+        }
+    }
+
+    for ( auto* ref : set->refs )
+    {
+        auto it = dups.find(*ref);
+
+        if ( it != dups.end() )
+            *ref = it->second;
+    }
+
+    delete set;
+}
+
 int detection_option_node_evaluate(
     detection_option_tree_node_t* node, detection_option_eval_data_t& eval_data,
     const Cursor& orig_cursor)
@@ -731,7 +812,8 @@ struct node_profile_stats
 };
 
 static void detection_option_node_update_otn_stats(detection_option_tree_node_t* node,
-    node_profile_stats* stats, uint64_t checks, uint64_t timeouts, uint64_t suspends)
+    node_profile_stats* stats, uint64_t checks, uint64_t timeouts, uint64_t suspends,
+    OtnStateMap* snapshot = nullptr)
 {
     node_profile_stats local_stats; /* cumulative stats for this node */
     node_profile_stats node_stats;  /* sum of all instances */
@@ -777,7 +859,7 @@ static void detection_option_node_update_otn_stats(detection_option_tree_node_t*
         // Right now, it looks like we're missing out on some stats although it's possible
         // that this is "corrected" in the profiler code
         auto* otn = (OptTreeNode*)node->option_data;
-        auto& state = otn->state[get_instance_id()];
+        auto& state = snapshot ? (*snapshot)[otn] : otn->state[get_instance_id()];
 
         state.elapsed += local_stats.elapsed;
         state.elapsed_match += local_stats.elapsed_match;
@@ -794,11 +876,11 @@ static void detection_option_node_update_otn_stats(detection_option_tree_node_t*
     {
         for ( int i = 0; i < node->num_children; ++i )
             detection_option_node_update_otn_stats(node->children[i], &local_stats, checks,
-                timeouts, suspends);
+                timeouts, suspends, snapshot);
     }
 }
 
-void detection_option_tree_update_otn_stats(XHash* doth)
+static void detection_option_tree_update_otn_stats(XHash* doth, OtnStateMap* snapshot)
 {
     if ( !doth )
         return;
@@ -820,10 +902,41 @@ void detection_option_tree_update_otn_stats(XHash* doth)
         }
 
         if ( checks )
-            detection_option_node_update_otn_stats(node, nullptr, checks, timeouts, suspends);
+            detection_option_node_update_otn_stats(
+                node, nullptr, checks, timeouts, suspends, snapshot);
     }
 }
 
+void detection_option_tree_update_otn_stats(XHash* doth)
+{ detection_option_tree_update_otn_stats(doth, nullptr); }
+
+void detection_option_tree_snapshot_otn_stats(XHash* doth, OtnStateMap& snapshot)
+{ detection_option_tree_update_otn_stats(doth, &snapshot); }
+
+static void detection_option_node_reset_stats(detection_option_tree_node_t* node, unsigned i)
+{
+    auto& state = node->state[i];
+
+    state.elapsed = 0_ticks;
+    state.elapsed_match = 0_ticks;
+    state.elapsed_no_match = 0_ticks;
+    state.checks = 0;
+    state.latency_timeouts = 0;
+    state.latency_suspends = 0;
+
+    for ( int c = 0; c < node->num_children; ++c )
+        detection_option_node_reset_stats(node->children[c], i);
+}
+
+void detection_option_tree_reset_stats(XHash* doth, unsigned instance)
+{
+    if ( !doth )
+        return;
+
+    for ( auto hnode = doth->find_first_node(); hnode; hnode = doth->find_next_node() )
+        detection_option_node_reset_stats((detection_option_tree_node_t*)hnode->data, instance);
+}
+
 detection_option_tree_root_t* new_root(OptTreeNode* otn)
 {
     detection_option_tree_root_t* p = (detection_option_tree_root_t*)
@@ -33,6 +33,8 @@
 
 #include <sys/time.h>
 
+#include <unordered_map>
+
 #include "detection/rule_option_types.h"
 #include "time/clock_defs.h"
 #include "main/snort_debug.h"
@@ -44,6 +46,8 @@ class XHash;
 struct Packet;
 struct SnortConfig;
 }
+struct OptTreeNode;
+struct OtnState;
 struct RuleLatencyState;
 
 typedef int (* eval_func_t)(void* option_data, class Cursor&, snort::Packet*);
@@ -118,7 +122,15 @@ struct detection_option_eval_data_t
 
 // return existing data or add given and return nullptr
 void* add_detection_option(struct snort::SnortConfig*, option_type_t, void*);
-void* add_detection_option_tree(struct snort::SnortConfig*, detection_option_tree_node_t*);
+
+// replace the referenced tree with an existing equivalent or add it
+void add_detection_option_tree(struct snort::SnortConfig*, detection_option_tree_node_t**);
+
+// trees added by a thread with a set are kept in the set until it is merged
+struct DetectionOptionTreeSet;
+DetectionOptionTreeSet* new_detection_option_tree_set();
+void set_detection_option_tree_set(DetectionOptionTreeSet*);
+void merge_detection_option_tree_set(struct snort::SnortConfig*, DetectionOptionTreeSet*);
 
 int detection_option_node_evaluate(
     detection_option_tree_node_t*, detection_option_eval_data_t&, const class Cursor&);
@@ -126,6 +138,15 @@ int detection_option_node_evaluate(
 void print_option_tree(detection_option_tree_node_t*, int level);
 void detection_option_tree_update_otn_stats(snort::XHash*);
 
+// same as above but adds the tree stats of all threads to a snapshot
+// instead of the rule states so it may be called while packets are flowing
+typedef std::unordered_map<const OptTreeNode*, OtnState> OtnStateMap;
+void detection_option_tree_snapshot_otn_stats(snort::XHash*, OtnStateMap&);
+
+// clear the profile of the given packet thread; the caller must serialize
+// walks of the table since they share its cursor
+void detection_option_tree_reset_stats(snort::XHash*, unsigned instance);
+
 detection_option_tree_root_t* new_root(OptTreeNode*);
 void free_detection_option_root(void** existing_tree);
 
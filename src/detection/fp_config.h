@@ -140,6 +140,18 @@ public:
     unsigned get_queue_limit() const
     { return queue_limit; }
 
+    void set_build_threads(unsigned n)
+    { build_threads = n; }
+
+    unsigned get_build_threads() const
+    { return build_threads; }
+
+    void set_reload_reuse(bool b)
+    { reload_reuse = b; }
+
+    bool get_reload_reuse() const
+    { return reload_reuse; }
+
     const snort::MpseApi* get_search_api() const
     { return search_api; }
 
@@ -160,12 +172,14 @@ private:
     bool debug_print_fast_pattern = false;
     bool debug = false;
     bool search_opt = false;
+    bool reload_reuse = true;
 
     unsigned max_queue_events = 5;
     unsigned bleedover_port_limit = 1024;
     unsigned max_pattern_len = 0;
 
     unsigned queue_limit = 0;
+    unsigned build_threads = 0;  // 0 means default
 
     int portlists_flags = 0;
     int num_patterns_truncated = 0;  // due to max_pattern_len
@@ -48,6 +48,8 @@
 #include "parser/parser.h"
 #include "ports/port_table.h"
 #include "ports/rule_port_tables.h"
+#include "time/clock_defs.h"
+#include "time/stopwatch.h"
 #include "utils/stats.h"
 #include "utils/util.h"
 
@@ -83,14 +85,7 @@ static int finalize_detection_option_tree(SnortConfig* sc, detection_option_tree
 
     for ( int i=0; i<root->num_children; i++ )
     {
-        detection_option_tree_node_t* node = root->children[i];
-
-        if ( void* dup_node = add_detection_option_tree(sc, node) )
-        {
-            // FIXIT-L delete dup_node and keep original?
-            free_detection_option_tree(node);
-            root->children[i] = (detection_option_tree_node_t*)dup_node;
-        }
+        add_detection_option_tree(sc, &root->children[i]);
         print_option_tree(root->children[i], 0);
     }
 
@@ -1533,23 +1528,24 @@ static void fpCreateServiceRuleGroups(SnortConfig* sc)
     sc->srmmTable = nullptr;
 }
 
-static unsigned can_build_mt(FastPatternConfig* fp)
+static unsigned get_build_threads(const SnortConfig* sc, FastPatternConfig* fp)
 {
-    if ( Snort::is_reloading() )
-        return false;
-
     const MpseApi* search_api = fp->get_search_api();
     assert(search_api);
 
     if ( !MpseManager::parallel_compiles(search_api) )
-        return false;
+        return 1;
 
     const MpseApi* offload_search_api = fp->get_offload_search_api();
 
     if ( offload_search_api and !MpseManager::parallel_compiles(offload_search_api) )
-        return false;
+        return 1;
 
-    return true;
+    if ( unsigned n = fp->get_build_threads() )
+        return n;
+
+    // packet threads keep running during reload so don't compete by default
+    return Snort::is_reloading() ? 1 : sc->num_slots;
 }
 
 /*
@@ -1579,10 +1575,14 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
 
     MpseManager::start_search_engine(fp->get_search_api());
 
+    Stopwatch<SnortClock> groups_time, maps_time, services_time, compile_time;
+
     if ( log_rule_group_details )
         LogMessage("Creating Port Groups....\n");
 
+    groups_time.start();
     fpCreateRuleGroups(sc, port_tables);
+    groups_time.stop();
 
     if ( log_rule_group_details )
     {
@@ -1590,7 +1590,9 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
         LogMessage("Creating Rule Maps....\n");
     }
 
+    maps_time.start();
     fpCreateRuleMaps(sc, port_tables);
+    maps_time.stop();
 
     if ( log_rule_group_details )
     {
@@ -1598,26 +1600,40 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
         LogMessage("Creating Service Based Rule Maps....\n");
     }
 
+    services_time.start();
     fpCreateServiceRuleGroups(sc);
+    services_time.stop();
 
     if ( log_rule_group_details )
         LogMessage("Service Based Rule Maps Done....\n");
 
     unsigned mpse_loaded = 0;
     unsigned mpse_dumped = 0;
+    unsigned mpse_reused = 0;
+    unsigned build_threads = 0;
 
     if ( !sc->test_mode() or sc->mem_check() )
     {
+        compile_time.start();
+
+        // engines that can't be reused may still be in the rule db
+        MpseSet reused;
+
+        if ( Snort::is_reloading() and fp->get_reload_reuse() )
+            mpse_reused = fp_reuse(sc, SnortConfig::get_conf(), &reused);
+
         if ( !fp->get_rule_db_dir().empty() )
-            mpse_loaded = fp_deserialize(sc, fp->get_rule_db_dir());
+            mpse_loaded = fp_deserialize(sc, fp->get_rule_db_dir(), &reused);
 
-        unsigned c = compile_mpses(sc, can_build_mt(fp));
+        build_threads = get_build_threads(sc, fp);
+        unsigned c = compile_mpses(sc, build_threads);
         unsigned expected = mpse_count + offload_mpse_count;
 
         if ( c != expected )
             ParseError("Failed to compile %u search engines", expected - c);
 
         fixup_trees(sc);
+        compile_time.stop();
     }
 
     fp_print_port_groups(port_tables);
@@ -1641,6 +1657,14 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     LogCount("truncated patterns", fp->get_num_patterns_truncated());
     LogCount("mpse_loaded", mpse_loaded);
     LogCount("mpse_dumped", mpse_dumped);
+    LogCount("mpse_reused", mpse_reused);
+
+    LogLabel("rule group build time");
+    LogCount("build threads", build_threads);
+    LogTime("port groups", clock_usecs(TO_USECS(groups_time.get())));
+    LogTime("rule maps", clock_usecs(TO_USECS(maps_time.get())));
+    LogTime("service groups", clock_usecs(TO_USECS(services_time.get())));
+    LogTime("search engines", clock_usecs(TO_USECS(compile_time.get())));
 
     MpseManager::setup_search_engine(fp->get_search_api(), sc);
 
@@ -78,6 +78,7 @@
 #include "ips_context.h"
 #include "pattern_match_data.h"
 #include "pcrm.h"
+#include "rtn_checks.h"
 #include "rules.h"
 #include "service_map.h"
 #include "tag.h"
@@ -336,10 +337,7 @@ bool fp_eval_rtn(RuleTreeNode* rtn, Packet* p, int check_ports)
     if ( rtn->user_mode() )
         check_ports = 1;
 
-    if (!rtn->rule_func->RuleHeadFunc(p, rtn, rtn->rule_func, check_ports))
-        return false;
-
-    return true;
+    return CheckRuleHeader(p, rtn, check_ports != 0);
 }
 
 int fp_eval_option(void* v, Cursor& c, Packet* p)
@@ -22,6 +22,11 @@
 
 #include "fp_utils.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cassert>
 #include <cstring>
 #include <fstream>
@@ -30,6 +35,8 @@
 #include <mutex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "framework/mpse.h"
 #include "framework/mpse_batch.h"
@@ -37,6 +44,7 @@
 #include "log/messages.h"
 #include "main/snort_config.h"
 #include "parser/parse_conf.h"
+#include "detection_options.h"
 #include "pattern_match_data.h"
 #include "ports/port_group.h"
 #include "ports/port_table.h"
@@ -253,25 +261,42 @@ static bool store(const std::string& s, const uint8_t* data, size_t len)
     return true;
 }
 
+// databases are mapped rather than read so the engines can load their
+// state tables directly from the page cache without an intermediate copy
 static bool fetch(const std::string& s, uint8_t*& data, size_t& len)
 {
-    std::ifstream in(s.c_str(), std::ifstream::binary);
+    int fd = open(s.c_str(), O_RDONLY);
 
-    if ( !in.is_open() )
+    if ( fd < 0 )
         return false;
 
-    in.seekg (0, in.end);
-    len = in.tellg();
-    in.seekg (0);
+    struct stat st;
+
+    if ( fstat(fd, &st) or st.st_size <= 0 )
+    {
+        close(fd);
+        return false;
+    }
 
-    data = new uint8_t[len];
-    in.read((char*)data, len);
+    len = st.st_size;
+    void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
 
+    if ( p == MAP_FAILED )
+        return false;
+
+    data = (uint8_t*)p;
     return true;
 }
 
+static void release(uint8_t* data, size_t len)
+{
+    munmap(data, len);
+}
+
 static std::string make_db_name(
-    const std::string& path, const char* proto, const char* dir, const char* buf, const std::string& id)
+    const std::string& path, const char* proto, const char* dir, const char* buf,
+    const std::string& id, const char* method)
 {
     std::stringstream ss;
 
@@ -285,7 +310,11 @@ static std::string make_db_name(
     for ( auto c : id )
         ss << (unsigned)(uint8_t)c;
 
-    ss << ".hsdb";
+    // hyperscan databases keep the original suffix so existing dumps still load
+    if ( !strcmp(method, "hyperscan") )
+        ss << ".hsdb";
+    else
+        ss << "." << method;
 
     return ss.str();
 }
@@ -297,15 +326,18 @@ static bool db_dump(const std::string& path, const char* proto, const char* dir,
         if ( !g->mpsegrp[i] )
             continue;
 
+        Mpse* mpse = g->mpsegrp[i]->normal_mpse;
+
         std::string id;
-        g->mpsegrp[i]->normal_mpse->get_hash(id);
+        mpse->get_hash(id);
 
-        std::string file = make_db_name(path, proto, dir, pm_type_strings[i], id);
+        std::string file = make_db_name(path, proto, dir, pm_type_strings[i], id,
+            mpse->get_method());
 
         uint8_t* db = nullptr;
         size_t len = 0;
 
-        if ( g->mpsegrp[i]->normal_mpse->serialize(db, len) and db and len > 0 )
+        if ( mpse->serialize(db, len) and db and len > 0 )
         {
             store(file, db, len);
             free(db);
@@ -320,6 +352,8 @@ static bool db_dump(const std::string& path, const char* proto, const char* dir,
     return true;
 }
 
+static const MpseSet* skip_mpses = nullptr;
+
 static bool db_load(const std::string& path, const char* proto, const char* dir, RuleGroup* g)
 {
     for ( auto i = 0; i < PM_TYPE_MAX; ++i )
@@ -327,10 +361,16 @@ static bool db_load(const std::string& path, const char* proto, const char* dir,
         if ( !g->mpsegrp[i] )
             continue;
 
+        Mpse* mpse = g->mpsegrp[i]->normal_mpse;
+
+        if ( skip_mpses and skip_mpses->count(mpse) )
+            continue;
+
         std::string id;
-        g->mpsegrp[i]->normal_mpse->get_hash(id);
+        mpse->get_hash(id);
 
-        std::string file = make_db_name(path, proto, dir, pm_type_strings[i], id);
+        std::string file = make_db_name(path, proto, dir, pm_type_strings[i], id,
+            mpse->get_method());
 
         uint8_t* db = nullptr;
         size_t len = 0;
@@ -340,17 +380,94 @@ static bool db_load(const std::string& path, const char* proto, const char* dir,
             ParseWarning(WARN_RULES, "Failed to read %s", file.c_str());
             return false;
         }
-        else if ( !g->mpsegrp[i]->normal_mpse->deserialize(db, len) )
+        else if ( !mpse->deserialize(db, len) )
         {
             ParseWarning(WARN_RULES, "Failed to deserialize %s", file.c_str());
+            release(db, len);
             return false;
         }
-        delete[] db;
+        release(db, len);
         ++mpse_loaded;
     }
     return true;
 }
 
+// rule groups are rebuilt from scratch on reload and their match data
+// refers to the new rules so the old search engines can't be shared.
+// instead the compiled state of an engine with the same method and pattern
+// hash is copied into the new engine and the compile is skipped.
+
+typedef std::unordered_map<std::string, Mpse*> MpseIndex;
+static MpseIndex* reuse_index = nullptr;
+static MpseSet* reused_mpses = nullptr;
+static unsigned mpse_reused;
+
+static bool get_reuse_key(Mpse* mpse, std::string& key)
+{
+    std::string id;
+    mpse->get_hash(id);
+
+    if ( id.empty() )
+        return false;
+
+    key = mpse->get_method();
+    key += id;
+    return true;
+}
+
+static bool db_index(const std::string&, const char*, const char*, RuleGroup* g)
+{
+    for ( auto i = 0; i < PM_TYPE_MAX; ++i )
+    {
+        if ( !g->mpsegrp[i] or !g->mpsegrp[i]->normal_mpse )
+            continue;
+
+        Mpse* mpse = g->mpsegrp[i]->normal_mpse;
+        std::string key;
+
+        if ( get_reuse_key(mpse, key) )
+            reuse_index->emplace(key, mpse);
+    }
+    return true;
+}
+
+static bool db_reuse(const std::string&, const char*, const char*, RuleGroup* g)
+{
+    for ( auto i = 0; i < PM_TYPE_MAX; ++i )
+    {
+        if ( !g->mpsegrp[i] or !g->mpsegrp[i]->normal_mpse )
+            continue;
+
+        Mpse* mpse = g->mpsegrp[i]->normal_mpse;
+        std::string key;
+
+        if ( !get_reuse_key(mpse, key) )
+            continue;
+
+        auto it = reuse_index->find(key);
+
+        if ( it == reuse_index->end() )
+            continue;
+
+        uint8_t* db = nullptr;
+        size_t len = 0;
+
+        if ( !it->second->serialize(db, len) or !db )
+            continue;
+
+        if ( mpse->deserialize(db, len) )
+        {
+            if ( reused_mpses )
+                reused_mpses->emplace(mpse);
+
+            ++mpse_reused;
+        }
+
+        free(db);
+    }
+    return true;
+}
+
 typedef bool (*db_io)(const std::string&, const char*, const char*, RuleGroup*);
 
 static void port_io(
@@ -421,13 +538,33 @@ unsigned fp_serialize(const SnortConfig* sc, const std::string& dir)
     return mpse_dumped;
 }
 
-unsigned fp_deserialize(const SnortConfig* sc, const std::string& dir)
+unsigned fp_deserialize(const SnortConfig* sc, const std::string& dir, const MpseSet* skip)
 {
     mpse_loaded = 0;
+    skip_mpses = skip;
     fp_io(sc, dir, db_load);
+    skip_mpses = nullptr;
     return mpse_loaded;
 }
 
+unsigned fp_reuse(const SnortConfig* sc, const SnortConfig* old, MpseSet* reused)
+{
+    if ( !old or !old->port_tables or !old->spgmmTable )
+        return 0;
+
+    MpseIndex index;
+    reuse_index = &index;
+    fp_io(old, "", db_index);
+
+    mpse_reused = 0;
+    reused_mpses = reused;
+    fp_io(sc, "", db_reuse);
+
+    reused_mpses = nullptr;
+    reuse_index = nullptr;
+    return mpse_reused;
+}
+
 void validate_services(SnortConfig* sc, OptTreeNode* otn)
 {
     std::string svc;
@@ -580,9 +717,11 @@ static Mpse* get_mpse()
     return m;
 }
 
-static void compile_mpse(SnortConfig* sc, unsigned id, unsigned* count)
+static void compile_mpse(
+    SnortConfig* sc, unsigned id, unsigned* count, DetectionOptionTreeSet* trees)
 {
     set_instance_id(id);
+    set_detection_option_tree_set(trees);
     unsigned c = 0;
 
     while ( Mpse* m = get_mpse() )
@@ -590,6 +729,8 @@ static void compile_mpse(SnortConfig* sc, unsigned id, unsigned* count)
         if ( !m->prep_patterns(sc) )
             c++;
     }
+    set_detection_option_tree_set(nullptr);
+
     std::lock_guard<std::mutex> lock(s_mutex);
     *count += c;
 }
@@ -599,26 +740,33 @@ void queue_mpse(Mpse* m)
     s_tbd.push_back(m);
 }
 
-unsigned compile_mpses(struct SnortConfig* sc, bool parallel)
+unsigned compile_mpses(struct SnortConfig* sc, unsigned max)
 {
     std::list<std::thread*> workers;
-    unsigned max = parallel ? sc->num_slots : 1;
+    std::vector<DetectionOptionTreeSet*> trees;
     unsigned count = 0;
 
-    if ( max == 1 )
+    if ( max <= 1 )
     {
-        compile_mpse(sc, get_instance_id(), &count);
+        compile_mpse(sc, get_instance_id(), &count, nullptr);
         return count;
     }
 
     for ( unsigned i = 0; i < max; ++i )
-        workers.push_back(new std::thread(compile_mpse, sc, i, &count));
+    {
+        trees.push_back(new_detection_option_tree_set());
+        workers.push_back(new std::thread(compile_mpse, sc, i, &count, trees.back()));
+    }
 
     for ( auto* w : workers )
     {
         w->join();
         delete w;
     }
+
+    for ( auto* t : trees )
+        merge_detection_option_tree_set(sc, t);
+
     return count;
 }
 
@@ -24,6 +24,7 @@
 // fast pattern utilities
 
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "framework/ips_option.h"
@@ -46,12 +47,24 @@ std::vector <PatternMatchData*> get_fp_content(
     OptTreeNode*, OptFpList*&, bool srvc, bool only_literals, bool& exclude);
 
 void queue_mpse(snort::Mpse*);
-unsigned compile_mpses(struct snort::SnortConfig*, bool parallel = false);
+// compile queued mpses and their option trees with the given number of threads
+unsigned compile_mpses(struct snort::SnortConfig*, unsigned threads = 1);
 
 void validate_services(struct snort::SnortConfig*, OptTreeNode*);
 
+typedef std::unordered_set<const snort::Mpse*> MpseSet;
+
 unsigned fp_serialize(const struct snort::SnortConfig*, const std::string& dir);
-unsigned fp_deserialize(const struct snort::SnortConfig*, const std::string& dir);
+
+// engines in skip are already loaded and are left as is
+unsigned fp_deserialize(
+    const struct snort::SnortConfig*, const std::string& dir, const MpseSet* skip = nullptr);
+
+// load search engines from those in the old config with the same patterns;
+// the engines loaded are added to reused
+unsigned fp_reuse(
+    const struct snort::SnortConfig*, const struct snort::SnortConfig* old,
+    MpseSet* reused = nullptr);
 
 #endif
 
@@ -38,6 +38,10 @@
 #include "rules.h"
 #include "treenodes.h"
 
+#ifdef UNIT_TEST
+#include "catch/snort_catch.h"
+#endif
+
 using namespace snort;
 
 #define CHECK_SRC_IP         0x01
@@ -105,8 +109,7 @@ bail:
 #define CHECK_ADDR_SRC_ARGS(x) (x)->src_portobject
 #define CHECK_ADDR_DST_ARGS(x) (x)->dst_portobject
 
-int CheckBidirectional(Packet* p, RuleTreeNode* rtn_idx,
-    RuleFpList*, int check_ports)
+static bool CheckBidirectional(Packet* p, const RuleTreeNode* rtn_idx, bool check_ports)
 {
     if (CheckAddrPort(rtn_idx->sip, CHECK_ADDR_SRC_ARGS(rtn_idx), p,
         rtn_idx->flags, CHECK_SRC_IP | (check_ports ? CHECK_SRC_PORT : 0)))
@@ -120,12 +123,12 @@ int CheckBidirectional(Packet* p, RuleTreeNode* rtn_idx,
                 if (!CheckAddrPort(rtn_idx->sip, CHECK_ADDR_SRC_ARGS(rtn_idx), p, rtn_idx->flags,
                     (CHECK_DST_IP | INVERSE | (check_ports ? CHECK_DST_PORT : 0))))
                 {
-                    return 0;
+                    return false;
                 }
             }
             else
             {
-                return 0;
+                return false;
             }
         }
     }
@@ -137,129 +140,234 @@ int CheckBidirectional(Packet* p, RuleTreeNode* rtn_idx,
             if (!CheckAddrPort(rtn_idx->sip, CHECK_ADDR_SRC_ARGS(rtn_idx), p,
                 rtn_idx->flags, CHECK_DST_IP | INVERSE | (check_ports ? CHECK_DST_PORT : 0)))
             {
-                return 0;
+                return false;
             }
         }
         else
         {
-            return 0;
+            return false;
         }
     }
 
-    return 1;
+    return true;
 }
 
-// Purpose: Test the source IP and see if it equals the SIP of the packet
-// Returns: 0 on failure (no match), 1 on success (match)
-int CheckSrcIP(Packet* p, RuleTreeNode* rtn_idx, RuleFpList* fp_list, int check_ports)
+static bool CheckProto(const Packet* p, const RuleTreeNode* rtn_idx)
 {
-    if ( sfvar_ip_in(rtn_idx->sip, p->ptrs.ip_api.get_src()) )
-    {
-        /* the packet matches this test, proceed to the next test */
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
-    }
+    assert(rtn_idx->snort_protocol_id < SNORT_PROTO_MAX);
 
-    /* return 0 on a failed test */
-    return 0;
+    static const int proto_bits[SNORT_PROTO_MAX] =  // SNORT_PROTO_ to PROTO_BIT__*
+    {
+        /* n/a */  PROTO_BIT__NONE,
+        /* ip */   PROTO_BIT__IP | PROTO_BIT__TCP | PROTO_BIT__UDP,  // legacy
+        /* icmp */ PROTO_BIT__ICMP,
+        /* tcp */  PROTO_BIT__TCP | PROTO_BIT__PDU,
+        /* udp */  PROTO_BIT__UDP,
+        /* file */ PROTO_BIT__FILE | PROTO_BIT__PDU
+    };
+    return (proto_bits[rtn_idx->snort_protocol_id] & p->proto_bits) != 0;
 }
 
-// Purpose: Test the dest IP and see if it equals the DIP of the packet
-// Returns: 0 on failure (no match), 1 on success (match)
-int CheckDstIP(Packet* p, RuleTreeNode* rtn_idx, RuleFpList* fp_list, int check_ports)
+// Purpose: Run the header checks compiled for the rule in order
+// Returns: false on the first failed test (no match), true on success (match)
+// Port checks are skipped unless check_ports is set.
+bool CheckRuleHeader(Packet* p, const RuleTreeNode* rtn_idx, bool check_ports)
 {
-    if ( sfvar_ip_in(rtn_idx->dip, p->ptrs.ip_api.get_dst()) )
+    for ( const RuleHeadOp* op = rtn_idx->header_ops; ; ++op )
     {
-        /* the packet matches this test, proceed to the next test */
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
+        switch ( *op )
+        {
+        case RuleHeadOp::END:
+            return true;
+
+        case RuleHeadOp::PROTO:
+            if ( !CheckProto(p, rtn_idx) )
+                return false;
+            break;
+
+        case RuleHeadOp::SRC_IP:
+            if ( !sfvar_ip_in(rtn_idx->sip, p->ptrs.ip_api.get_src()) )
+                return false;
+            break;
+
+        case RuleHeadOp::DST_IP:
+            if ( !sfvar_ip_in(rtn_idx->dip, p->ptrs.ip_api.get_dst()) )
+                return false;
+            break;
+
+        case RuleHeadOp::SRC_PORT_EQ:
+            if ( check_ports and !PortObjectHasPort(rtn_idx->src_portobject, p->ptrs.sp) )
+                return false;
+            break;
+
+        case RuleHeadOp::SRC_PORT_NE:
+            if ( check_ports and PortObjectHasPort(rtn_idx->src_portobject, p->ptrs.sp) )
+                return false;
+            break;
+
+        case RuleHeadOp::DST_PORT_EQ:
+            if ( check_ports and !PortObjectHasPort(rtn_idx->dst_portobject, p->ptrs.dp) )
+                return false;
+            break;
+
+        case RuleHeadOp::DST_PORT_NE:
+            if ( check_ports and PortObjectHasPort(rtn_idx->dst_portobject, p->ptrs.dp) )
+                return false;
+            break;
+
+        case RuleHeadOp::BIDIRECTIONAL:
+            if ( !CheckBidirectional(p, rtn_idx, check_ports) )
+                return false;
+            break;
+        }
     }
-    return 0;
 }
 
-int CheckSrcPortEqual(Packet* p, RuleTreeNode* rtn_idx,
-    RuleFpList* fp_list, int check_ports)
+int OptListEnd(void*, Cursor&, Packet*)
 {
-    /* Check if attributes provided match earlier */
-    if (check_ports == 0)
-    {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
-    }
-    if ( PortObjectHasPort(rtn_idx->src_portobject,p->ptrs.sp) )
-    {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
-    }
-    return 0;
+    return (int)IpsOption::MATCH;
 }
 
-int CheckSrcPortNotEq(Packet* p, RuleTreeNode* rtn_idx,
-    RuleFpList* fp_list, int check_ports)
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+// 10.1.1.1:1234 -> 10.2.2.2:80 unless swapped
+struct RtnTest
 {
-    /* Check if attributes provided match earlier */
-    if (check_ports == 0)
+    RtnTest()
     {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
+        rtn.snort_protocol_id = SNORT_PROTO_TCP;
+        rtn.sip = sfvar_alloc(nullptr, "rtn_src 10.1.1.1", nullptr);
+        rtn.dip = sfvar_alloc(nullptr, "rtn_dst 10.2.2.2", nullptr);
+
+        rtn.src_portobject = PortObjectNew();
+        PortObjectAddPort(rtn.src_portobject, 1234);
+
+        rtn.dst_portobject = PortObjectNew();
+        PortObjectAddPort(rtn.dst_portobject, 80);
+
+        set_packet(false);
     }
-    if ( !PortObjectHasPort(rtn_idx->src_portobject,p->ptrs.sp) )
+
+    ~RtnTest()
     {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
+        sfvar_free(rtn.sip);
+        sfvar_free(rtn.dip);
+        PortObjectFree(rtn.src_portobject);
+        PortObjectFree(rtn.dst_portobject);
     }
 
-    return 0;
-}
-
-int CheckDstPortEqual(Packet* p, RuleTreeNode* rtn_idx,
-    RuleFpList* fp_list, int check_ports)
-{
-    /* Check if attributes provided match earlier */
-    if (check_ports == 0)
+    void set_packet(bool swap)
     {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
+        src.set(swap ? "10.2.2.2" : "10.1.1.1");
+        dst.set(swap ? "10.1.1.1" : "10.2.2.2");
+
+        pkt.ptrs.ip_api.set(src, dst);
+        pkt.ptrs.sp = swap ? 80 : 1234;
+        pkt.ptrs.dp = swap ? 1234 : 80;
+        pkt.proto_bits = PROTO_BIT__TCP;
     }
-    if ( PortObjectHasPort(rtn_idx->dst_portobject,p->ptrs.dp) )
+
+    bool check(RuleHeadOp op, bool check_ports = true)
     {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
+        rtn.header_ops[0] = op;
+        rtn.header_ops[1] = RuleHeadOp::END;
+        return CheckRuleHeader(&pkt, &rtn, check_ports);
     }
-    return 0;
+
+    RuleTreeNode rtn;
+    Packet pkt { false };
+    SfIp src;
+    SfIp dst;
+};
+
+TEST_CASE("rule header end", "[rtn_checks]")
+{
+    RtnTest t;
+    CHECK(t.check(RuleHeadOp::END));
 }
 
-int CheckDstPortNotEq(Packet* p, RuleTreeNode* rtn_idx,
-    RuleFpList* fp_list, int check_ports)
+TEST_CASE("rule header proto", "[rtn_checks]")
 {
-    /* Check if attributes provided match earlier */
-    if (check_ports == 0)
-    {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
-    }
-    if ( !PortObjectHasPort(rtn_idx->dst_portobject,p->ptrs.dp) )
-    {
-        return fp_list->next->RuleHeadFunc(p, rtn_idx, fp_list->next, check_ports);
-    }
+    RtnTest t;
+    CHECK(t.check(RuleHeadOp::PROTO));
+
+    t.pkt.proto_bits = PROTO_BIT__UDP;
+    CHECK(!t.check(RuleHeadOp::PROTO));
 
-    return 0;
+    // ip rules match tcp and udp
+    t.rtn.snort_protocol_id = SNORT_PROTO_IP;
+    CHECK(t.check(RuleHeadOp::PROTO));
 }
 
-int CheckProto(Packet* p, RuleTreeNode* rtn_idx, RuleFpList*, int)
+TEST_CASE("rule header addresses", "[rtn_checks]")
 {
-    assert(rtn_idx->snort_protocol_id < SNORT_PROTO_MAX);
+    RtnTest t;
+    CHECK(t.check(RuleHeadOp::SRC_IP));
+    CHECK(t.check(RuleHeadOp::DST_IP));
 
-    const int proto_bits[SNORT_PROTO_MAX] =  // SNORT_PROTO_ to PROTO_BIT__*
-    {
-        /* n/a */  PROTO_BIT__NONE,
-        /* ip */   PROTO_BIT__IP | PROTO_BIT__TCP | PROTO_BIT__UDP,  // legacy
-        /* icmp */ PROTO_BIT__ICMP,
-        /* tcp */  PROTO_BIT__TCP | PROTO_BIT__PDU,
-        /* udp */  PROTO_BIT__UDP,
-        /* file */ PROTO_BIT__FILE | PROTO_BIT__PDU
-    };
-    return proto_bits[rtn_idx->snort_protocol_id] & p->proto_bits;
+    t.set_packet(true);
+    CHECK(!t.check(RuleHeadOp::SRC_IP));
+    CHECK(!t.check(RuleHeadOp::DST_IP));
 }
 
-int RuleListEnd(Packet*, RuleTreeNode*, RuleFpList*, int)
+TEST_CASE("rule header ports", "[rtn_checks]")
 {
-    return 1;
+    RtnTest t;
+    CHECK(t.check(RuleHeadOp::SRC_PORT_EQ));
+    CHECK(!t.check(RuleHeadOp::SRC_PORT_NE));
+    CHECK(t.check(RuleHeadOp::DST_PORT_EQ));
+    CHECK(!t.check(RuleHeadOp::DST_PORT_NE));
+
+    t.set_packet(true);
+    CHECK(!t.check(RuleHeadOp::SRC_PORT_EQ));
+    CHECK(t.check(RuleHeadOp::SRC_PORT_NE));
+    CHECK(!t.check(RuleHeadOp::DST_PORT_EQ));
+    CHECK(t.check(RuleHeadOp::DST_PORT_NE));
+
+    // port checks are skipped unless requested
+    CHECK(t.check(RuleHeadOp::SRC_PORT_EQ, false));
+    CHECK(t.check(RuleHeadOp::DST_PORT_EQ, false));
 }
 
-int OptListEnd(void*, Cursor&, Packet*)
+TEST_CASE("rule header bidirectional", "[rtn_checks]")
 {
-    return (int)IpsOption::MATCH;
+    RtnTest t;
+    CHECK(t.check(RuleHeadOp::BIDIRECTIONAL));
+
+    t.set_packet(true);
+    CHECK(t.check(RuleHeadOp::BIDIRECTIONAL));
+
+    // the reverse direction still needs the reverse ports
+    t.pkt.ptrs.sp = 1234;
+    CHECK(!t.check(RuleHeadOp::BIDIRECTIONAL));
+    CHECK(t.check(RuleHeadOp::BIDIRECTIONAL, false));
+}
+
+TEST_CASE("rule header stops at the first failure", "[rtn_checks]")
+{
+    RtnTest t;
+    const RuleHeadOp ops[] =
+    {
+        RuleHeadOp::PROTO, RuleHeadOp::DST_PORT_EQ, RuleHeadOp::SRC_PORT_EQ,
+        RuleHeadOp::SRC_IP, RuleHeadOp::DST_IP, RuleHeadOp::END
+    };
+    static_assert(sizeof(ops) / sizeof(ops[0]) == RuleTreeNode::max_header_ops, "");
+
+    for ( unsigned i = 0; i < RuleTreeNode::max_header_ops; ++i )
+        t.rtn.header_ops[i] = ops[i];
+
+    CHECK(CheckRuleHeader(&t.pkt, &t.rtn, true));
+
+    t.pkt.ptrs.dp = 81;
+    CHECK(!CheckRuleHeader(&t.pkt, &t.rtn, true));
+    CHECK(CheckRuleHeader(&t.pkt, &t.rtn, false));
+
+    t.pkt.proto_bits = PROTO_BIT__ICMP;
+    CHECK(!CheckRuleHeader(&t.pkt, &t.rtn, false));
 }
 
+#endif
@@ -25,24 +25,13 @@ namespace snort
 {
     struct Packet;
 }
-struct RuleFpList;
 struct RuleTreeNode;
 
 // parsing
-int RuleListEnd(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
 int OptListEnd(void* option_data, class Cursor&, snort::Packet*);
 
 // detection
-int CheckBidirectional(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
-
-int CheckProto(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
-int CheckSrcIP(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
-int CheckDstIP(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
-
-int CheckSrcPortEqual(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
-int CheckDstPortEqual(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
-int CheckSrcPortNotEq(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
-int CheckDstPortNotEq(snort::Packet*, RuleTreeNode*, RuleFpList*, int);
+bool CheckRuleHeader(snort::Packet*, const RuleTreeNode*, bool check_ports);
 
 #endif
 
@@ -130,28 +130,9 @@ RuleTreeNode* RuleStateMap::dup_rtn(RuleTreeNode* rtn, IpsPolicy* policy)
     ret->dst_portobject = dpo ? dpo : ret->dst_portobject;
     ret->otnRefCount = 0;
 
+    // the header checks are copied with the node unless they must be redone
     if ( sip or dip or spo or dpo )
-    {
-        ret->rule_func = nullptr;
         parse_rule_process_rtn(ret);
-        return ret;
-    }
-
-    RuleFpList* from = rtn->rule_func;
-
-    if ( from )
-    {
-        RuleFpList* to = new RuleFpList(*from);
-        to->next = nullptr;
-        ret->rule_func = to;
-
-        for ( from = from->next; from; from = from->next )
-        {
-            to->next = new RuleFpList(*from);
-            to = to->next;
-            to->next = nullptr;
-        }
-    }
 
     return ret;
 }
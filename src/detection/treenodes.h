@@ -74,19 +74,13 @@ struct OtnState
     { return elapsed > 0_ticks || checks > 0; }
 };
 
-/* function pointer list for rule head nodes */
-// FIXIT-L use bit mask to determine what header checks to do
-// cheaper than traversing a list and uses much less memory
-struct RuleFpList
+// rule header checks are compiled into a short array of these when the
+// rule is parsed and run in order until one fails or END is reached
+enum class RuleHeadOp : uint8_t
 {
-    /* context data for this test */
-    void* context = nullptr;
-
-    /* rule check function pointer */
-    int (* RuleHeadFunc)(snort::Packet*, RuleTreeNode*, RuleFpList*, int) = nullptr;
-
-    /* pointer to the next rule function node */
-    RuleFpList* next = nullptr;
+    END, PROTO, SRC_IP, DST_IP,
+    SRC_PORT_EQ, SRC_PORT_NE, DST_PORT_EQ, DST_PORT_NE,
+    BIDIRECTIONAL
 };
 
 struct RuleHeader
@@ -116,7 +110,10 @@ struct RuleTreeNode
     static constexpr Flag ANY_DST_IP    = 0x40;
     static constexpr Flag USER_MODE     = 0x80;
 
-    RuleFpList* rule_func = nullptr; /* match functions.. (Bidirectional etc.. ) */
+    // at most 4 address and port checks, proto, and END
+    static constexpr unsigned max_header_ops = 6;
+
+    RuleHeadOp header_ops[max_header_ops] = { };
     RuleHeader* header = nullptr;
 
     sfip_var_t* sip = nullptr;
@@ -43,6 +43,7 @@ namespace snort
 {
 class FileCapture;
 class FileInspect;
+class Sha256;
 class Flow;
 
 class SO_PUBLIC FileInfo
@@ -155,7 +156,7 @@ public:
 private:
     uint64_t processed_bytes = 0;
     void* file_type_context;
-    void* file_signature_context;
+    Sha256* file_signature_context;
     FileSegments* file_segments;
     FileInspect* inspector;
     FileConfig*  config;
@@ -549,7 +549,7 @@ bool Flow::is_direction_aborted(bool from_client) const
 void Flow::set_service(Packet* pkt, const char* new_service)
 {
     service = new_service;
-    DataBus::publish(FLOW_SERVICE_CHANGE_EVENT, pkt);
+    DataBus::publish(FLOW_SERVICE_CHANGE_EVENT_ID, pkt);
 }
 
 void Flow::swap_roles()
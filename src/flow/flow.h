@@ -36,6 +36,7 @@
 #include "framework/data_bus.h"
 #include "framework/decode_data.h"
 #include "framework/inspector.h"
+#include "memory/memory_arena.h"
 #include "protocols/layer.h"
 #include "sfip/sf_ip.h"
 #include "target_based/snort_protocols.h"
@@ -169,6 +170,12 @@ public:
     Flow();
     ~Flow();
 
+    static void* operator new(size_t n)
+    { return memory::MemoryArena::allocate(n); }
+
+    static void operator delete(void* p, size_t n)
+    { memory::MemoryArena::deallocate(p, n); }
+
     Flow(const Flow&) = delete;
     Flow& operator=(const Flow&) = delete;
 
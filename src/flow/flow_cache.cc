@@ -110,6 +110,15 @@ Flow* FlowCache::find(const FlowKey* key)
     return flow;
 }
 
+unsigned FlowCache::prefetch_row(const FlowKey* key)
+{ return hash_table->prefetch_row(key); }
+
+void FlowCache::prefetch_node(unsigned row)
+{ hash_table->prefetch_node(row); }
+
+void FlowCache::prefetch_flow(unsigned row)
+{ hash_table->prefetch_data(row); }
+
 // always prepend
 void FlowCache::link_uni(Flow* flow)
 {
@@ -54,6 +54,11 @@ public:
     snort::Flow* find(const snort::FlowKey*);
     snort::Flow* allocate(const snort::FlowKey*);
 
+    // see XHash::prefetch_row
+    unsigned prefetch_row(const snort::FlowKey*);
+    void prefetch_node(unsigned row);
+    void prefetch_flow(unsigned row);
+
     bool release(snort::Flow*, PruneReason = PruneReason::NONE, bool do_cleanup = true);
 
     unsigned prune_stale(uint32_t thetime, const snort::Flow* save_me);
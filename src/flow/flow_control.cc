@@ -22,6 +22,8 @@
 
 #include <daq_common.h>
 
+#include <cstring>
+
 #include "flow_control.h"
 
 #include "detection/detection_engine.h"
@@ -38,6 +40,7 @@
 
 #include "expect_cache.h"
 #include "flow_cache.h"
+#include "flow_key.h"
 #include "ha.h"
 #include "session.h"
 
@@ -46,6 +49,7 @@ using namespace snort;
 FlowControl::FlowControl(const FlowCacheConfig& fc)
 {
     cache = new FlowCache(fc);
+    prefetch_keys = new FlowKey[max_prefetch];
 }
 
 FlowControl::~FlowControl()
@@ -53,6 +57,7 @@ FlowControl::~FlowControl()
     DetectionEngine de;
 
     delete cache;
+    delete[] prefetch_keys;
     snort_free(mem);
     delete exp_cache;
 }
@@ -77,12 +82,62 @@ void FlowControl::clear_counts()
 {
     cache->reset_stats();
     num_flows = 0;
+    num_prefetches = 0;
+    num_prefetch_hits = 0;
 }
 
 //-------------------------------------------------------------------------
 // cache foo
 //-------------------------------------------------------------------------
 
+void FlowControl::prefetch(const FlowKey* keys, unsigned num)
+{
+    if ( num > max_prefetch )
+        num = max_prefetch;
+
+    memcpy(prefetch_keys, keys, num * sizeof(*keys));
+    prefetch_count = num;
+    prefetch_next = 0;
+
+    for ( unsigned i = 0; i < num; ++i )
+        prefetch_rows[i] = cache->prefetch_row(keys + i);
+
+    for ( unsigned i = 0; i < num; ++i )
+        cache->prefetch_node(prefetch_rows[i]);
+
+    if ( num )
+        cache->prefetch_flow(prefetch_rows[0]);
+
+    num_prefetches += num;
+}
+
+// keys that were skipped or guessed wrong leave gaps so look a little ahead
+// for the one matching this packet before giving up
+void FlowControl::check_prefetch(const FlowKey& key, const Flow* flow)
+{
+    const unsigned max_skip = 4;
+    unsigned end = prefetch_next + max_skip;
+
+    if ( end > prefetch_count )
+        end = prefetch_count;
+
+    for ( unsigned i = prefetch_next; i < end; ++i )
+    {
+        if ( !FlowKey::is_equal(&key, prefetch_keys + i, sizeof(key)) )
+            continue;
+
+        if ( flow )
+            ++num_prefetch_hits;
+
+        prefetch_next = i + 1;
+
+        if ( prefetch_next < prefetch_count )
+            cache->prefetch_flow(prefetch_rows[prefetch_next]);
+
+        return;
+    }
+}
+
 void FlowControl::set_flow_cache_config(const FlowCacheConfig& cfg)
 { cache->set_flow_cache_config(cfg); }
 
@@ -373,6 +428,9 @@ bool FlowControl::process(PktType type, Packet* p, bool* new_flow)
     set_key(&key, p);
     Flow* flow = cache->find(&key);
 
+    if ( prefetch_next < prefetch_count )
+        check_prefetch(key, flow);
+
     if (flow)
         flow = stale_flow_cleanup(cache, flow, p);
 
@@ -452,7 +510,7 @@ unsigned FlowControl::process(Flow* flow, Packet* p)
         check_expected_flow(flow, p);
 
         flow->set_client_initiate(p);
-        DataBus::publish(FLOW_STATE_SETUP_EVENT, p);
+        DataBus::publish(FLOW_STATE_SETUP_EVENT_ID, p);
 
         if ( flow->flow_state == Flow::FlowState::SETUP ||
             (flow->flow_state == Flow::FlowState::INSPECT &&
@@ -59,6 +59,12 @@ public:
     unsigned get_flows_allocated() const;
 
     bool process(PktType, snort::Packet*, bool* new_flow = nullptr);
+
+    // keys of the packets about to be processed, in order.  the rows and
+    // head nodes are prefetched now and each flow just before its packet.
+    // keys past max_prefetch are ignored.
+    static constexpr unsigned max_prefetch = 64;
+    void prefetch(const snort::FlowKey*, unsigned num);
     snort::Flow* find_flow(const snort::FlowKey*);
     snort::Flow* new_flow(const snort::FlowKey*);
     void release_flow(const snort::FlowKey*);
@@ -88,6 +94,12 @@ public:
     PegCount get_flows()
     { return num_flows; }
 
+    PegCount get_prefetches() const
+    { return num_prefetches; }
+
+    PegCount get_prefetch_hits() const
+    { return num_prefetch_hits; }
+
     PegCount get_total_prunes() const;
     PegCount get_prunes(PruneReason) const;
     PegCount get_total_deletes() const;
@@ -95,17 +107,27 @@ public:
     void clear_counts();
 
 private:
+    friend struct TEST_GROUP_CppUTestGroupflow_prefetch; // for unit test
+
     void set_key(snort::FlowKey*, snort::Packet*);
     unsigned process(snort::Flow*, snort::Packet*);
     void update_stats(snort::Flow*, snort::Packet*);
+    void check_prefetch(const snort::FlowKey&, const snort::Flow*);
 
 private:
     snort::InspectSsnFunc get_proto_session[to_utype(PktType::MAX)] = {};
     PegCount num_flows = 0;
+    PegCount num_prefetches = 0;
+    PegCount num_prefetch_hits = 0;
     FlowCache* cache = nullptr;
     snort::Flow* mem = nullptr;
     class ExpectCache* exp_cache = nullptr;
     PktType last_pkt_type = PktType::NONE;
+
+    snort::FlowKey* prefetch_keys = nullptr;
+    unsigned prefetch_rows[max_prefetch];
+    unsigned prefetch_count = 0;
+    unsigned prefetch_next = 0;
 };
 
 #endif
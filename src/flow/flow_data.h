@@ -21,6 +21,7 @@
 #define FLOW_DATA_H
 
 #include "main/snort_types.h"
+#include "memory/memory_arena.h"
 
 namespace snort
 {
@@ -33,6 +34,13 @@ public:
     FlowData(unsigned u, Inspector* = nullptr);
     virtual ~FlowData();
 
+    // flow data of all inspectors comes from the per thread arena
+    static void* operator new(size_t n)
+    { return memory::MemoryArena::allocate(n); }
+
+    static void operator delete(void* p, size_t n)
+    { memory::MemoryArena::deallocate(p, n); }
+
     unsigned get_id()
     { return id; }
 
@@ -24,6 +24,17 @@
 
 #include "flow/flow_key.h"
 
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define HAVE_CRC32_HASH
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "hash/hash_key_operations.h"
 #include "main/snort_config.h"
 #include "protocols/icmp4.h"
@@ -408,57 +419,67 @@ bool FlowKey::init(
 // hash foo
 //-------------------------------------------------------------------------
 
+static_assert(sizeof(FlowKey) == 52, "is_equal and the hashes assume a 52 byte key");
+
+#ifdef __SSE2__
 bool FlowKey::is_equal(const void* s1, const void* s2, size_t)
 {
-    const uint64_t* a = (const uint64_t*)s1;
-    const uint64_t* b = (const uint64_t*)s2;
-    const uint32_t* c;
-    const uint32_t* d;
-
-    if (*a - *b)
-        return false;               /* Compares IPv4 lo/hi
-                                   Compares IPv6 low[0,1] */
-
-    a++;
-    b++;
-    if (*a - *b)
-        return false;               /* Compares port lo/hi, vlan, protocol, version
-                                   Compares IPv6 low[2,3] */
-
-    a++;
-    b++;
-    if (*a - *b)
-        return false;               /* Compares IPv6 hi[0,1] */
-
-    a++;
-    b++;
-    if (*a - *b)
-        return false;               /* Compares IPv6 hi[2,3] */
-
-    a++;
-    b++;
-    if (*a - *b)
-        return false;               /* Compares MPLS label, port lo/hi */
-
-    a++;
-    b++;
-    if (*a - *b)
-        return false;               /* Compares group lo/hi, addressSpaceId, vlan */
-
-    c = (const uint32_t*)(++a);
-    d = (const uint32_t*)(++b);
-    if (*c - *d)
-        return false;               /* ip_proto, type, version, 8 bit pad */
-
-    return true;
+    const uint8_t* a = (const uint8_t*)s1;
+    const uint8_t* b = (const uint8_t*)s2;
+
+    // low ip first since that is where different ipv4 keys usually differ
+    __m128i x = _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i*)a), _mm_loadu_si128((const __m128i*)b));
+
+    if ( _mm_movemask_epi8(x) != 0xffff )
+        return false;
+
+    // high ip, mpls label, ports, groups, address space, vlan
+    x = _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i*)(a + 16)), _mm_loadu_si128((const __m128i*)(b + 16)));
+
+    x = _mm_and_si128(x, _mm_cmpeq_epi8(
+        _mm_loadu_si128((const __m128i*)(a + 32)), _mm_loadu_si128((const __m128i*)(b + 32))));
+
+    if ( _mm_movemask_epi8(x) != 0xffff )
+        return false;
+
+    // ip_proto, type, version, flags
+    uint32_t c, d;
+    memcpy(&c, a + 48, sizeof(c));
+    memcpy(&d, b + 48, sizeof(d));
+
+    return c == d;
+}
+#else
+bool FlowKey::is_equal(const void* s1, const void* s2, size_t)
+{
+    return !memcmp(s1, s2, sizeof(FlowKey));
+}
+#endif
+
+FlowHashKeyOps::FlowHashKeyOps(int rows) : HashKeyOperations(rows)
+{
+#ifdef HAVE_CRC32_HASH
+    // static hashes must give the same rows on every host
+    use_crc = !SnortConfig::static_hash() and __builtin_cpu_supports("sse4.2");
+#else
+    use_crc = false;
+#endif
 }
 
 unsigned FlowHashKeyOps::do_hash(const unsigned char* k, int)
+{
+    return use_crc ? crc_hash(k) : mix_hash(k);
+}
+
+unsigned FlowHashKeyOps::mix_hash(const unsigned char* k)
 {
     uint32_t a, b, c;
     a = b = c = hardener;
 
-    const uint32_t* d = (const uint32_t*)k;
+    uint32_t d[13];
+    memcpy(d, k, sizeof(d));
 
     a += d[0];   // IPv6 lo[0]
     b += d[1];   // IPv6 lo[1]
@@ -491,6 +512,45 @@ unsigned FlowHashKeyOps::do_hash(const unsigned char* k, int)
     return c;
 }
 
+#ifdef HAVE_CRC32_HASH
+// two independent crc lanes over the key followed by the jenkins final mix.
+// crc is linear so the random keys are added, not xored, to each word first;
+// otherwise colliding keys could be found without knowing the keys.
+__attribute__((target("sse4.2")))
+unsigned FlowHashKeyOps::crc_hash(const unsigned char* k)
+{
+    const uint64_t k0 = ((uint64_t)hardener << 32) | seed;
+    const uint64_t k1 = ((uint64_t)scale << 32) | hardener;
+
+    uint64_t d[6];
+    memcpy(d, k, sizeof(d));
+
+    uint64_t a = _mm_crc32_u64(seed, d[0] + k0);     // IPv6 lo[0,1]
+    uint64_t b = _mm_crc32_u64(scale, d[1] + k1);    // IPv6 lo[2,3]
+
+    a = _mm_crc32_u64(a, d[2] + k1);  // IPv6 hi[0,1]
+    b = _mm_crc32_u64(b, d[3] + k0);  // IPv6 hi[2,3]
+
+    a = _mm_crc32_u64(a, d[4] + k0);  // mpls label, port lo & port hi
+    b = _mm_crc32_u64(b, d[5] + k1);  // group lo & group hi, addressSpaceId, vlan
+
+    uint32_t t;
+    memcpy(&t, k + 48, sizeof(t));
+
+    a = _mm_crc32_u32(a, t + hardener);  // ip_proto, pkt_type, version, pad
+
+    uint32_t x = a, y = b, z = hardener;
+    finalize(x, y, z);
+
+    return z;
+}
+#else
+unsigned FlowHashKeyOps::crc_hash(const unsigned char* k)
+{
+    return mix_hash(k);
+}
+#endif
+
 bool FlowHashKeyOps::key_compare(const void* k1, const void* k2, size_t len)
 {
     return FlowKey::is_equal(k1, k2, len);
@@ -38,15 +38,25 @@ namespace snort
 struct SfIp;
 struct SnortConfig;
 
+// flow keys are hashed with the sse4.2 crc32 instruction when the cpu
+// supports it and static hashing is not configured, otherwise with the
+// portable jenkins mix.  both are seeded from the per instance random values.
 class FlowHashKeyOps : public HashKeyOperations
 {
 public:
-    FlowHashKeyOps(int rows)
-        : HashKeyOperations(rows)
-    { }
+    FlowHashKeyOps(int rows);
 
     unsigned do_hash(const unsigned char* k, int len) override;
     bool key_compare(const void* k1, const void* k2, size_t) override;
+
+    bool using_crc() const
+    { return use_crc; }
+
+    unsigned mix_hash(const unsigned char* k);
+    unsigned crc_hash(const unsigned char* k);
+
+private:
+    bool use_crc;
 };
 
 
@@ -42,7 +42,8 @@ using namespace snort;
 enum HAEvent
 {
     HA_DELETE_EVENT = 1,
-    HA_UPDATE_EVENT = 2
+    HA_UPDATE_EVENT = 2,
+    HA_BATCH_EVENT = 3
 };
 
 struct __attribute__((__packed__)) HAMessageHeader
@@ -64,17 +65,51 @@ struct __attribute__((__packed__)) HAClientHeader
 //   session client has handle of 0 and index of 0
 static constexpr uint8_t MAX_CLIENTS = 17;
 
+// Coalesces outgoing messages into one side channel message.  Messages are
+// written back to back into the batch buffer and sent after a batch header
+// (an HA header with no key); the receiver splits only batches, using the
+// total length in each message header.  The batch is sent when the next
+// message doesn't fit, when the oldest message has waited max_latency, or
+// when it is flushed at the end of each DAQ batch.
+class HAMessageBatch
+{
+public:
+    HAMessageBatch(SideChannel& sc, uint32_t max_size, const struct timeval& max_latency) :
+        sc(sc), max_size(max_size), max_latency(max_latency)
+    { buffer = new uint8_t[max_size]; }
+
+    ~HAMessageBatch()
+    {
+        flush();
+        delete[] buffer;
+    }
+
+    // returns nullptr if a message of this length can't be batched
+    uint8_t* reserve(uint32_t len);
+    void commit(uint32_t len);
+    void flush();
+
+private:
+    SideChannel& sc;
+    uint8_t* buffer;
+    uint32_t length = 0;
+    const uint32_t max_size;
+    const struct timeval max_latency;
+    struct timeval deadline = { };
+};
+
 // HighAvailability is the thread-local state/configuration instantiated for each packet thread.
 typedef std::array<FlowHAClient*, MAX_CLIENTS> ClientMap;
 class HighAvailability
 {
 public:
-    HighAvailability(PortBitSet*,bool);
+    HighAvailability(PortBitSet*, bool, uint32_t max_batch_size, const struct timeval& max_batch_latency);
     ~HighAvailability();
 
     void process_update(Flow*, Packet*);
     void process_deletion(Flow&);
     void process_receive();
+    void flush();
 
     Flow* process_daq_import(Packet&, FlowKey&);
 
@@ -86,6 +121,7 @@ public:
 
 private:
     SideChannel* sc = nullptr;
+    HAMessageBatch* batch = nullptr;
     bool use_daq_channel;
 };
 
@@ -107,6 +143,8 @@ static constexpr uint8_t SESSION_HA_CLIENT_INDEX = 0;
 
 PortBitSet* HighAvailabilityManager::ports = nullptr;
 bool HighAvailabilityManager::use_daq_channel = false;
+uint32_t HighAvailabilityManager::max_batch_size = 0;
+struct timeval HighAvailabilityManager::max_batch_latency = { };
 
 struct timeval FlowHAState::min_session_lifetime;
 struct timeval FlowHAState::min_sync_interval;
@@ -524,6 +562,38 @@ static Flow* consume_ha_message(HAMessage& msg,
     return flow;
 }
 
+static bool is_ha_batch(const uint8_t* content, uint32_t length)
+{
+    const HAMessageHeader* hdr = (const HAMessageHeader*) content;
+
+    return length > sizeof(HAMessageHeader) and hdr->event == HA_BATCH_EVENT and
+        hdr->version == HA_MESSAGE_VERSION and hdr->total_length == length;
+}
+
+// Any message in a batch that claims to run past the end of the batch is
+// passed along whole so that the length mismatch is caught and counted.
+static void consume_ha_batch(uint8_t* content, uint32_t remaining)
+{
+    while (remaining)
+    {
+        const HAMessageHeader* hdr = (HAMessageHeader*) content;
+        uint32_t len = remaining;
+
+        if (remaining >= sizeof(HAMessageHeader) and hdr->total_length
+            and hdr->total_length < remaining)
+            len = hdr->total_length;
+
+        HAMessage ha_msg(content, len);
+        consume_ha_message(ha_msg);
+
+        content += len;
+        remaining -= len;
+    }
+}
+
+// A side channel message carries several HA messages only if the partner
+// batches.  Anything else is a single HA message and is not split, since an
+// update shorter than its side channel message has an unwritten tail.
 static void ha_sc_receive_handler(SCMessage* sc_msg)
 {
     assert(sc_msg);
@@ -531,13 +601,74 @@ static void ha_sc_receive_handler(SCMessage* sc_msg)
     // SC received messages must have reference back to SideChannel object
     assert(sc_msg->sc);
 
-    HAMessage ha_msg(sc_msg->content, sc_msg->content_length);
-    consume_ha_message(ha_msg);
+    if (is_ha_batch(sc_msg->content, sc_msg->content_length))
+    {
+        consume_ha_batch(sc_msg->content + sizeof(HAMessageHeader),
+            sc_msg->content_length - sizeof(HAMessageHeader));
+    }
+    else
+    {
+        HAMessage ha_msg(sc_msg->content, sc_msg->content_length);
+        consume_ha_message(ha_msg);
+    }
 
     sc_msg->sc->discard_message(sc_msg);
 }
 
-HighAvailability::HighAvailability(PortBitSet* ports, bool daq_channel)
+uint8_t* HAMessageBatch::reserve(uint32_t len)
+{
+    if (len > max_size)
+        return nullptr;
+
+    if (len > max_size - length)
+        flush();
+
+    return buffer + length;
+}
+
+void HAMessageBatch::commit(uint32_t len)
+{
+    length += len;
+    ha_stats.batched_msgs++;
+
+    // with no latency limit the batch is held until it is full or flushed
+    if (!timerisset(&max_latency))
+        return;
+
+    struct timeval now;
+    packet_gettimeofday(&now);
+
+    if (length == len)
+        timeradd(&now, &max_latency, &deadline);
+    else if (!timercmp(&now, &deadline, <))
+        flush();
+}
+
+void HAMessageBatch::flush()
+{
+    if (!length)
+        return;
+
+    const uint32_t total_length = sizeof(HAMessageHeader) + length;
+    SCMessage* sc_msg = sc.alloc_transmit_message(total_length);
+
+    if (sc_msg)
+    {
+        HAMessageHeader* hdr = (HAMessageHeader*) sc_msg->content;
+        hdr->event = HA_BATCH_EVENT;
+        hdr->version = HA_MESSAGE_VERSION;
+        hdr->total_length = total_length;
+        hdr->key_type = 0;
+
+        memcpy(sc_msg->content + sizeof(HAMessageHeader), buffer, length);
+        sc.transmit_message(sc_msg);
+        ha_stats.batches_sent++;
+    }
+    length = 0;
+}
+
+HighAvailability::HighAvailability(PortBitSet* ports, bool daq_channel,
+    uint32_t max_batch_size, const struct timeval& max_batch_latency)
 {
     using namespace std::placeholders;
 
@@ -564,25 +695,48 @@ HighAvailability::HighAvailability(PortBitSet* ports, bool daq_channel)
             break;
         }
     }
+    if (sc && max_batch_size)
+        batch = new HAMessageBatch(*sc, max_batch_size, max_batch_latency);
+
     use_daq_channel = daq_channel;
 }
 
 HighAvailability::~HighAvailability()
 {
+    // the side channel is still up so anything batched is sent
+    delete batch;
+
     if (sc)
         sc->unregister_receive_handler();
 }
 
-static void send_sc_update_message(Flow& flow, SideChannel& sc)
+void HighAvailability::flush()
+{
+    if (batch)
+        batch->flush();
+}
+
+static void send_sc_update_message(Flow& flow, SideChannel& sc, HAMessageBatch* batch)
 {
     const uint16_t header_len = calculate_msg_header_length(flow);
     const uint16_t content_len = calculate_update_msg_content_length(flow, false);
+    const uint32_t msg_len = header_len + content_len;
 
-    SCMessage* sc_msg = sc.alloc_transmit_message((uint32_t) (header_len + content_len));
+    if (uint8_t* buf = batch ? batch->reserve(msg_len) : nullptr)
+    {
+        HAMessage ha_msg(buf, msg_len);
+
+        write_msg_header(flow, HA_UPDATE_EVENT, msg_len, ha_msg);
+        write_update_msg_content(flow, ha_msg, false);
+        batch->commit(update_msg_header_length(ha_msg));
+        return;
+    }
+
+    SCMessage* sc_msg = sc.alloc_transmit_message(msg_len);
     assert(sc_msg);
     HAMessage ha_msg(sc_msg->content, sc_msg->content_length);
 
-    write_msg_header(flow, HA_UPDATE_EVENT, header_len + content_len, ha_msg);
+    write_msg_header(flow, HA_UPDATE_EVENT, msg_len, ha_msg);
     write_update_msg_content(flow, ha_msg, false);
     update_msg_header_length(ha_msg);
     sc.transmit_message(sc_msg);
@@ -622,7 +776,7 @@ void HighAvailability::process_update(Flow* flow, Packet* p)
         return;
 
     if (sc)
-        send_sc_update_message(*flow, *sc);
+        send_sc_update_message(*flow, *sc, batch);
 
     if (use_daq_channel && p && p->daq_msg)
         send_daq_update_message(*flow, *p);
@@ -633,9 +787,18 @@ void HighAvailability::process_update(Flow* flow, Packet* p)
     flow->ha_state->set_next_update();
 }
 
-static void send_sc_deletion_message(Flow& flow, SideChannel& sc)
+static void send_sc_deletion_message(Flow& flow, SideChannel& sc, HAMessageBatch* batch)
 {
     const uint32_t msg_len = calculate_msg_header_length(flow);
+
+    if (uint8_t* buf = batch ? batch->reserve(msg_len) : nullptr)
+    {
+        HAMessage ha_msg(buf, msg_len);
+        write_msg_header(flow, HA_DELETE_EVENT, msg_len, ha_msg);
+        batch->commit(msg_len);
+        return;
+    }
+
     SCMessage* sc_msg = sc.alloc_transmit_message(msg_len);
     HAMessage ha_msg(sc_msg->content, sc_msg->content_length);
 
@@ -654,7 +817,7 @@ void HighAvailability::process_deletion(Flow& flow)
 
     // Only produce deletion messages when using a side channel
     if (sc)
-        send_sc_deletion_message(flow, *sc);
+        send_sc_deletion_message(flow, *sc, batch);
 
     flow.ha_state->add(FlowHAState::DELETED);
 }
@@ -705,6 +868,7 @@ void HighAvailabilityManager::reset_config()
         delete ports;
         ports = nullptr;
     }
+    max_batch_size = 0;
 }
 
 void HighAvailabilityManager::term()
@@ -732,6 +896,8 @@ void HighAvailabilityManager::configure(HighAvailabilityConfig* config)
     FlowHAState::config_timers(config->min_session_lifetime, config->min_sync_interval);
 
     use_daq_channel = config->daq_channel;
+    max_batch_size = config->max_batch_size;
+    max_batch_latency = config->max_batch_latency;
 }
 
 // Called within the packet thread prior to packet processing
@@ -739,7 +905,7 @@ void HighAvailabilityManager::thread_init()
 {
     // create a a thread local instance iff we are configured to operate.
     if (ports || use_daq_channel)
-        ha = new HighAvailability(ports, use_daq_channel);
+        ha = new HighAvailability(ports, use_daq_channel, max_batch_size, max_batch_latency);
     else
         ha = nullptr;
 }
@@ -779,6 +945,12 @@ void HighAvailabilityManager::process_receive()
         ha->process_receive();
 }
 
+void HighAvailabilityManager::flush()
+{
+    if (ha)
+        ha->flush();
+}
+
 // Called in the packet threads to determine whether or not HA is active
 bool HighAvailabilityManager::active()
 {
@@ -159,6 +159,10 @@ public:
 
     // Look for and dispatch receive messages.
     static void process_receive();
+
+    // Send any batched messages.  Called at the end of each DAQ batch.
+    static void flush();
+
     static void set_modified(snort::Flow*);
     static bool in_standby(snort::Flow*);
 
@@ -171,6 +175,8 @@ private:
     HighAvailabilityManager() = delete;
     static bool use_daq_channel;
     static PortBitSet* ports;
+    static uint32_t max_batch_size;
+    static struct timeval max_batch_latency;
 };
 }
 
@@ -53,6 +53,12 @@ static const Parameter ha_params[] =
     { "min_sync", Parameter::PT_INT, "0:max32", "0",
       "minimum interval in milliseconds between HA updates" },
 
+    { "max_batch_size", Parameter::PT_INT, "0:65000", "0",
+      "maximum bytes of HA messages coalesced into one side channel message (0 = no batching)" },
+
+    { "max_batch_latency", Parameter::PT_INT, "0:max32", "0",
+      "maximum milliseconds a batched HA message waits to be sent (0 = until the end of the DAQ batch)" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -72,6 +78,8 @@ static const PegInfo ha_pegs[] =
     { CountType::SUM, "unknown_key_type", "messages received with an unknown flow key type" },
     { CountType::SUM, "unknown_client_idx", "messages received with an unknown client index" },
     { CountType::SUM, "client_consume_errors", "client data consume failure count" },
+    { CountType::SUM, "batched_msgs", "messages coalesced into batches" },
+    { CountType::SUM, "batches_sent", "side channel messages sent with batched messages" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -145,6 +153,14 @@ bool HighAvailabilityModule::set(const char*, Value& v, SnortConfig*)
     {
         convert_milliseconds_to_timeval(v.get_uint32(), &config->min_sync_interval);
     }
+    else if ( v.is("max_batch_size") )
+    {
+        config->max_batch_size = v.get_uint32();
+    }
+    else if ( v.is("max_batch_latency") )
+    {
+        convert_milliseconds_to_timeval(v.get_uint32(), &config->max_batch_latency);
+    }
 
     return true;
 }
@@ -38,6 +38,8 @@ struct HighAvailabilityConfig
     PortBitSet* ports = nullptr;
     struct timeval min_session_lifetime;
     struct timeval min_sync_interval;
+    struct timeval max_batch_latency = { };
+    uint32_t max_batch_size = 0;
 };
 
 class HighAvailabilityModule : public snort::Module
@@ -78,6 +80,8 @@ struct HAStats
     PegCount unknown_key_type;
     PegCount unknown_client_idx;
     PegCount client_consume_errors;
+    PegCount batched_msgs;
+    PegCount batches_sent;
 };
 
 extern THREAD_LOCAL HAStats ha_stats;
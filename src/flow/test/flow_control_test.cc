@@ -22,6 +22,8 @@
 #include "config.h"
 #endif
 
+#include <cstring>
+
 #include <daq_common.h>
 
 #include "flow/flow_control.h"
@@ -82,8 +84,8 @@ unsigned FlowCache::delete_flows(unsigned) { return 0; }
 unsigned FlowCache::timeout(unsigned, time_t) { return 1; }
 void Flow::init(PktType) { }
 void set_network_policy(const SnortConfig*, unsigned) { }
-void DataBus::publish(const char*, const uint8_t*, unsigned, Flow*) { }
-void DataBus::publish(const char*, Packet*, Flow*) { }
+void DataBus::publish(unsigned, const uint8_t*, unsigned, Flow*) { }
+void DataBus::publish(unsigned, Packet*, Flow*) { }
 const SnortConfig* SnortConfig::get_conf() { return nullptr; }
 void FlowCache::unlink_uni(Flow*) { }
 void Flow::set_client_initiate(Packet*) { }
@@ -170,6 +172,15 @@ int ExpectCache::add_flow(const Packet*,
 
 bool FlowCache::release(Flow*, PruneReason, bool) { return true; }
 
+// rows are the low port so tests can see which flow is prefetched next
+static unsigned s_prefetched_flow_row = 0;
+unsigned FlowCache::prefetch_row(const FlowKey* key) { return key->port_l; }
+void FlowCache::prefetch_node(unsigned) { }
+void FlowCache::prefetch_flow(unsigned row) { s_prefetched_flow_row = row; }
+
+bool FlowKey::is_equal(const void* k1, const void* k2, size_t)
+{ return !memcmp(k1, k2, sizeof(FlowKey)); }
+
 TEST_GROUP(stale_flow) { };
 
 TEST(stale_flow, stale_flow)
@@ -195,6 +206,99 @@ TEST(stale_flow, stale_flow)
     delete cache;
 }
 
+TEST_GROUP(flow_prefetch)
+{
+    FlowCacheConfig fcg;
+    FlowControl* flow_con = nullptr;
+    FlowKey keys[8];
+    Flow flow;
+
+    void setup() override
+    {
+        flow_con = new FlowControl(fcg);
+        memset(keys, 0, sizeof(keys));
+
+        for ( unsigned i = 0; i < 8; ++i )
+            keys[i].port_l = 100 + i;
+
+        s_prefetched_flow_row = 0;
+    }
+
+    void teardown() override
+    {
+        delete flow_con;
+    }
+
+    void check(unsigned i, const Flow* f)
+    { flow_con->check_prefetch(keys[i], f); }
+
+    unsigned next() const
+    { return flow_con->prefetch_next; }
+};
+
+TEST(flow_prefetch, hit)
+{
+    flow_con->prefetch(keys, 3);
+    CHECK(flow_con->get_prefetches() == 3);
+    CHECK(s_prefetched_flow_row == 100);
+
+    check(0, &flow);
+    CHECK(flow_con->get_prefetch_hits() == 1);
+    CHECK(next() == 1);
+    CHECK(s_prefetched_flow_row == 101);
+
+    check(1, &flow);
+    check(2, &flow);
+    CHECK(flow_con->get_prefetch_hits() == 3);
+    CHECK(next() == 3);
+}
+
+TEST(flow_prefetch, miss)
+{
+    flow_con->prefetch(keys, 3);
+
+    // a key that wasn't prefetched leaves the position alone
+    check(5, &flow);
+    CHECK(flow_con->get_prefetch_hits() == 0);
+    CHECK(next() == 0);
+
+    // a new flow matches the guess but isn't a hit
+    check(0, nullptr);
+    CHECK(flow_con->get_prefetch_hits() == 0);
+    CHECK(next() == 1);
+}
+
+TEST(flow_prefetch, skip)
+{
+    flow_con->prefetch(keys, 8);
+
+    // keys within the look ahead are matched past the ones skipped
+    check(2, &flow);
+    CHECK(flow_con->get_prefetch_hits() == 1);
+    CHECK(next() == 3);
+    CHECK(s_prefetched_flow_row == 103);
+
+    // skipped keys are behind and keys past the look ahead aren't matched
+    check(1, &flow);
+    check(7, &flow);
+    CHECK(flow_con->get_prefetch_hits() == 1);
+    CHECK(next() == 3);
+}
+
+TEST(flow_prefetch, reset)
+{
+    flow_con->prefetch(keys, 3);
+    check(0, &flow);
+    CHECK(flow_con->get_prefetch_hits() == 1);
+
+    // an empty batch drops the keys of the last one
+    flow_con->prefetch(keys, 0);
+    CHECK(next() == 0);
+    check(1, &flow);
+    CHECK(flow_con->get_prefetch_hits() == 1);
+    CHECK(flow_con->get_prefetches() == 3);
+}
+
 int main(int argc, char** argv)
 {
     return CommandLineTestRunner::RunAllTests(argc, argv);
@@ -0,0 +1,194 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// flow_key_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "flow/flow_key.h"
+#include "main/snort_config.h"
+#include "sfip/sf_ip.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+static SnortConfig my_config;
+static SnortConfig* conf = nullptr;
+
+SnortConfig::SnortConfig(const SnortConfig* const, const char*)
+{ run_flags = 0; }
+
+SnortConfig::~SnortConfig() = default;
+
+const SnortConfig* SnortConfig::get_conf()
+{ return conf; }
+
+SfIpRet SfIp::set(void const*, int) { return SFIP_SUCCESS; }
+
+#define NUM_ROWS 4096
+#define NUM_KEYS (16 * NUM_ROWS)
+
+static FlowKey make_key(uint32_t src, uint16_t sport)
+{
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    key.ip_l[2] = key.ip_h[2] = htonl(0xffff);
+    key.ip_l[3] = htonl(0x0a000000 | src);
+    key.ip_h[3] = htonl(0xc0a80101);
+    key.port_l = sport;
+    key.port_h = 443;
+    key.ip_protocol = 6;
+    key.pkt_type = PktType::TCP;
+    key.version = 4;
+    return key;
+}
+
+typedef unsigned (FlowHashKeyOps::*HashFn)(const unsigned char*);
+
+// sequential keys like a scan must spread evenly over the rows
+static unsigned max_row_load(FlowHashKeyOps& ops, HashFn fn)
+{
+    std::vector<unsigned> rows(NUM_ROWS);
+
+    for ( unsigned i = 0; i < NUM_KEYS; ++i )
+    {
+        FlowKey key = make_key(i >> 8, 1024 + (i & 0xff));
+        ++rows[(ops.*fn)((const unsigned char*)&key) & (NUM_ROWS - 1)];
+    }
+
+    unsigned max = 0;
+
+    for ( auto n : rows )
+        if ( n > max )
+            max = n;
+
+    return max;
+}
+
+// flipping any input bit should flip about half of the output bits
+static double avalanche(FlowHashKeyOps& ops, HashFn fn)
+{
+    std::mt19937 rng(1);
+    uint64_t flips = 0, trials = 0;
+
+    for ( unsigned i = 0; i < 256; ++i )
+    {
+        FlowKey key = make_key(rng(), rng());
+        unsigned h = (ops.*fn)((const unsigned char*)&key);
+
+        for ( unsigned bit = 0; bit < 8 * sizeof(key); ++bit )
+        {
+            FlowKey k = key;
+            ((uint8_t*)&k)[bit / 8] ^= 1 << (bit % 8);
+            flips += __builtin_popcount(h ^ (ops.*fn)((const unsigned char*)&k));
+            ++trials;
+        }
+    }
+    return (double)flips / trials;
+}
+
+TEST_GROUP(flow_key)
+{
+    void teardown() override
+    {
+        my_config.run_flags = 0;
+        conf = nullptr;
+    }
+};
+
+TEST(flow_key, is_equal)
+{
+    // keys are compared in place so test at an odd address
+    uint8_t buf1[sizeof(FlowKey) + 1];
+    uint8_t buf2[sizeof(FlowKey) + 1];
+
+    FlowKey key = make_key(1, 2);
+    memcpy(buf1 + 1, &key, sizeof(key));
+    memcpy(buf2 + 1, &key, sizeof(key));
+
+    CHECK(FlowKey::is_equal(buf1 + 1, buf2 + 1, sizeof(key)));
+
+    for ( unsigned i = 1; i <= sizeof(key); ++i )
+    {
+        buf2[i] ^= 0x80;
+        CHECK(!FlowKey::is_equal(buf1 + 1, buf2 + 1, sizeof(key)));
+        buf2[i] ^= 0x80;
+    }
+}
+
+TEST(flow_key, static_hash)
+{
+    my_config.run_flags |= RUN_FLAG__STATIC_HASH;
+    conf = &my_config;
+
+    FlowHashKeyOps ops1(NUM_ROWS);
+    FlowHashKeyOps ops2(NUM_ROWS);
+    CHECK(!ops1.using_crc());
+
+    FlowKey key = make_key(1, 2);
+    CHECK(ops1.do_hash((const unsigned char*)&key, sizeof(key)) ==
+        ops2.do_hash((const unsigned char*)&key, sizeof(key)));
+    CHECK(ops1.do_hash((const unsigned char*)&key, sizeof(key)) ==
+        ops1.mix_hash((const unsigned char*)&key));
+}
+
+TEST(flow_key, do_hash)
+{
+    FlowHashKeyOps ops(NUM_ROWS);
+    FlowKey key = make_key(1, 2);
+
+    unsigned h = ops.do_hash((const unsigned char*)&key, sizeof(key));
+
+    if ( ops.using_crc() )
+        CHECK(h == ops.crc_hash((const unsigned char*)&key));
+    else
+        CHECK(h == ops.mix_hash((const unsigned char*)&key));
+
+    // unaligned keys hash the same
+    uint8_t buf[sizeof(FlowKey) + 1];
+    memcpy(buf + 1, &key, sizeof(key));
+    CHECK(h == ops.do_hash(buf + 1, sizeof(key)));
+}
+
+TEST(flow_key, distribution)
+{
+    FlowHashKeyOps ops(NUM_ROWS);
+
+    // the mean is 16 per row
+    CHECK(max_row_load(ops, &FlowHashKeyOps::mix_hash) < 48);
+    CHECK(max_row_load(ops, &FlowHashKeyOps::crc_hash) < 48);
+
+    double m = avalanche(ops, &FlowHashKeyOps::mix_hash);
+    CHECK(m > 15.0 and m < 17.0);
+
+    double c = avalanche(ops, &FlowHashKeyOps::crc_hash);
+    CHECK(c > 15.0 and c < 17.0);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
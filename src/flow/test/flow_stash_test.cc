@@ -22,6 +22,7 @@
 #include "config.h"
 #endif
 
+#include <map>
 #include <string>
 
 #include "flow/flow_stash.h"
@@ -73,23 +74,32 @@ const char* DBConsumer<Type>::STASH_EVENT = "foo.stash.event";
 
 // DataBus mock: most functions are stubs, but _subscribe() and  _publish()
 // are (close to) real.
+static std::map<std::string, unsigned> event_ids;
+
 DataBus::DataBus() = default;
 
 DataBus::~DataBus()
 {
-    for ( auto& p : map )
-        for ( auto* h : p.second )
+    for ( auto& v : lists )
+        for ( auto* h : v )
             delete h;
 }
 
 void DataBus::clone(DataBus&, const char*) {}
+
+unsigned DataBus::get_id(const char* key)
+{
+    auto res = event_ids.emplace(key, event_ids.size());
+    return res.first->second;
+}
+
 void DataBus::subscribe(const char* key, DataHandler* h)
 {
-    DB->_subscribe(key, h);
+    DB->_subscribe(get_id(key), h);
 }
 void DataBus::subscribe_network(const char* key, DataHandler* h)
 {
-    DB->_subscribe(key, h);
+    DB->_subscribe(get_id(key), h);
 }
 
 void DataBus::unsubscribe(const char*, DataHandler*) {}
@@ -97,29 +107,29 @@ void DataBus::unsubscribe_network(const char*, DataHandler*) {}
 
 void DataBus::publish(const char* key, DataEvent& e, Flow* f)
 {
-    DB->_publish(key, e, f);
+    DB->_publish(get_id(key), e, f);
 }
 
 void DataBus::publish(const char*, const uint8_t*, unsigned, Flow*) {}
 void DataBus::publish(const char*, Packet*, Flow*) {}
 
-void DataBus::_subscribe(const char* key, DataHandler* h)
+void DataBus::_subscribe(unsigned id, DataHandler* h)
 {
-    DataList& v = map[key];
-    v.emplace_back(h);
+    if ( id >= lists.size() )
+        lists.resize(id + 1);
+
+    lists[id].emplace_back(h);
 }
 
-void DataBus::_unsubscribe(const char*, DataHandler*) {}
+void DataBus::_unsubscribe(unsigned, DataHandler*) {}
 
-void DataBus::_publish(const char* key, DataEvent& e, Flow* f)
+void DataBus::_publish(unsigned id, DataEvent& e, Flow* f)
 {
-    auto v = map.find(key);
+    if ( id >= lists.size() )
+        return;
 
-    if ( v != map.end() )
-    {
-        for ( auto* h : v->second )
-            h->handle(e, f);
-    }
+    for ( auto* h : lists[id] )
+        h->handle(e, f);
 }
 // end DataBus mock.
 
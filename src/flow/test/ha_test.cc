@@ -30,7 +30,7 @@
 
 using namespace snort;
 
-#define MSG_SIZE 100
+#define MSG_SIZE 200
 #define TEST_KEY 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47
 
 class StreamHAClient;
@@ -103,6 +103,7 @@ static bool s_delete_session_called = false;
 static bool s_transmit_message_called = false;
 static bool s_stream_update_required = false;
 static bool s_other_update_required = false;
+static bool s_other_produce_fails = false;
 static uint8_t* s_message_content = nullptr;
 static uint8_t s_message_length = 0;
 static Flow s_flow;
@@ -169,7 +170,7 @@ public:
     }
     bool produce(Flow&, HAMessage& msg) override
     {
-        if (!msg.fits(5))
+        if (s_other_produce_fails or !msg.fits(5))
             return false;
 
         for ( uint8_t i = 0; i < 5; i++ )
@@ -431,6 +432,52 @@ TEST(high_availability_test, receive_update_stream_only)
     CHECK(memcmp((const void*)&s_flowkey, (const void*)&s_test_key, sizeof(s_test_key)) == 0);
 }
 
+TEST(high_availability_test, receive_batch)
+{
+    struct __attribute__((__packed__))
+    {
+        HAMessageHeader bhdr;
+        TestDeleteMessage del;
+        TestUpdateMessage upd;
+    } batch =
+    {
+        { HA_BATCH_EVENT, HA_MESSAGE_VERSION, 0, 0 },
+        s_delete_message, s_update_stream_message
+    };
+    batch.bhdr.total_length = sizeof(batch);
+
+    s_delete_session_called = false;
+    s_stream_consume_called = false;
+    s_message_content = (uint8_t*) &batch;
+    s_message_length = sizeof(batch);
+    HighAvailabilityManager::process_receive();
+    CHECK(s_delete_session_called == true);
+    CHECK(s_stream_consume_called == true);
+    CHECK(ha_stats.msgs_recv == 2);
+    CHECK(ha_stats.delete_msgs_consumed == 1);
+    CHECK(ha_stats.update_msgs_consumed == 1);
+}
+
+TEST(high_availability_test, receive_unbatched_not_split)
+{
+    // without a batch header, messages back to back are one bad message
+    struct __attribute__((__packed__))
+    {
+        TestDeleteMessage del;
+        TestUpdateMessage upd;
+    } msgs = { s_delete_message, s_update_stream_message };
+
+    s_delete_session_called = false;
+    s_stream_consume_called = false;
+    s_message_content = (uint8_t*) &msgs;
+    s_message_length = sizeof(msgs);
+    HighAvailabilityManager::process_receive();
+    CHECK(s_delete_session_called == false);
+    CHECK(s_stream_consume_called == false);
+    CHECK(ha_stats.msgs_recv == 1);
+    CHECK(ha_stats.msg_length_mismatch == 1);
+}
+
 TEST(high_availability_test, transmit_deletion)
 {
     s_transmit_message_called = false;
@@ -470,6 +517,102 @@ TEST(high_availability_test, transmit_update_both_update)
     CHECK(s_transmit_message_called == true);
 }
 
+TEST(high_availability_test, transmit_update_produce_fails)
+{
+    // the message is sized for both clients but only the stream client writes
+    memset(s_message, 0xff, sizeof(s_message));
+    s_transmit_message_called = false;
+    s_stream_update_required = true;
+    s_other_update_required = true;
+    s_other_produce_fails = true;
+    s_pkt.active = &active;
+    s_flow.ha_state->set_pending(s_other_ha_client->handle);
+    HighAvailabilityManager::process_update(&s_flow, &s_pkt);
+    s_other_produce_fails = false;
+    CHECK(s_transmit_message_called == true);
+
+    const HAMessageHeader* hdr = (const HAMessageHeader*) s_message_content;
+    CHECK(hdr->total_length < s_message_length);
+
+    // the unwritten tail is not parsed as another message
+    s_stream_consume_called = false;
+    HighAvailabilityManager::process_receive();
+    CHECK(ha_stats.msgs_recv == 1);
+    CHECK(ha_stats.msg_length_mismatch == 1);
+    CHECK(ha_stats.update_msgs_consumed == 0);
+    CHECK(s_stream_consume_called == false);
+}
+
+TEST_GROUP(high_availability_batch_test)
+{
+    void setup() override
+    {
+        memset(&ha_stats, 0, sizeof(ha_stats));
+
+        HighAvailabilityConfig hac;
+        hac.enabled = true;
+        hac.daq_channel = false;
+        hac.ports = new PortBitSet();
+        hac.ports->set(1);
+        hac.min_session_lifetime = { 1, 0 };
+        hac.min_sync_interval = { 0, 500000 };
+        hac.max_batch_size = MSG_SIZE - sizeof(HAMessageHeader);
+
+        HighAvailabilityManager::configure(&hac);
+        HighAvailabilityManager::thread_init();
+        s_ha_client = new StreamHAClient;
+    }
+
+    void teardown() override
+    {
+        delete s_ha_client;
+        HighAvailabilityManager::thread_term();
+        HighAvailabilityManager::term();
+    }
+};
+
+TEST(high_availability_batch_test, transmit_deletions)
+{
+    Flow flow;
+    *const_cast<FlowKey*>(flow.key) = s_test_key;
+    flow.ha_state->clear(FlowHAState::NEW);
+
+    s_transmit_message_called = false;
+    HighAvailabilityManager::process_deletion(flow);
+    flow.ha_state->clear(FlowHAState::DELETED);
+    HighAvailabilityManager::process_deletion(flow);
+    CHECK(s_transmit_message_called == false);
+    CHECK(ha_stats.batched_msgs == 2);
+
+    HighAvailabilityManager::flush();
+    CHECK(s_transmit_message_called == true);
+    CHECK(ha_stats.batches_sent == 1);
+    CHECK(s_message_length == sizeof(HAMessageHeader) + 2 * calculate_msg_header_length(flow));
+
+    // the partner splits the batch back into messages
+    HighAvailabilityManager::process_receive();
+    CHECK(ha_stats.delete_msgs_consumed == 2);
+}
+
+TEST(high_availability_batch_test, transmit_when_full)
+{
+    Flow flow;
+    *const_cast<FlowKey*>(flow.key) = s_test_key;
+    flow.ha_state->clear(FlowHAState::NEW);
+
+    s_transmit_message_called = false;
+
+    // the fourth message doesn't fit so the first three are sent
+    for ( int i = 0; i < 4; i++ )
+    {
+        flow.ha_state->clear(FlowHAState::DELETED);
+        HighAvailabilityManager::process_deletion(flow);
+    }
+    CHECK(s_transmit_message_called == true);
+    CHECK(ha_stats.batches_sent == 1);
+    CHECK(s_message_length == sizeof(HAMessageHeader) + 3 * calculate_msg_header_length(flow));
+}
+
 TEST(high_availability_test, read_flow_key_error_v4)
 {
     HAMessageHeader hdr = { 0, 0, 0, KEY_TYPE_IP4 };
@@ -22,15 +22,121 @@
 #endif
 
 #include <algorithm>
+#include <cstring>
+#include <mutex>
 
 #include "data_bus.h"
 
 #include "main/policy.h"
 #include "main/snort_config.h"
+#include "main/thread.h"
 #include "protocols/packet.h"
+#include "pub_sub/daq_message_event.h"
+#include "pub_sub/finalize_packet_event.h"
 
 using namespace snort;
 
+//--------------------------------------------------------------------------
+// event ids
+//--------------------------------------------------------------------------
+
+// must be in DataBusCoreId order
+static const char* const core_keys[] =
+{
+    PACKET_EVENT,
+    FLOW_STATE_EVENT,
+    THREAD_IDLE_EVENT,
+    THREAD_ROTATE_EVENT,
+    DETAINED_PACKET_EVENT,
+    FLOW_SERVICE_CHANGE_EVENT,
+    SERVICE_INSPECTOR_CHANGE_EVENT,
+    SSL_SEARCH_ABANDONED,
+    FLOW_STATE_SETUP_EVENT,
+    STREAM_ICMP_NEW_FLOW_EVENT,
+    STREAM_IP_NEW_FLOW_EVENT,
+    STREAM_UDP_NEW_FLOW_EVENT,
+    STREAM_ICMP_BIDIRECTIONAL_EVENT,
+    STREAM_IP_BIDIRECTIONAL_EVENT,
+    STREAM_UDP_BIDIRECTIONAL_EVENT,
+    STREAM_TCP_SYN_EVENT,
+    STREAM_TCP_SYN_ACK_EVENT,
+    STREAM_TCP_MIDSTREAM_EVENT,
+    STREAM_HA_NEW_FLOW_EVENT,
+    FINALIZE_PACKET_EVENT,
+    DAQ_SOF_MSG_EVENT,
+    DAQ_EOF_MSG_EVENT,
+    DAQ_OTHER_MSG_EVENT,
+    PKT_WITHOUT_FLOW_EVENT,
+};
+
+static_assert(sizeof(core_keys)/sizeof(core_keys[0]) == DATA_BUS_CORE_IDS,
+    "core_keys doesn't match DataBusCoreId");
+
+// keys are only added and ids never change.  new keys may be added while
+// packet threads publish (eg during reload) so the table is locked, but
+// each thread caches the ids it has seen so the lock is only taken the
+// first time a thread publishes a given key.
+struct EventIds
+{
+    EventIds()
+    {
+        for ( unsigned i = 0; i < DATA_BUS_CORE_IDS; ++i )
+            ids[core_keys[i]] = i;
+    }
+
+    std::mutex mutex;
+    std::unordered_map<std::string, unsigned> ids;
+};
+
+static EventIds& get_event_ids()
+{
+    static EventIds event_ids;
+    return event_ids;
+}
+
+// the cache keys point to the strings in EventIds, which are never freed
+struct KeyHash
+{
+    size_t operator()(const char* s) const
+    {
+        size_t h = 0;
+
+        while ( *s )
+            h = h * 31 + (uint8_t)*s++;
+
+        return h;
+    }
+};
+
+struct KeyEqual
+{
+    bool operator()(const char* a, const char* b) const
+    { return !strcmp(a, b); }
+};
+
+typedef std::unordered_map<const char*, unsigned, KeyHash, KeyEqual> IdCache;
+static THREAD_LOCAL IdCache* id_cache = nullptr;
+
+// unknown keys get an id too; they just have no subscribers yet
+static unsigned find_id(const char* key)
+{
+    if ( !id_cache )
+        id_cache = new IdCache;
+
+    auto it = id_cache->find(key);
+
+    if ( it != id_cache->end() )
+        return it->second;
+
+    EventIds& ei = get_event_ids();
+    std::lock_guard<std::mutex> lock(ei.mutex);
+
+    auto res = ei.ids.emplace(key, ei.ids.size());
+    id_cache->emplace(res.first->first.c_str(), res.first->second);
+
+    return res.first->second;
+}
+
 static DataBus& get_data_bus()
 { return get_inspection_policy()->dbus; }
 static DataBus& get_network_data_bus()
@@ -71,8 +177,8 @@ DataBus::DataBus() = default;
 
 DataBus::~DataBus()
 {
-    for ( auto& p : map )
-        for ( auto* h : p.second )
+    for ( auto& v : lists )
+        for ( auto* h : v )
         {
             // If the object is cloned, pass the ownership to the next config.
             // When the object is no further cloned (e.g., the last config), delete it.
@@ -85,60 +191,94 @@ DataBus::~DataBus()
 
 void DataBus::clone(DataBus& from, const char* exclude_name)
 {
-    for ( auto& p : from.map )
-        for ( auto* h : p.second )
+    for ( unsigned id = 0; id < from.lists.size(); ++id )
+        for ( auto* h : from.lists[id] )
             if ( nullptr == exclude_name || 0 != strcmp(exclude_name, h->module_name) )
             {
                 h->cloned = true;
-                _subscribe(p.first.c_str(), h);
+                _subscribe(id, h);
             }
 }
 
+unsigned DataBus::get_id(const char* key)
+{ return find_id(key); }
+
+void DataBus::thread_term()
+{
+    delete id_cache;
+    id_cache = nullptr;
+}
+
 // add handler to list of handlers to be notified upon
 // publication of given event
 void DataBus::subscribe(const char* key, DataHandler* h)
 {
-    get_data_bus()._subscribe(key, h);
+    get_data_bus()._subscribe(get_id(key), h);
 }
 
 // for subscribers that need to receive events regardless of active inspection policy
 void DataBus::subscribe_network(const char* key, DataHandler* h)
 {
-    get_network_data_bus()._subscribe(key, h);
+    get_network_data_bus()._subscribe(get_id(key), h);
+}
+
+void DataBus::subscribe(unsigned id, DataHandler* h)
+{
+    get_data_bus()._subscribe(id, h);
+}
+
+void DataBus::subscribe_network(unsigned id, DataHandler* h)
+{
+    get_network_data_bus()._subscribe(id, h);
 }
 
 void DataBus::unsubscribe(const char* key, DataHandler* h)
 {
-    get_data_bus()._unsubscribe(key, h);
+    get_data_bus()._unsubscribe(find_id(key), h);
 }
 
 void DataBus::unsubscribe_network(const char* key, DataHandler* h)
 {
-    get_network_data_bus()._unsubscribe(key, h);
+    get_network_data_bus()._unsubscribe(find_id(key), h);
 }
 
 // notify subscribers of event
-void DataBus::publish(const char* key, DataEvent& e, Flow* f)
+void DataBus::publish(unsigned id, DataEvent& e, Flow* f)
 {
     NetworkPolicy* ni = get_network_policy();
-    ni->dbus._publish(key, e, f);
+    ni->dbus._publish(id, e, f);
 
     InspectionPolicy* pi = get_inspection_policy();
-    pi->dbus._publish(key, e, f);
+    pi->dbus._publish(id, e, f);
 }
 
-void DataBus::publish(const char* key, const uint8_t* buf, unsigned len, Flow* f)
+void DataBus::publish(unsigned id, const uint8_t* buf, unsigned len, Flow* f)
 {
     BufferEvent e(buf, len);
-    publish(key, e, f);
+    publish(id, e, f);
 }
 
-void DataBus::publish(const char* key, Packet* p, Flow* f)
+void DataBus::publish(unsigned id, Packet* p, Flow* f)
 {
     PacketEvent e(p);
     if ( p && !f )
         f = p->flow;
-    publish(key, e, f);
+    publish(id, e, f);
+}
+
+void DataBus::publish(const char* key, DataEvent& e, Flow* f)
+{
+    publish(find_id(key), e, f);
+}
+
+void DataBus::publish(const char* key, const uint8_t* buf, unsigned len, Flow* f)
+{
+    publish(find_id(key), buf, len, f);
+}
+
+void DataBus::publish(const char* key, Packet* p, Flow* f)
+{
+    publish(find_id(key), p, f);
 }
 
 //--------------------------------------------------------------------------
@@ -156,34 +296,35 @@ static bool compare(DataHandler* a, DataHandler* b)
     return false;
 }
 
-void DataBus::_subscribe(const char* key, DataHandler* h)
+void DataBus::_subscribe(unsigned id, DataHandler* h)
 {
-    DataList& v = map[key];
+    if ( id >= lists.size() )
+        lists.resize(id + 1);
+
+    DataList& v = lists[id];
     v.emplace_back(h);
     std::sort(v.begin(), v.end(), compare);
 }
 
-void DataBus::_unsubscribe(const char* key, DataHandler* h)
+void DataBus::_unsubscribe(unsigned id, DataHandler* h)
 {
-    DataList& v = map[key];
+    if ( id >= lists.size() )
+        return;
+
+    DataList& v = lists[id];
 
     for ( unsigned i = 0; i < v.size(); i++ )
         if ( v[i] == h )
             v.erase(v.begin() + i--);
-
-    if ( v.empty() )
-        map.erase(key);
 }
 
 // notify subscribers of event
-void DataBus::_publish(const char* key, DataEvent& e, Flow* f)
+void DataBus::_publish(unsigned id, DataEvent& e, Flow* f)
 {
-    auto v = map.find(key);
+    if ( id >= lists.size() )
+        return;
 
-    if ( v != map.end() )
-    {
-        for ( auto* h : v->second )
-            h->handle(e, f);
-    }
+    for ( auto* h : lists[id] )
+        h->handle(e, f);
 }
 
@@ -85,9 +85,7 @@ protected:
     DataHandler(const char* mod_name) : module_name(mod_name), cloned(false) { }
 };
 
-// FIXIT-P evaluate perf; focus is on correctness
 typedef std::vector<DataHandler*> DataList;
-typedef std::unordered_map<std::string, DataList> DataMap;
 
 class SO_PUBLIC DataBus
 {
@@ -98,28 +96,44 @@ public:
     // configure time methods - main thread only
     void clone(DataBus& from, const char* exclude_name = nullptr);
 
+    // get the id of the given event key, registering it if new.  ids are
+    // stable for the life of the process.  publishers should get their ids
+    // here at init or configure time and publish by id at runtime.
+    static unsigned get_id(const char* key);
+
     // FIXIT-L ideally these would not be static or would take an inspection policy*
     static void subscribe(const char* key, DataHandler*);
     static void subscribe_network(const char* key, DataHandler*);
 
+    static void subscribe(unsigned id, DataHandler*);
+    static void subscribe_network(unsigned id, DataHandler*);
+
     // FIXIT-L these should be called during cleanup
     static void unsubscribe(const char* key, DataHandler*);
     static void unsubscribe_network(const char* key, DataHandler*);
 
+    // packet thread cleanup
+    static void thread_term();
+
     // runtime methods
-    static void publish(const char* key, DataEvent&, Flow* = nullptr);
+    static void publish(unsigned id, DataEvent&, Flow* = nullptr);
 
     // convenience methods
+    static void publish(unsigned id, const uint8_t*, unsigned, Flow* = nullptr);
+    static void publish(unsigned id, Packet*, Flow* = nullptr);
+
+    // compatibility methods; these look up the key in a per thread cache
+    static void publish(const char* key, DataEvent&, Flow* = nullptr);
     static void publish(const char* key, const uint8_t*, unsigned, Flow* = nullptr);
     static void publish(const char* key, Packet*, Flow* = nullptr);
 
 private:
-    void _subscribe(const char* key, DataHandler*);
-    void _unsubscribe(const char* key, DataHandler*);
-    void _publish(const char* key, DataEvent&, Flow*);
+    void _subscribe(unsigned id, DataHandler*);
+    void _unsubscribe(unsigned id, DataHandler*);
+    void _publish(unsigned id, DataEvent&, Flow*);
 
 private:
-    DataMap map;
+    std::vector<DataList> lists;  // indexed by event id
 };
 }
 
@@ -163,5 +177,39 @@ private:
 // A new standby flow was generated by stream high availability
 #define STREAM_HA_NEW_FLOW_EVENT "stream.ha.new_flow"
 
+// Ids of the above and other events published by the framework for most
+// packets or messages.  These are preassigned so they need no lookup.
+enum DataBusCoreId : unsigned
+{
+    PACKET_EVENT_ID,
+    FLOW_STATE_EVENT_ID,
+    THREAD_IDLE_EVENT_ID,
+    THREAD_ROTATE_EVENT_ID,
+    DETAINED_PACKET_EVENT_ID,
+    FLOW_SERVICE_CHANGE_EVENT_ID,
+    SERVICE_INSPECTOR_CHANGE_EVENT_ID,
+    SSL_SEARCH_ABANDONED_ID,
+    FLOW_STATE_SETUP_EVENT_ID,
+    STREAM_ICMP_NEW_FLOW_EVENT_ID,
+    STREAM_IP_NEW_FLOW_EVENT_ID,
+    STREAM_UDP_NEW_FLOW_EVENT_ID,
+    STREAM_ICMP_BIDIRECTIONAL_EVENT_ID,
+    STREAM_IP_BIDIRECTIONAL_EVENT_ID,
+    STREAM_UDP_BIDIRECTIONAL_EVENT_ID,
+    STREAM_TCP_SYN_EVENT_ID,
+    STREAM_TCP_SYN_ACK_EVENT_ID,
+    STREAM_TCP_MIDSTREAM_EVENT_ID,
+    STREAM_HA_NEW_FLOW_EVENT_ID,
+    FINALIZE_PACKET_EVENT_ID,     // pub_sub/finalize_packet_event.h
+    DAQ_SOF_MSG_EVENT_ID,         // pub_sub/daq_message_event.h
+    DAQ_EOF_MSG_EVENT_ID,
+    DAQ_OTHER_MSG_EVENT_ID,
+    PKT_WITHOUT_FLOW_EVENT_ID,    // protocols/packet.h
+    DATA_BUS_CORE_IDS,
+
+    // initial value for ids obtained at init time; it has no subscribers
+    DATA_BUS_INVALID_ID = ~0u
+};
+
 #endif
 
@@ -235,6 +235,98 @@ TEST(data_bus, order2)
     delete h9;
 }
 
+TEST(data_bus, ids)
+{
+    CHECK(PACKET_EVENT_ID == DataBus::get_id(PACKET_EVENT));
+    CHECK(FINALIZE_PACKET_EVENT_ID == DataBus::get_id("analyzer.finalize.packet"));
+    CHECK(PKT_WITHOUT_FLOW_EVENT_ID == DataBus::get_id("non_flow_pkt"));
+
+    unsigned id = DataBus::get_id(DB_UTEST_EVENT);
+    CHECK(id >= DATA_BUS_CORE_IDS);
+    CHECK(id == DataBus::get_id(DB_UTEST_EVENT));
+    CHECK(id != DataBus::get_id("unit.test.other"));
+}
+
+TEST(data_bus, publish_id)
+{
+    unsigned id = DataBus::get_id(DB_UTEST_EVENT);
+
+    UTestHandler* h = new UTestHandler();
+    DataBus::subscribe(id, h);
+
+    UTestEvent event(100);
+    DataBus::publish(id, event);
+    CHECK(100 == h->evt_msg);
+
+    // the key and the id are interchangeable
+    UTestEvent event1(200);
+    DataBus::publish(DB_UTEST_EVENT, event1);
+    CHECK(200 == h->evt_msg);
+
+    UTestEvent event2(300);
+    DataBus::publish(DataBus::get_id("unit.test.other"), event2);
+    CHECK(200 == h->evt_msg);
+
+    // keys without subscribers are ignored
+    DataBus::publish("unit.test.unknown", event2);
+    CHECK(200 == h->evt_msg);
+
+    DataBus::unsubscribe(DB_UTEST_EVENT, h);
+
+    DataBus::publish(id, event2);
+    CHECK(200 == h->evt_msg); // unsubscribed!
+
+    delete h;
+}
+
+TEST(data_bus, publish_before_subscribe)
+{
+    // the id cached by the first publish is the one used to subscribe
+    UTestEvent event(100);
+    DataBus::publish("unit.test.late", event);
+
+    UTestHandler* h = new UTestHandler();
+    DataBus::subscribe("unit.test.late", h);
+
+    DataBus::publish("unit.test.late", event);
+    CHECK(100 == h->evt_msg);
+
+    DataBus::thread_term();
+
+    UTestEvent event1(200);
+    DataBus::publish("unit.test.late", event1);
+    CHECK(200 == h->evt_msg);
+
+    DataBus::unsubscribe("unit.test.late", h);
+    delete h;
+}
+
+TEST(data_bus, publish_invalid_id)
+{
+    UTestHandler* h = new UTestHandler();
+    DataBus::subscribe_network(PACKET_EVENT, h);
+
+    UTestEvent event(100);
+    DataBus::publish(DATA_BUS_INVALID_ID, event);
+    CHECK(0 == h->evt_msg);
+
+    DataBus::unsubscribe_network(PACKET_EVENT, h);
+    delete h;
+}
+
+TEST(data_bus, publish_core_id)
+{
+    UTestHandler* h = new UTestHandler();
+    DataBus::subscribe_network(THREAD_IDLE_EVENT, h);
+
+    UTestEvent event(100);
+    DataBus::publish(THREAD_IDLE_EVENT_ID, event);
+    CHECK(100 == h->evt_msg);
+
+    DataBus::unsubscribe_network(THREAD_IDLE_EVENT, h);
+    delete h;
+}
+
 //-------------------------------------------------------------------------
 // main
 //-------------------------------------------------------------------------
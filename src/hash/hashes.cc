@@ -36,6 +36,26 @@ void sha256(const unsigned char* data, size_t size, unsigned char* digest)
     SHA256_Final(digest, &c);
 }
 
+static_assert(sizeof(SHA256_CTX) <= sizeof(Sha256), "Sha256 too small for SHA256_CTX");
+
+Sha256::Sha256()
+{ reset(); }
+
+void Sha256::reset()
+{ SHA256_Init((SHA256_CTX*)ctx); }
+
+void Sha256::update(const void* data, size_t size)
+{ SHA256_Update((SHA256_CTX*)ctx, data, size); }
+
+void Sha256::digest(unsigned char* out) const
+{
+    SHA256_CTX c = *(const SHA256_CTX*)ctx;
+    SHA256_Final(out, &c);
+}
+
+void Sha256::final(unsigned char* out)
+{ SHA256_Final(out, (SHA256_CTX*)ctx); }
+
 void sha512(const unsigned char* data, size_t size, unsigned char* digest)
 {
     SHA512_CTX c;
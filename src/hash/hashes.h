@@ -20,6 +20,8 @@
 #ifndef HASHES_H
 #define HASHES_H
 
+#include <cstdint>
+
 #include "main/snort_types.h"
 
 namespace snort
@@ -33,6 +35,27 @@ namespace snort
 SO_PUBLIC void md5(const unsigned char* data, size_t size, unsigned char* digest);
 SO_PUBLIC void sha256(const unsigned char* data, size_t size, unsigned char* digest);
 SO_PUBLIC void sha512(const unsigned char* data, size_t size, unsigned char* digest);
+
+// streaming sha256 for data that arrives in segments.  libcrypto selects
+// the SHA-NI / AVX2 block function for the cpu at startup so this just
+// keeps the running state inline and allows a digest mid stream.
+class SO_PUBLIC Sha256
+{
+public:
+    Sha256();
+
+    void reset();
+    void update(const void* data, size_t size);
+
+    // digest of the data so far; more may be added after
+    void digest(unsigned char*) const;
+
+    // digest of all the data; call reset before reuse
+    void final(unsigned char*);
+
+private:
+    alignas(8) uint8_t ctx[112];  // SHA256_CTX
+};
 }
 #endif
 
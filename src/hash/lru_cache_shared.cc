@@ -33,5 +33,6 @@ const PegInfo lru_cache_shared_peg_names[] =
     { CountType::SUM, "reload_prunes", "lru cache pruned entry for lower memcap during reload" },
     { CountType::SUM, "removes", "lru cache found entry and removed it" },
     { CountType::SUM, "replaced", "lru cache found entry and replaced it" },
+    { CountType::SUM, "lock_contentions", "lru cache waited for another thread to release a shard" },
     { CountType::END, nullptr, nullptr },
 };
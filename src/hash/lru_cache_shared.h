@@ -23,9 +23,17 @@
 
 // LruCacheShared -- Implements a thread-safe unordered map where the
 // least-recently-used (LRU) entries are removed once a fixed size is hit.
+//
+// The cache may be split into shards, each with its own lock, list and map.
+// Keys are assigned to shards by hash so lookups of different keys from
+// different threads rarely contend. LRU order is kept per shard; pruning
+// starts with the shard being updated and moves on to the others, so with
+// more than one shard the oldest entry overall is not necessarily the first
+// to go. With a single shard (the default) behavior is strict LRU.
 
 #include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -46,6 +54,7 @@ struct LruCacheSharedStats
     PegCount reload_prunes = 0; // when an old entry is removed due to lower memcap during reload
     PegCount removes = 0;       // found entry and removed it
     PegCount replaced = 0;      // found entry and replaced it
+    PegCount lock_contentions = 0; // had to wait for another thread to release a shard
 };
 
 enum class LcsInsertStatus {
@@ -54,6 +63,8 @@ enum class LcsInsertStatus {
     LCS_ITEM_REPLACED
 };
 
+#define LRU_CACHE_MAX_SHARDS 256
+
 template<typename Key, typename Value, typename Hash, typename Eq = std::equal_to<Key>,
     typename Purgatory = std::vector<std::shared_ptr<Value>>>
 class LruCacheShared
@@ -67,8 +78,9 @@ public:
     LruCacheShared(const LruCacheShared& arg) = delete;
     LruCacheShared& operator=(const LruCacheShared& arg) = delete;
 
-    LruCacheShared(const size_t initial_size) :
-        max_size(initial_size), current_size(0) { }
+    LruCacheShared(const size_t initial_size, unsigned num_shards = 1) :
+        max_size(initial_size), current_size(0)
+    { make_shards(num_shards); }
 
     virtual ~LruCacheShared() = default;
 
@@ -92,19 +104,25 @@ public:
     Data find_else_insert(const Key&, Data&, LcsInsertStatus*, bool = false);
 
     // Return all data from the LruCache in order (most recently used to least)
+    // shard by shard.
     std::vector<std::pair<Key, Data> > get_all_data();
 
     //  Get current number of elements in the LruCache.
     size_t size()
     {
-        std::lock_guard<std::mutex> cache_lock(cache_mutex);
-        return list.size();
+        size_t n = 0;
+
+        for ( auto& shard : shards )
+        {
+            std::lock_guard<std::mutex> cache_lock(shard.cache_mutex);
+            n += shard.list.size();
+        }
+        return n;
     }
 
     virtual size_t mem_size()
     {
-        std::lock_guard<std::mutex> cache_lock(cache_mutex);
-        return list.size() * mem_chunk;
+        return size() * mem_chunk;
     }
 
     size_t get_max_size()
@@ -116,6 +134,13 @@ public:
     //  the oldest entries are removed. This pruning doesn't utilize reload resource tuner.
     bool set_max_size(size_t newsize);
 
+    unsigned get_shards() const
+    { return shards.size(); }
+
+    //  Change the number of shards. Only allowed while the cache is empty,
+    //  i.e. at startup before any packet thread can use it.
+    bool set_shards(unsigned num_shards);
+
     //  Remove entry associated with Key.
     //  Returns true if entry existed, false otherwise.
     virtual bool remove(const Key& key);
@@ -128,14 +153,39 @@ public:
     const PegInfo* get_pegs() const
     { return lru_cache_shared_peg_names; }
 
+    // Shard stats are summed on each call, each under its shard's lock, so
+    // don't call this with lock() held. The sum is valid until the next call.
     PegCount* get_counts()
-    { return (PegCount*)&stats; }
+    {
+        constexpr unsigned n = sizeof(LruCacheSharedStats) / sizeof(PegCount);
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        PegCount* sum = (PegCount*)&stats;
+        stats = { };
 
+        for ( auto& shard : shards )
+        {
+            std::lock_guard<std::mutex> cache_lock(shard.cache_mutex);
+            const PegCount* pc = (const PegCount*)&shard.stats;
+
+            for ( unsigned i = 0; i < n; ++i )
+                sum[i] += pc[i];
+        }
+        return sum;
+    }
+
+    // Lock or unlock all shards. Shards are always locked in index order and
+    // single shard operations only try_lock other shards so this can't deadlock.
     void lock()
-    { cache_mutex.lock(); }
+    {
+        for ( auto& shard : shards )
+            shard.cache_mutex.lock();
+    }
 
     void unlock()
-    { cache_mutex.unlock(); }
+    {
+        for ( auto it = shards.rbegin(); it != shards.rend(); ++it )
+            it->cache_mutex.unlock();
+    }
 
 protected:
     using LruList = std::list<std::pair<Key, Data>>;
@@ -143,6 +193,16 @@ protected:
     using LruMap = std::unordered_map<Key, LruListIter, Hash, Eq>;
     using LruMapIter = typename LruMap::iterator;
 
+    struct LruShard
+    {
+        std::mutex cache_mutex;
+        LruList list;  //  Contains key/data pairs. Maintains LRU order with
+                       //  least recently used at the end.
+        LruMap map;    //  Maps key to list iterator for fast lookup.
+
+        struct LruCacheSharedStats stats;
+    };
+
     static constexpr size_t mem_chunk = sizeof(Data) + sizeof(Value);
 
     std::atomic<size_t> max_size; // Once max_size elements are in the cache, start to
@@ -150,12 +210,42 @@ protected:
 
     std::atomic<size_t> current_size;// Number of entries currently in the cache.
 
-    std::mutex cache_mutex;
-    LruList list;  //  Contains key/data pairs. Maintains LRU order with
-                   //  least recently used at the end.
-    LruMap map;    //  Maps key to list iterator for fast lookup.
+    std::vector<LruShard> shards;
+    std::atomic<unsigned> next_victim { 0 };
+
+    struct LruCacheSharedStats stats;  // sum of shard stats, see get_counts()
+    std::mutex stats_mutex;
+
+    LruShard& get_shard(const Key& key)
+    {
+        if ( shards.size() == 1 )
+            return shards[0];
+
+        // mix the hash since many key hashes are weak in the low bits
+        uint64_t h = Hash()(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return shards[h % shards.size()];
+    }
 
-    struct LruCacheSharedStats stats;
+    // Rotate over the shards for work that is not tied to a key such as
+    // pruning after a size update or during reload.
+    LruShard& get_next_shard()
+    { return shards[next_victim++ % shards.size()]; }
+
+    // Count the times a shard was already held by another thread.
+    std::unique_lock<std::mutex> lock_shard(LruShard& shard)
+    {
+        std::unique_lock<std::mutex> cache_lock(shard.cache_mutex, std::try_to_lock);
+
+        if ( !cache_lock.owns_lock() )
+        {
+            cache_lock.lock();
+            ++shard.stats.lock_contentions;
+        }
+        return cache_lock;
+    }
 
     // The reason for these functions is to allow derived classes to do their
     // size book keeping differently (e.g. host_cache). This effectively
@@ -174,22 +264,81 @@ protected:
         current_size--;
     }
 
-    // Caller must lock and unlock. Don't use this during snort reload for which
-    // we need gradual pruning and size reduction via reload resource tuner.
-    void prune(Purgatory& data)
+    // Remove the least recently used entry of a locked shard.
+    void prune_one(LruShard& shard, Purgatory& data)
+    {
+        LruListIter list_iter = --shard.list.end();
+        data.emplace_back(list_iter->second); // increase reference count
+        decrease_size(list_iter->second.get());
+        shard.map.erase(list_iter->first);
+        shard.list.erase(list_iter);
+        ++shard.stats.alloc_prunes;
+    }
+
+    // Caller must lock and unlock the given shard. Don't use this during snort
+    // reload for which we need gradual pruning and size reduction via reload
+    // resource tuner. Other shards are pruned only if they can be locked
+    // without waiting.
+    void prune(LruShard& shard, Purgatory& data)
+    {
+        assert(data.empty());
+
+        while ( current_size > max_size and !shard.list.empty() )
+            prune_one(shard, data);
+
+        for ( auto& other : shards )
+        {
+            if ( current_size <= max_size )
+                break;
+
+            if ( &other == &shard )
+                continue;
+
+            std::unique_lock<std::mutex> other_lock(other.cache_mutex, std::try_to_lock);
+
+            if ( !other_lock.owns_lock() )
+                continue;
+
+            while ( current_size > max_size and !other.list.empty() )
+                prune_one(other, data);
+        }
+    }
+
+    // Caller must lock() all shards. Prunes the shards round robin.
+    void prune_all(Purgatory& data)
     {
-        LruListIter list_iter;
         assert(data.empty());
-        while (current_size > max_size && !list.empty())
+        bool pruned = true;
+
+        while ( current_size > max_size and pruned )
         {
-            list_iter = --list.end();
-            data.emplace_back(list_iter->second); // increase reference count
-            decrease_size(list_iter->second.get());
-            map.erase(list_iter->first);
-            list.erase(list_iter);
-            ++stats.alloc_prunes;
+            pruned = false;
+
+            for ( auto& shard : shards )
+            {
+                if ( current_size <= max_size )
+                    break;
+
+                if ( !shard.list.empty() )
+                {
+                    prune_one(shard, data);
+                    pruned = true;
+                }
+            }
         }
     }
+
+private:
+    void make_shards(unsigned num_shards)
+    {
+        if ( !num_shards )
+            num_shards = 1;
+        else if ( num_shards > LRU_CACHE_MAX_SHARDS )
+            num_shards = LRU_CACHE_MAX_SHARDS;
+
+        std::vector<LruShard> tmp(num_shards);
+        shards.swap(tmp);
+    }
 };
 
 template<typename Key, typename Value, typename Hash, typename Eq, typename Purgatory>
@@ -200,35 +349,51 @@ bool LruCacheShared<Key, Value, Hash, Eq, Purgatory>::set_max_size(size_t newsiz
 
     // Like with remove(), we need local temporary references to data being
     // deleted, to avoid race condition. This data needs to self-destruct
-    // after the cache_lock does.
+    // after the cache is unlocked.
     Purgatory data;
 
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    lock();
 
     //  Remove the oldest entries if we have to reduce cache size.
     max_size = newsize;
 
-    prune(data);
+    prune_all(data);
+
+    unlock();
 
     return true;
 }
 
+template<typename Key, typename Value, typename Hash, typename Eq, typename Purgatory>
+bool LruCacheShared<Key, Value, Hash, Eq, Purgatory>::set_shards(unsigned num_shards)
+{
+    if ( num_shards == shards.size() )
+        return true;
+
+    if ( size() )
+        return false;
+
+    make_shards(num_shards);
+    return true;
+}
+
 template<typename Key, typename Value, typename Hash, typename Eq, typename Purgatory>
 std::shared_ptr<Value> LruCacheShared<Key, Value, Hash, Eq, Purgatory>::find(const Key& key)
 {
     LruMapIter map_iter;
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    LruShard& shard = get_shard(key);
+    auto cache_lock = lock_shard(shard);
 
-    map_iter = map.find(key);
-    if (map_iter == map.end())
+    map_iter = shard.map.find(key);
+    if (map_iter == shard.map.end())
     {
-        stats.find_misses++;
+        shard.stats.find_misses++;
         return nullptr;
     }
 
     //  Move entry to front of LruList
-    list.splice(list.begin(), list, map_iter->second);
-    stats.find_hits++;
+    shard.list.splice(shard.list.begin(), shard.list, map_iter->second);
+    shard.stats.find_hits++;
     return map_iter->second->second;
 }
 
@@ -252,30 +417,31 @@ find_else_create(const Key& key, bool* new_data)
     // delete it before we got a chance to return it.
     Purgatory tmp_data;
 
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    LruShard& shard = get_shard(key);
+    auto cache_lock = lock_shard(shard);
 
-    map_iter = map.find(key);
-    if (map_iter != map.end())
+    map_iter = shard.map.find(key);
+    if (map_iter != shard.map.end())
     {
-        stats.find_hits++;
-        list.splice(list.begin(), list, map_iter->second); // update LRU
+        shard.stats.find_hits++;
+        shard.list.splice(shard.list.begin(), shard.list, map_iter->second); // update LRU
         return map_iter->second->second;
     }
 
-    stats.find_misses++;
-    stats.adds++;
+    shard.stats.find_misses++;
+    shard.stats.adds++;
     if ( new_data )
         *new_data = true;
     Data data = Data(new Value);
 
     //  Add key/data pair to front of list.
-    list.emplace_front(std::make_pair(key, data));
+    shard.list.emplace_front(std::make_pair(key, data));
     increase_size(data.get());
 
     //  Add list iterator for the new entry to map.
-    map[key] = list.begin();
+    shard.map[key] = shard.list.begin();
 
-    prune(tmp_data);
+    prune(shard, tmp_data);
 
     return data;
 }
@@ -287,12 +453,13 @@ find_else_insert(const Key& key, std::shared_ptr<Value>& data, bool replace)
     LruMapIter map_iter;
 
     Purgatory tmp_data;
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    LruShard& shard = get_shard(key);
+    auto cache_lock = lock_shard(shard);
 
-    map_iter = map.find(key);
-    if (map_iter != map.end())
+    map_iter = shard.map.find(key);
+    if (map_iter != shard.map.end())
     {
-        stats.find_hits++;
+        shard.stats.find_hits++;
         if (replace)
         {
             // Explicitly calling the reset so its more clear that destructor could be called for the object
@@ -300,23 +467,23 @@ find_else_insert(const Key& key, std::shared_ptr<Value>& data, bool replace)
             map_iter->second->second.reset();
             map_iter->second->second = data;
             increase_size(map_iter->second->second.get());
-            stats.replaced++;
+            shard.stats.replaced++;
         }
-        list.splice(list.begin(), list, map_iter->second); // update LRU
+        shard.list.splice(shard.list.begin(), shard.list, map_iter->second); // update LRU
         return true;
     }
 
-    stats.find_misses++;
-    stats.adds++;
+    shard.stats.find_misses++;
+    shard.stats.adds++;
 
     //  Add key/data pair to front of list.
-    list.emplace_front(std::make_pair(key, data));
+    shard.list.emplace_front(std::make_pair(key, data));
     increase_size(data.get());
 
     //  Add list iterator for the new entry to map.
-    map[key] = list.begin();
+    shard.map[key] = shard.list.begin();
 
-    prune(tmp_data);
+    prune(shard, tmp_data);
 
     return false;
 }
@@ -328,12 +495,13 @@ find_else_insert(const Key& key, std::shared_ptr<Value>& data, LcsInsertStatus*
     LruMapIter map_iter;
 
     Purgatory tmp_data;
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    LruShard& shard = get_shard(key);
+    auto cache_lock = lock_shard(shard);
 
-    map_iter = map.find(key);
-    if (map_iter != map.end())
+    map_iter = shard.map.find(key);
+    if (map_iter != shard.map.end())
     {
-        stats.find_hits++;
+        shard.stats.find_hits++;
         if (status) *status = LcsInsertStatus::LCS_ITEM_PRESENT;
         if (replace)
         {
@@ -342,25 +510,25 @@ find_else_insert(const Key& key, std::shared_ptr<Value>& data, LcsInsertStatus*
             map_iter->second->second.reset();
             map_iter->second->second = data;
             increase_size(map_iter->second->second.get());
-            stats.replaced++;
+            shard.stats.replaced++;
             if (status) *status = LcsInsertStatus::LCS_ITEM_REPLACED;
         }
-        list.splice(list.begin(), list, map_iter->second); // update LRU
+        shard.list.splice(shard.list.begin(), shard.list, map_iter->second); // update LRU
         return map_iter->second->second;
     }
 
-    stats.find_misses++;
-    stats.adds++;
+    shard.stats.find_misses++;
+    shard.stats.adds++;
     if (status) *status = LcsInsertStatus::LCS_ITEM_INSERTED;
 
     //  Add key/data pair to front of list.
-    list.emplace_front(std::make_pair(key, data));
+    shard.list.emplace_front(std::make_pair(key, data));
     increase_size(data.get());
 
     //  Add list iterator for the new entry to map.
-    map[key] = list.begin();
+    shard.map[key] = shard.list.begin();
 
-    prune(tmp_data);
+    prune(shard, tmp_data);
 
     return data;
 }
@@ -370,11 +538,15 @@ std::vector< std::pair<Key, std::shared_ptr<Value>> >
 LruCacheShared<Key, Value, Hash, Eq, Purgatory>::get_all_data()
 {
     std::vector<std::pair<Key, Data> > vec;
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
 
-    for (auto& entry : list )
+    for ( auto& shard : shards )
     {
-        vec.emplace_back(entry);
+        std::lock_guard<std::mutex> cache_lock(shard.cache_mutex);
+
+        for (auto& entry : shard.list )
+        {
+            vec.emplace_back(entry);
+        }
     }
 
     return vec;
@@ -398,10 +570,11 @@ bool LruCacheShared<Key, Value, Hash, Eq, Purgatory>::remove(const Key& key)
     // data and cache_lock!
     Data data;
 
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    LruShard& shard = get_shard(key);
+    auto cache_lock = lock_shard(shard);
 
-    map_iter = map.find(key);
-    if (map_iter == map.end())
+    map_iter = shard.map.find(key);
+    if (map_iter == shard.map.end())
     {
         return false;   //  Key is not in LruCache.
     }
@@ -409,9 +582,9 @@ bool LruCacheShared<Key, Value, Hash, Eq, Purgatory>::remove(const Key& key)
     data = map_iter->second->second;
 
     decrease_size(data.get());
-    list.erase(map_iter->second);
-    map.erase(map_iter);
-    stats.removes++;
+    shard.list.erase(map_iter->second);
+    shard.map.erase(map_iter);
+    shard.stats.removes++;
 
     assert( data.use_count() > 0 );
 
@@ -427,10 +600,11 @@ bool LruCacheShared<Key, Value, Hash, Eq, Purgatory>::remove(const Key& key,
 {
     LruMapIter map_iter;
 
-    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+    LruShard& shard = get_shard(key);
+    auto cache_lock = lock_shard(shard);
 
-    map_iter = map.find(key);
-    if (map_iter == map.end())
+    map_iter = shard.map.find(key);
+    if (map_iter == shard.map.end())
     {
         return false;   //  Key is not in LruCache.
     }
@@ -438,9 +612,9 @@ bool LruCacheShared<Key, Value, Hash, Eq, Purgatory>::remove(const Key& key,
     data = map_iter->second->second;
 
     decrease_size(data.get());
-    list.erase(map_iter->second);
-    map.erase(map_iter);
-    stats.removes++;
+    shard.list.erase(map_iter->second);
+    shard.map.erase(map_iter);
+    shard.stats.removes++;
 
     assert( data.use_count() > 0 );
 
@@ -0,0 +1,211 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// hash_benchmark.cc
+// benchmarks for the hash tables and flow key hashing
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "flow/flow_key.h"
+#include "hash/ghash.h"
+#include "hash/hash_defs.h"
+#include "hash/xhash.h"
+#include "hash/zhash.h"
+#include "main/snort_config.h"
+#include "sfip/sf_ip.h"
+#include "utils/util.h"
+
+using namespace snort;
+
+static SnortConfig my_config;
+THREAD_LOCAL SnortConfig* snort_conf = &my_config;
+
+SnortConfig::SnortConfig(const SnortConfig* const, const char*)
+{ snort_conf->run_flags = 0;}
+
+SnortConfig::~SnortConfig() = default;
+
+const SnortConfig* SnortConfig::get_conf()
+{ return snort_conf; }
+
+SfIpRet SfIp::set(void const*, int) { return SFIP_SUCCESS; }
+
+#define NUM_KEYS 16384
+#define NUM_ROWS 16384
+
+// ipv4 tcp keys with random addresses and ports as built by FlowKey::init
+static const std::vector<FlowKey>& get_flow_keys()
+{
+    static std::vector<FlowKey> keys;
+
+    if ( keys.empty() )
+    {
+        std::mt19937 rng(1);
+        keys.resize(NUM_KEYS);
+
+        for ( auto& k : keys )
+        {
+            memset(&k, 0, sizeof(k));
+            k.ip_l[2] = k.ip_h[2] = htonl(0xffff);
+            k.ip_l[3] = rng();
+            k.ip_h[3] = rng();
+            k.port_l = rng();
+            k.port_h = 80;
+            k.ip_protocol = 6;
+            k.pkt_type = PktType::TCP;
+            k.version = 4;
+        }
+    }
+    return keys;
+}
+
+TEST_CASE("flow key ops", "[hash]")
+{
+    const std::vector<FlowKey>& keys = get_flow_keys();
+    FlowHashKeyOps ops(NUM_ROWS);
+
+    BENCHMARK("do_hash")
+    {
+        unsigned h = 0;
+
+        for ( const auto& k : keys )
+            h += ops.do_hash((const unsigned char*)&k, sizeof(k));
+
+        return h;
+    };
+
+    BENCHMARK("key_compare equal")
+    {
+        unsigned n = 0;
+
+        for ( const auto& k : keys )
+        {
+            FlowKey c = k;
+            n += ops.key_compare(&k, &c, sizeof(k));
+        }
+        return n;
+    };
+
+    BENCHMARK("key_compare differ")
+    {
+        unsigned n = 0;
+
+        for ( unsigned i = 1; i < keys.size(); ++i )
+            n += ops.key_compare(&keys[i - 1], &keys[i], sizeof(FlowKey));
+
+        return n;
+    };
+}
+
+TEST_CASE("xhash", "[hash]")
+{
+    const std::vector<FlowKey>& keys = get_flow_keys();
+
+    BENCHMARK_ADVANCED("insert")(Catch::Benchmark::Chronometer meter)
+    {
+        XHash table(NUM_ROWS, sizeof(FlowKey), 0, 0);
+
+        meter.measure([&]
+        {
+            for ( const auto& k : keys )
+                table.insert(&k, nullptr);
+
+            table.clear_hash();
+        });
+    };
+
+    XHash table(NUM_ROWS, sizeof(FlowKey), 0, 0);
+
+    for ( const auto& k : keys )
+        table.insert(&k, nullptr);
+
+    BENCHMARK("find_node")
+    {
+        unsigned n = 0;
+
+        for ( const auto& k : keys )
+            n += table.find_node(&k) != nullptr;
+
+        return n;
+    };
+}
+
+TEST_CASE("zhash", "[hash]")
+{
+    const std::vector<FlowKey>& keys = get_flow_keys();
+    std::vector<unsigned> data(NUM_KEYS);
+    ZHash table(NUM_ROWS, sizeof(FlowKey));
+
+    for ( auto& d : data )
+        table.push(&d);
+
+    // fill the table as the flow cache does
+    for ( const auto& k : keys )
+        table.get(&k);
+
+    BENCHMARK("get")
+    {
+        unsigned n = 0;
+
+        for ( const auto& k : keys )
+            n += table.get(&k) != nullptr;
+
+        return n;
+    };
+
+    BENCHMARK("lru walk")
+    {
+        unsigned n = 0;
+
+        for ( void* p = table.lru_first(); p; p = table.lru_next() )
+            ++n;
+
+        return n;
+    };
+}
+
+TEST_CASE("ghash", "[hash]")
+{
+    std::vector<std::string> keys;
+
+    for ( unsigned i = 0; i < NUM_KEYS; ++i )
+        keys.emplace_back("ghash_key_" + std::to_string(i));
+
+    GHash table(NUM_ROWS, 0, false, nullptr);
+
+    for ( auto& k : keys )
+        table.insert(k.c_str(), &k);
+
+    BENCHMARK("find")
+    {
+        unsigned n = 0;
+
+        for ( const auto& k : keys )
+            n += table.find(k.c_str()) != nullptr;
+
+        return n;
+    };
+}
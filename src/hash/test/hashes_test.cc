@@ -0,0 +1,154 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// hashes_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "hash/hashes.h"
+
+using namespace snort;
+
+static std::vector<uint8_t> make_file(size_t len)
+{
+    std::mt19937 rng(1);
+    std::vector<uint8_t> buf(len);
+
+    for ( auto& b : buf )
+        b = rng();
+
+    return buf;
+}
+
+TEST_CASE("sha256 known answer", "[hashes]")
+{
+    const uint8_t abc[SHA256_HASH_SIZE] =
+    {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+        0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+        0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    uint8_t out[SHA256_HASH_SIZE];
+
+    sha256((const unsigned char*)"abc", 3, out);
+    CHECK(!memcmp(out, abc, sizeof(out)));
+
+    Sha256 s;
+    s.update("a", 1);
+    s.update("bc", 2);
+    s.final(out);
+    CHECK(!memcmp(out, abc, sizeof(out)));
+}
+
+TEST_CASE("sha256 streaming", "[hashes]")
+{
+    std::vector<uint8_t> file = make_file(100000);
+    uint8_t expected[SHA256_HASH_SIZE];
+    uint8_t out[SHA256_HASH_SIZE];
+
+    sha256(file.data(), file.size(), expected);
+
+    // segment sizes that do and do not line up with the 64 byte block
+    for ( size_t seg : { 1, 63, 64, 65, 1460, 8192 } )
+    {
+        Sha256 s;
+
+        for ( size_t off = 0; off < file.size(); off += seg )
+            s.update(file.data() + off, std::min(seg, file.size() - off));
+
+        s.final(out);
+        CHECK(!memcmp(out, expected, sizeof(out)));
+    }
+}
+
+TEST_CASE("sha256 digest mid stream", "[hashes]")
+{
+    std::vector<uint8_t> file = make_file(10000);
+    uint8_t expected[SHA256_HASH_SIZE];
+    uint8_t out[SHA256_HASH_SIZE];
+
+    Sha256 s;
+    s.update(file.data(), 5000);
+    s.digest(out);
+
+    sha256(file.data(), 5000, expected);
+    CHECK(!memcmp(out, expected, sizeof(out)));
+
+    s.update(file.data() + 5000, 5000);
+    s.final(out);
+
+    sha256(file.data(), file.size(), expected);
+    CHECK(!memcmp(out, expected, sizeof(out)));
+
+    s.reset();
+    s.update(file.data(), 5000);
+    s.final(out);
+
+    sha256(file.data(), 5000, expected);
+    CHECK(!memcmp(out, expected, sizeof(out)));
+}
+
+#ifdef BENCHMARK_TEST
+// a 1 MiB file arriving in full size tcp segments as file_api sees it;
+// divide the file size by the mean to get bytes / sec per core
+TEST_CASE("sha256 benchmarks", "[hashes]")
+{
+    const size_t seg = 1460;
+    std::vector<uint8_t> file = make_file(1 << 20);
+    uint8_t out[SHA256_HASH_SIZE];
+
+    BENCHMARK("one shot 1 MiB")
+    {
+        sha256(file.data(), file.size(), out);
+        return out[0];
+    };
+
+    BENCHMARK("segments 1 MiB")
+    {
+        Sha256 s;
+
+        for ( size_t off = 0; off < file.size(); off += seg )
+            s.update(file.data() + off, std::min(seg, file.size() - off));
+
+        s.final(out);
+        return out[0];
+    };
+
+    // signature flush digests after every segment
+    BENCHMARK("segments with digest 1 MiB")
+    {
+        Sha256 s;
+
+        for ( size_t off = 0; off < file.size(); off += seg )
+        {
+            s.update(file.data() + off, std::min(seg, file.size() - off));
+            s.digest(out);
+        }
+        return out[0];
+    };
+}
+#endif
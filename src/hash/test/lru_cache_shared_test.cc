@@ -26,6 +26,7 @@
 #include "hash/lru_cache_shared.h"
 
 #include <cstring>
+#include <thread>
 
 #include <CppUTest/CommandLineTestRunner.h>
 #include <CppUTest/TestHarness.h>
@@ -208,6 +209,89 @@ TEST(lru_cache_shared, stats_test)
     CHECK(!strcmp(pegs[3].name, "find_misses"));
     CHECK(!strcmp(pegs[4].name, "reload_prunes"));
     CHECK(!strcmp(pegs[5].name, "removes"));
+    CHECK(!strcmp(pegs[6].name, "replaced"));
+    CHECK(!strcmp(pegs[7].name, "lock_contentions"));
+}
+
+//  Test LruCacheShared with several shards.
+TEST(lru_cache_shared, shards_test)
+{
+    LruCacheShared<int, std::string, std::hash<int> > lru_cache(8, 4);
+
+    CHECK(lru_cache.get_shards() == 4);
+
+    for (int i = 0; i < 8; i++)
+        lru_cache[i]->assign(std::to_string(i));
+
+    CHECK(lru_cache.size() == 8);
+    CHECK(lru_cache.get_all_data().size() == 8);
+
+    for (int i = 0; i < 8; i++)
+        CHECK(*lru_cache.find(i) == std::to_string(i));
+
+    // shard count can only change while empty
+    CHECK(lru_cache.set_shards(2) == false);
+
+    // memcap is global across the shards
+    for (int i = 8; i < 16; i++)
+        lru_cache[i];
+
+    CHECK(lru_cache.size() == 8);
+    CHECK(lru_cache.find(15) != nullptr);
+
+    CHECK(lru_cache.set_max_size(2) == true);
+    CHECK(lru_cache.size() == 2);
+
+    PegCount* stats = lru_cache.get_counts();
+    CHECK(stats[0] == 16);          //  adds
+    CHECK(stats[2] == 9);           //  find hits
+    CHECK(stats[1] + stats[5] + lru_cache.size() == 16);
+    CHECK(stats[7] == 0);           //  no contention
+
+    while (lru_cache.size())
+    {
+        auto vec = lru_cache.get_all_data();
+        lru_cache.remove(vec[0].first);
+    }
+    CHECK(lru_cache.set_shards(2) == true);
+    CHECK(lru_cache.get_shards() == 2);
+
+    // out of range shard counts are clamped
+    CHECK(lru_cache.set_shards(0) == true);
+    CHECK(lru_cache.get_shards() == 1);
+}
+
+//  Test concurrent access to a sharded cache.
+TEST(lru_cache_shared, shards_thread_test)
+{
+    LruCacheShared<int, std::string, std::hash<int> > lru_cache(100, 8);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&lru_cache, t]()
+        {
+            for (int i = 0; i < 1000; i++)
+            {
+                int key = (i * 4 + t) % 300;
+                lru_cache[key];
+                lru_cache.find(key + 1);
+                if ( i % 7 == 0 )
+                    lru_cache.remove(key);
+            }
+        });
+    }
+
+    for (auto& th : threads)
+        th.join();
+
+    // pruning skips shards held by other threads so the cache may be left
+    // over max_size; once there is no contention the next insert catches up
+    lru_cache[1000];
+    CHECK(lru_cache.size() <= 100);
+
+    PegCount* stats = lru_cache.get_counts();
+    CHECK(stats[0] == stats[1] + stats[5] + lru_cache.size());
 }
 
 int main(int argc, char** argv)
@@ -126,6 +126,43 @@ TEST(xhash, free_anr_lru_delete_tail_node_test)
     delete test_table;
 }
 
+// The prefetched row must be the row the key is found in
+TEST(xhash, prefetch_row_test)
+{
+    XHash* test_table = new XHash(16, sizeof(struct xhash_test_key), 0, 0);
+    CHECK(test_table);
+
+    for (unsigned i = 1; i <= 8; i++)
+    {
+        xhash_test_key xtk;
+        xtk.key = 10 * i;
+        int ret = test_table->insert(&xtk, nullptr);
+        CHECK(ret == HASH_OK);
+    }
+
+    for (unsigned i = 1; i <= 8; i++)
+    {
+        xhash_test_key xtk;
+        xtk.key = 10 * i;
+        unsigned row = test_table->prefetch_row(&xtk);
+        test_table->prefetch_node(row);
+        test_table->prefetch_data(row);
+
+        HashNode* xnode = test_table->find_node(&xtk);
+        CHECK(xnode);
+        CHECK(xnode->rindex == (int)row);
+    }
+
+    // a key that is not in the table
+    xhash_test_key xtk;
+    xtk.key = 12345;
+    unsigned row = test_table->prefetch_row(&xtk);
+    test_table->prefetch_node(row);
+    test_table->prefetch_data(row);
+
+    delete test_table;
+}
+
 int main(int argc, char** argv)
 {
     return CommandLineTestRunner::RunAllTests(argc, argv);
@@ -38,6 +38,9 @@ using namespace snort;
 
 namespace snort
 {
+FlowHashKeyOps::FlowHashKeyOps(int rows) : HashKeyOperations(rows)
+{ use_crc = false; }
+
 unsigned FlowHashKeyOps::do_hash(const unsigned char* k, int len)
 {
     unsigned hash = seed;
@@ -244,6 +244,33 @@ HashNode* XHash::find_node(const void* key)
     return find_node_row(key, rindex);
 }
 
+unsigned XHash::prefetch_row(const void* key)
+{
+    unsigned hashkey = hashkey_ops->do_hash((const unsigned char*)key, keysize);
+    unsigned row = hashkey & (nrows - 1);
+    __builtin_prefetch(table + row);
+    return row;
+}
+
+void XHash::prefetch_node(unsigned row)
+{
+    assert(row < nrows);
+
+    if ( HashNode* hnode = table[row] )
+        __builtin_prefetch(hnode);
+}
+
+void XHash::prefetch_data(unsigned row)
+{
+    assert(row < nrows);
+
+    if ( HashNode* hnode = table[row] )
+    {
+        __builtin_prefetch(hnode->key);
+        __builtin_prefetch(hnode->data);
+    }
+}
+
 HashNode* XHash::find_first_node()
 {
     for ( crow = 0; crow < nrows; crow++ )
@@ -86,6 +86,14 @@ public:
     const XHashStats& get_stats() const
     { return stats; }
 
+    // a batch of lookups can overlap the cache misses by prefetching the
+    // row of each key first, then the node at the head of each row, and
+    // finally its data.  only the head is fetched since finds move the
+    // node to the front of the row.
+    unsigned prefetch_row(const void* key);
+    void prefetch_node(unsigned row);
+    void prefetch_data(unsigned row);
+
     virtual int tune_memory_resources(unsigned work_limit, unsigned& num_freed);
 
 protected:
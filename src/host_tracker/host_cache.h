@@ -65,22 +65,21 @@ class LruCacheSharedMemcap : public LruCacheShared<Key, Value, Hash, Eq, Purgato
 {
 public:
     using LruBase = LruCacheShared<Key, Value, Hash, Eq, Purgatory>;
-    using LruBase::cache_mutex;
     using LruBase::current_size;
-    using LruBase::list;
-    using LruBase::map;
     using LruBase::max_size;
     using LruBase::mem_chunk;
-    using LruBase::stats;
+    using LruBase::shards;
     using Data = typename LruBase::Data;
     using LruListIter = typename LruBase::LruListIter;
+    using LruShard = typename LruBase::LruShard;
     using ValueType = typename LruBase::ValueType;
 
     LruCacheSharedMemcap() = delete;
     LruCacheSharedMemcap(const LruCacheSharedMemcap& arg) = delete;
     LruCacheSharedMemcap& operator=(const LruCacheSharedMemcap& arg) = delete;
 
-    LruCacheSharedMemcap(const size_t sz) : LruCacheShared<Key, Value, Hash, Eq, Purgatory>(sz),
+    LruCacheSharedMemcap(const size_t sz, unsigned num_shards = 1) :
+        LruCacheShared<Key, Value, Hash, Eq, Purgatory>(sz, num_shards),
         valid_id(invalid_id+1) {}
 
     size_t mem_size() override
@@ -125,24 +124,33 @@ public:
             // Get a local temporary reference of data being deleted (as if a trash can).
             // To avoid race condition, data needs to self-destruct after the cache_lock does.
             Data data;
-            std::lock_guard<std::mutex> cache_lock(cache_mutex);
+            bool empty = true;
 
-            if ( !list.empty() )
+            // take the next shard that has something to prune
+            for ( unsigned n = 0; n < shards.size() and empty; ++n )
             {
+                LruShard& shard = LruBase::get_next_shard();
+                std::lock_guard<std::mutex> cache_lock(shard.cache_mutex);
+
+                if ( shard.list.empty() )
+                    continue;
+
+                empty = false;
                 max_size.store(current_size);
+
                 if ( max_size > new_size )
                 {
-                    LruListIter list_iter = --list.end();
+                    LruListIter list_iter = --shard.list.end();
                     data = list_iter->second; // increase reference count
                     decrease_size();
                     max_size -= mem_chunk; // in sync with current_size
-                    map.erase(list_iter->first);
-                    list.erase(list_iter);
-                    ++stats.reload_prunes;
+                    shard.map.erase(list_iter->first);
+                    shard.list.erase(list_iter);
+                    ++shard.stats.reload_prunes;
                 }
             }
 
-            if ( max_size <= new_size or list.empty() )
+            if ( max_size <= new_size or empty )
             {
                 max_size = new_size;
                 return true;
@@ -201,8 +209,9 @@ private:
             // Do not change the order of data and cache_lock, as the data must
             // self destruct after cache_lock.
             Purgatory data;
-            std::lock_guard<std::mutex> cache_lock(cache_mutex);
-            LruBase::prune(data);
+            LruShard& shard = LruBase::get_next_shard();
+            std::lock_guard<std::mutex> cache_lock(shard.cache_mutex);
+            LruBase::prune(shard, data);
         }
     }
 
@@ -349,6 +349,9 @@ static const Parameter host_cache_params[] =
     { "memcap", Parameter::PT_INT, "512:maxSZ", "8388608",
       "maximum host cache size in bytes" },
 
+    { "shards", Parameter::PT_INT, "1:256", "1",
+      "number of independently locked partitions of the host cache; takes effect on restart" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -362,6 +365,8 @@ bool HostCacheModule::set(const char*, Value& v, SnortConfig*)
     }
     else if ( v.is("memcap") )
         memcap = v.get_size();
+    else if ( v.is("shards") )
+        shards = v.get_uint16();
 
     return true;
 }
@@ -373,7 +378,13 @@ bool HostCacheModule::end(const char* fqn, int, SnortConfig* sc)
         if ( Snort::is_reloading() )
             sc->register_reload_resource_tuner(new HostCacheReloadTuner(memcap));
         else
+        {
+            if ( !host_cache.set_shards(shards) )
+                ParseWarning(WARN_CONF, "host_cache.shards ignored since the cache is in use, "
+                    "keeping %u", host_cache.get_shards());
+
             host_cache.set_max_size(memcap);
+        }
     }
 
     return true;
@@ -454,8 +465,6 @@ string HostCacheModule::get_host_cache_stats()
         + to_string(lru_data.size()) + " trackers, memcap: " + to_string(host_cache.max_size)
         + " bytes\n";
 
-    host_cache.lock();
-
     PegCount* counts = (PegCount*) host_cache.get_counts();
     const PegInfo* pegs = host_cache.get_pegs();
 
@@ -469,8 +478,6 @@ string HostCacheModule::get_host_cache_stats()
 
     }
 
-    host_cache.unlock();
-
     return str;
 }
 
@@ -480,9 +487,3 @@ const PegInfo* HostCacheModule::get_pegs() const
 PegCount* HostCacheModule::get_counts() const
 { return (PegCount*)host_cache.get_counts(); }
 
-void HostCacheModule::sum_stats(bool accumulate_now_stats)
-{
-    host_cache.lock();
-    Module::sum_stats(accumulate_now_stats);
-    host_cache.unlock();
-}
@@ -61,7 +61,6 @@ public:
     const snort::Command* get_commands() const override;
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
-    void sum_stats(bool) override;
 
     Usage get_usage() const override
     { return GLOBAL; }
@@ -72,6 +71,7 @@ public:
 private:
     const char* dump_file = nullptr;
     size_t memcap = 0;
+    unsigned shards = 1;
 };
 
 #endif
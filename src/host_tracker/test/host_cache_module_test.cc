@@ -70,6 +70,7 @@ void LogMessage(const char* format,...)
     va_end(args);
     logged_message[LOG_MAX] = '\0';
 }
+void ParseWarning(WarningGroup, const char*, ...) { }
 time_t packet_time() { return 0; }
 bool Snort::is_reloading() { return false; }
 void SnortConfig::register_reload_resource_tuner(ReloadResourceTuner* rrt) { delete rrt; }
@@ -114,7 +115,8 @@ TEST(host_cache_module, misc)
     CHECK(!strcmp(ht_pegs[4].name, "reload_prunes"));
     CHECK(!strcmp(ht_pegs[5].name, "removes"));
     CHECK(!strcmp(ht_pegs[6].name, "replaced"));
-    CHECK(!ht_pegs[7].name);
+    CHECK(!strcmp(ht_pegs[7].name, "lock_contentions"));
+    CHECK(!ht_pegs[8].name);
 
     // add 3 entries
     SfIp ip1, ip2, ip3;
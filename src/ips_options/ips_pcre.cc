@@ -25,7 +25,16 @@
 
 #include <pcre.h>
 
+#include <algorithm>
 #include <cassert>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_HYPERSCAN
+#include <hs_compile.h>
+#include <hs_runtime.h>
+#endif
 
 #include "detection/ips_context.h"
 #include "framework/cursor.h"
@@ -33,6 +42,9 @@
 #include "framework/module.h"
 #include "framework/parameter.h"
 #include "hash/hash_key_operations.h"
+#ifdef HAVE_HYPERSCAN
+#include "helpers/hyper_scratch_allocator.h"
+#endif
 #include "helpers/scratch_allocator.h"
 #include "log/messages.h"
 #include "main/snort_config.h"
@@ -71,7 +83,10 @@ struct PcreData
     pcre_extra* pe;     /* studied regex foo */
     bool free_pe;
     int options;        /* sp_pcre specific options (relative & inverse) */
+    int compile_flags;  /* pcre_compile() options from the /regex/ismxAEG modifiers */
+    bool prefilter;     /* candidate for the hyperscan prefilter */
     char* expression;
+    char* regex;        /* expression without delimiters and modifiers */
 };
 
 // we need to specify the vector length for our pcre_exec call.  we only care
@@ -88,6 +103,111 @@ static ScratchAllocator* scratcher = nullptr;
 
 static THREAD_LOCAL ProfileStats pcrePerfStats;
 
+#ifdef HAVE_HYPERSCAN
+//-------------------------------------------------------------------------
+// prefilter foo
+//
+// the pcre options that look at the same buffer share a hyperscan database
+// compiled in prefilter mode.  a prefilter expression matches whenever the
+// original does (and perhaps more often) so one scan of the buffer tells us
+// which options can possibly match.  pcre_exec is only called for those.
+//-------------------------------------------------------------------------
+
+class PcreOption;
+
+struct PcrePrefilter
+{
+    const char* buffer;
+    hs_database_t* db = nullptr;
+    unsigned size = 0;   // number of expressions in db
+    unsigned refs = 0;   // number of options using db
+
+    PcrePrefilter(const char* s) : buffer(s) { }
+
+    ~PcrePrefilter()
+    {
+        if ( db )
+            hs_free_database(db);
+    }
+
+    bool may_match(unsigned id, const Packet*, const uint8_t*, unsigned);
+};
+
+// the last few scans on this thread; rules usually look at a handful of
+// buffers per packet so a small round robin cache is enough
+struct PrefilterScan
+{
+    const PcrePrefilter* prefilter = nullptr;
+    uint64_t context_num = 0;
+    const uint8_t* buf = nullptr;
+    unsigned len = 0;
+    std::vector<bool> hits;
+};
+
+struct PrefilterCache
+{
+    static const unsigned max_scans = 8;
+    PrefilterScan scans[max_scans];
+    unsigned next = 0;
+};
+
+static HyperScratchAllocator* prefilter_scratcher = nullptr;
+static THREAD_LOCAL PrefilterCache* prefilter_cache = nullptr;
+
+// options constructed since the last verify; these are compiled into
+// prefilters once all rules are loaded
+static std::vector<PcreOption*> prefilter_pending;
+
+static int prefilter_match(
+    unsigned int id, unsigned long long /*from*/, unsigned long long /*to*/,
+    unsigned int /*flags*/, void* context)
+{
+    std::vector<bool>* hits = (std::vector<bool>*)context;
+    (*hits)[id] = true;
+    return 0;
+}
+
+bool PcrePrefilter::may_match(unsigned id, const Packet* p, const uint8_t* buf, unsigned len)
+{
+    uint64_t context_num = p->context->context_num;
+
+    if ( !prefilter_cache )
+        prefilter_cache = new PrefilterCache;
+
+    for ( auto& scan : prefilter_cache->scans )
+    {
+        if ( scan.prefilter == this and scan.context_num == context_num and
+            scan.buf == buf and scan.len == len )
+            return scan.hits[id];
+    }
+
+    PrefilterScan& scan = prefilter_cache->scans[prefilter_cache->next];
+    prefilter_cache->next = (prefilter_cache->next + 1) % PrefilterCache::max_scans;
+
+    scan.prefilter = this;
+    scan.context_num = context_num;
+    scan.buf = buf;
+    scan.len = len;
+    scan.hits.assign(size, false);
+
+    if ( hs_scan(db, (const char*)buf, len, 0, prefilter_scratcher->get(),
+        prefilter_match, &scan.hits) != HS_SUCCESS )
+    {
+        // let pcre decide
+        scan.hits.assign(size, true);
+    }
+    return scan.hits[id];
+}
+
+static bool pcre_prefilter_candidate(const PcreData* pcre_data)
+{
+    // hyperscan has no equivalent of extended syntax and anchoring to the
+    // start offset is not the same as anchoring to the start of the buffer
+    return pcre_data->re and
+        !(pcre_data->compile_flags & (PCRE_EXTENDED | PCRE_ANCHORED));
+}
+#endif
+
 //-------------------------------------------------------------------------
 // implementation foo
 //-------------------------------------------------------------------------
@@ -225,6 +345,8 @@ static void pcre_parse(const SnortConfig* sc, const char* data, PcreData* pcre_d
     re++;
     *opts++ = '\0';
 
+    pcre_data->regex = snort_strdup(re);
+
     /* process any /regex/ismxR options */
     while (*opts != '\0')
     {
@@ -258,6 +380,8 @@ static void pcre_parse(const SnortConfig* sc, const char* data, PcreData* pcre_d
         opts++;
     }
 
+    pcre_data->compile_flags = compile_flags;
+
     /* now compile the re */
     pcre_data->re = pcre_compile(re, compile_flags, &error, &erroffset, nullptr);
 
@@ -452,18 +576,51 @@ public:
     void set_data(PcreData* pcre)
     { config = pcre; }
 
+#ifdef HAVE_HYPERSCAN
+    void set_prefilter(PcrePrefilter* pf, unsigned id)
+    {
+        prefilter = pf;
+        prefilter_id = id;
+        ++pf->refs;
+    }
+#endif
+
 private:
     PcreData* config;
+
+#ifdef HAVE_HYPERSCAN
+    PcrePrefilter* prefilter = nullptr;
+    unsigned prefilter_id = 0;
+#endif
 };
 
 PcreOption::~PcreOption()
 {
+#ifdef HAVE_HYPERSCAN
+    if ( prefilter )
+    {
+        if ( --prefilter->refs == 0 )
+            delete prefilter;
+    }
+    else
+    {
+        // duplicate options are deleted before verify
+        auto it = std::find(prefilter_pending.begin(), prefilter_pending.end(), this);
+
+        if ( it != prefilter_pending.end() )
+            prefilter_pending.erase(it);
+    }
+#endif
+
     if ( !config )
         return;
 
     if ( config->expression )
         snort_free(config->expression);
 
+    if ( config->regex )
+        snort_free(config->regex);
+
     if ( config->pe )
     {
         if ( config->free_pe )
@@ -567,6 +724,15 @@ IpsOption::EvalStatus PcreOption::eval(Cursor& c, Packet* p)
     if ( !pos && is_relative() )
         adj = c.get_pos();
 
+#ifdef HAVE_HYPERSCAN
+    // the prefilter scans the whole buffer so it only applies when pcre does
+    if ( prefilter and !adj and c.size() and !(p->packet_flags & PKT_ALLOW_MULTIPLE_DETECT) and
+        !prefilter->may_match(prefilter_id, p, c.buffer(), c.size()) )
+    {
+        return (config->options & SNORT_PCRE_INVERT) ? MATCH : NO_MATCH;
+    }
+#endif
+
     int found_offset = -1; // where is the ending location of the pattern
 
     if ( pcre_search(p, config, c.buffer()+adj, c.size()-adj, pos, found_offset) )
@@ -623,6 +789,9 @@ struct PcreStats
 #endif
     PegCount pcre_native;
     PegCount pcre_negated;
+#ifdef HAVE_HYPERSCAN
+    PegCount pcre_prefilter;
+#endif
 };
 
 const PegInfo pcre_pegs[] =
@@ -633,6 +802,9 @@ const PegInfo pcre_pegs[] =
 #endif
     { CountType::SUM, "pcre_native", "total pcre rules compiled by pcre engine" },
     { CountType::SUM, "pcre_negated", "total pcre rules using negation syntax" },
+#ifdef HAVE_HYPERSCAN
+    { CountType::SUM, "pcre_prefilter", "total pcre rules screened by a hyperscan prefilter" },
+#endif
     { CountType::END, nullptr, nullptr }
 };
 
@@ -649,12 +821,18 @@ public:
         data = nullptr;
         scratcher = new SimpleScratchAllocator(scratch_setup, scratch_cleanup);
         scratch_index = scratcher->get_id();
+#ifdef HAVE_HYPERSCAN
+        prefilter_scratcher = new HyperScratchAllocator;
+#endif
     }
 
     ~PcreModule() override
     {
         delete data;
         delete scratcher;
+#ifdef HAVE_HYPERSCAN
+        delete prefilter_scratcher;
+#endif
     }
 
 #ifdef HAVE_HYPERSCAN
@@ -734,6 +912,9 @@ bool PcreModule::end(const char* name, int v, SnortConfig* sc)
     {
         data = (PcreData*)snort_calloc(sizeof(*data));
         pcre_parse(sc, re.c_str(), data);
+#ifdef HAVE_HYPERSCAN
+        data->prefilter = sc->pcre_prefilter and pcre_prefilter_candidate(data);
+#endif
     }
 
     return true;
@@ -801,13 +982,154 @@ static IpsOption* pcre_ctor(Module* p, OptTreeNode* otn)
     {
         pcre_stats.pcre_native++;
         PcreData* d = m->get_data();
-        return new PcreOption(d);
+        PcreOption* opt = new PcreOption(d);
+#ifdef HAVE_HYPERSCAN
+        if ( d->prefilter )
+            prefilter_pending.emplace_back(opt);
+#endif
+        return opt;
     }
 }
 
 static void pcre_dtor(IpsOption* p)
 { delete p; }
 
+#ifdef HAVE_HYPERSCAN
+static void pcre_tterm(const SnortConfig*)
+{
+    delete prefilter_cache;
+    prefilter_cache = nullptr;
+}
+
+static hs_database_t* prefilter_compile(
+    const std::vector<const char*>& exprs, const std::vector<unsigned>& flags,
+    int* bad = nullptr)
+{
+    std::vector<unsigned> ids;
+
+    for ( unsigned i = 0; i < exprs.size(); ++i )
+        ids.emplace_back(i);
+
+    hs_database_t* db = nullptr;
+    hs_compile_error_t* err = nullptr;
+
+    if ( hs_compile_multi(exprs.data(), flags.data(), ids.data(), exprs.size(),
+        HS_MODE_BLOCK, nullptr, &db, &err) == HS_SUCCESS )
+        return db;
+
+    if ( bad )
+        *bad = err ? err->expression : -1;
+
+    hs_free_compile_error(err);
+    return nullptr;
+}
+
+static void compile_prefilter(const char* buffer, std::vector<PcreOption*>& opts)
+{
+    std::vector<const char*> exprs;
+    std::vector<unsigned> flags;
+
+    for ( auto* opt : opts )
+    {
+        const PcreData* d = opt->get_data();
+        exprs.emplace_back(d->regex);
+
+        unsigned f = HS_FLAG_PREFILTER | HS_FLAG_SINGLEMATCH | HS_FLAG_ALLOWEMPTY;
+
+        if ( d->compile_flags & PCRE_CASELESS )
+            f |= HS_FLAG_CASELESS;
+
+        if ( d->compile_flags & PCRE_DOTALL )
+            f |= HS_FLAG_DOTALL;
+
+        if ( d->compile_flags & PCRE_MULTILINE )
+            f |= HS_FLAG_MULTILINE;
+
+        flags.emplace_back(f);
+    }
+
+    hs_database_t* db = prefilter_compile(exprs, flags);
+
+    if ( !db )
+    {
+        // leave the expressions hyperscan can't handle to pcre; each is
+        // tried once by itself so a few bad rules don't cost a full
+        // compile apiece
+        unsigned keep = 0;
+
+        for ( unsigned i = 0; i < opts.size(); ++i )
+        {
+            hs_database_t* one = prefilter_compile({ exprs[i] }, { flags[i] });
+
+            if ( !one )
+                continue;
+
+            hs_free_database(one);
+            opts[keep] = opts[i];
+            exprs[keep] = exprs[i];
+            flags[keep] = flags[i];
+            ++keep;
+        }
+        opts.resize(keep);
+        exprs.resize(keep);
+        flags.resize(keep);
+
+        if ( opts.empty() )
+            return;
+
+        int bad = -1;
+        db = prefilter_compile(exprs, flags, &bad);
+
+        if ( !db )
+        {
+            ParseWarning(WARN_RULES, "can't compile %s pcre prefilter (expression %d)",
+                buffer, bad);
+            return;
+        }
+    }
+
+    if ( !prefilter_scratcher->allocate(db) )
+    {
+        ParseWarning(WARN_RULES, "can't allocate scratch for %s pcre prefilter", buffer);
+        hs_free_database(db);
+        return;
+    }
+
+    PcrePrefilter* pf = new PcrePrefilter(buffer);
+    pf->db = db;
+    pf->size = opts.size();
+
+    for ( unsigned i = 0; i < opts.size(); ++i )
+        opts[i]->set_prefilter(pf, i);
+
+    pcre_stats.pcre_prefilter += opts.size();
+}
+
+static void pcre_verify(const SnortConfig*)
+{
+    if ( prefilter_pending.empty() )
+        return;
+
+    std::vector<PcreOption*> pending;
+    pending.swap(prefilter_pending);
+
+    if ( hs_valid_platform() != HS_SUCCESS )
+    {
+        ParseWarning(WARN_RULES, "This host does not support Hyperscan; pcre prefilter disabled.");
+        return;
+    }
+
+    // one database per buffer
+    std::map<std::string, std::vector<PcreOption*>> groups;
+
+    for ( auto* opt : pending )
+        groups[opt->get_buffer()].emplace_back(opt);
+
+    for ( auto& g : groups )
+        compile_prefilter(g.second.front()->get_buffer(), g.second);
+}
+#endif
+
 static const IpsApi pcre_api =
 {
     {
@@ -827,10 +1149,18 @@ static const IpsApi pcre_api =
     nullptr,
     nullptr,
     nullptr,
+#ifdef HAVE_HYPERSCAN
+    pcre_tterm,
+#else
     nullptr,
+#endif
     pcre_ctor,
     pcre_dtor,
-    nullptr
+#ifdef HAVE_HYPERSCAN
+    pcre_verify,
+#else
+    nullptr,
+#endif
 };
 
 #ifdef BUILDING_SO
@@ -0,0 +1,356 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// ips_pcre_test.cc author Russ Combs <rucombs@cisco.com>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "detection/ips_context.h"
+#include "detection/treenodes.h"
+#include "framework/base_api.h"
+#include "framework/counts.h"
+#include "framework/cursor.h"
+#include "framework/ips_option.h"
+#include "framework/module.h"
+#include "helpers/scratch_allocator.h"
+#include "log/messages.h"
+#include "main/snort_config.h"
+#include "managers/ips_manager.h"
+#include "managers/module_manager.h"
+#include "ports/port_group.h"
+#include "profiler/profiler_defs.h"
+#include "protocols/packet.h"
+#include "utils/stats.h"
+#include "utils/util.h"
+
+// must appear after snort_config.h to avoid broken c++ map include
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+//-------------------------------------------------------------------------
+// stubs, spies, etc.
+//-------------------------------------------------------------------------
+
+namespace snort
+{
+
+void mix_str(uint32_t& a, uint32_t&, uint32_t&, const char* s, unsigned)
+{ a += strlen(s); }
+
+SnortConfig s_conf;
+THREAD_LOCAL SnortConfig* snort_conf = &s_conf;
+THREAD_LOCAL PacketCount pc;
+
+static std::vector<void *> s_state;
+static std::vector<ScratchAllocator*> s_scratchers;
+
+SnortConfig::SnortConfig(const SnortConfig* const, const char*)
+{
+    state = &s_state;
+    num_slots = 1;
+}
+
+SnortConfig::~SnortConfig() = default;
+
+int SnortConfig::request_scratch(ScratchAllocator* s)
+{
+    s_scratchers.emplace_back(s);
+    s_state.resize(s_scratchers.size());
+    return s_scratchers.size() - 1;
+}
+
+void SnortConfig::release_scratch(int) { }
+
+const SnortConfig* SnortConfig::get_conf()
+{ return snort_conf; }
+
+static IpsContext s_context;
+
+IpsContext::IpsContext(unsigned) { }
+IpsContext::~IpsContext() = default;
+
+Packet::Packet(bool)
+{
+    packet_flags = 0;
+    context = &s_context;
+}
+
+Packet::~Packet() = default;
+
+static unsigned s_parse_errors = 0;
+
+void ParseError(const char*, ...)
+{ s_parse_errors++; }
+
+void ParseWarning(WarningGroup, const char*, ...) { }
+
+unsigned get_instance_id()
+{ return 0; }
+
+char* snort_strdup(const char* s)
+{
+    char* d = (char*)snort_alloc(strlen(s) + 1);
+    return strcpy(d, s);
+}
+
+MemoryContext::MemoryContext(MemoryTracker&) { }
+MemoryContext::~MemoryContext() = default;
+
+bool TimeProfilerStats::enabled = false;
+
+Module* ModuleManager::get_module(const char*)
+{ return nullptr; }
+}
+
+const IpsApi* IpsManager::get_option_api(const char*)
+{ return nullptr; }
+
+extern const BaseApi* ips_pcre[];
+
+Cursor::Cursor(Packet* p)
+{ set("pkt_data", p->data, p->dsize); }
+
+void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
+void show_stats(PegCount*, const PegInfo*, const IndexVec&, const char*, FILE*) { }
+
+OptTreeNode::~OptTreeNode() = default;
+
+//-------------------------------------------------------------------------
+// helpers
+//-------------------------------------------------------------------------
+
+static const BaseApi* pcre_base()
+{ return ips_pcre[0]; }
+
+static const IpsApi* pcre_api()
+{ return (const IpsApi*)ips_pcre[0]; }
+
+static const Parameter* get_param(Module* m, const char* s)
+{
+    const Parameter* p = m->get_parameters();
+
+    while ( p and p->name )
+    {
+        if ( !strcmp(p->name, s) )
+            return p;
+        ++p;
+    }
+    return nullptr;
+}
+
+static IpsOption* get_option(Module* mod, const char* pat)
+{
+    mod->begin(pcre_base()->name, 0, &s_conf);
+
+    Value vs(pat);
+    vs.set(get_param(mod, "~re"));
+
+    mod->set(pcre_base()->name, vs, &s_conf);
+    mod->end(pcre_base()->name, 0, &s_conf);
+
+    OptTreeNode otn;
+    otn.sticky_buf = 0;
+
+    IpsOption::set_buffer("pkt_data");
+    return pcre_api()->ctor(mod, &otn);
+}
+
+static PegCount get_peg(Module* mod, const char* name)
+{
+    const PegInfo* pi = mod->get_pegs();
+    PegCount* pc = mod->get_counts();
+
+    for ( unsigned i = 0; pi[i].name; ++i )
+    {
+        if ( !strcmp(pi[i].name, name) )
+            return pc[i];
+    }
+    return 0;
+}
+
+static IpsOption::EvalStatus eval(IpsOption* opt, const char* data)
+{
+    // a new context for each buffer so the prefilter scans again
+    static uint64_t context_num = 0;
+
+    Packet pkt;
+    pkt.data = (const uint8_t*)data;
+    pkt.dsize = strlen(data);
+    pkt.context->conf = &s_conf;
+    pkt.context->context_num = ++context_num;
+
+    Cursor c(&pkt);
+    return opt->eval(c, &pkt);
+}
+
+//-------------------------------------------------------------------------
+// base tests
+//-------------------------------------------------------------------------
+
+TEST_GROUP(ips_pcre_base)
+{
+    void setup() override
+    { CHECK(pcre_base()); }
+};
+
+TEST(ips_pcre_base, base)
+{
+    CHECK(pcre_base()->type == PT_IPS_OPTION);
+    CHECK(!strcmp(pcre_base()->name, "pcre"));
+
+    CHECK(pcre_api()->ctor);
+    CHECK(pcre_api()->dtor);
+    CHECK(pcre_api()->verify);
+}
+
+//-------------------------------------------------------------------------
+// prefilter tests
+//
+// each pattern is built twice, once screened by the hyperscan prefilter
+// and once without it.  the prefilter may only ever skip buffers where
+// pcre_exec would not have matched anyway.
+//-------------------------------------------------------------------------
+
+static const char* const s_patterns[] =
+{
+    "\"/x/\"",
+    "\"m#x#\"",
+    "\"m!x!\"",
+    "\"/^fo+b[a-z]r$/i\"",
+};
+
+static const unsigned num_patterns = sizeof(s_patterns) / sizeof(s_patterns[0]);
+
+static const char* const s_buffers[] =
+{
+    "x",
+    "abc x def",
+    "#x#",
+    "!x!",
+    "m#x#",
+    "#",
+    "!!",
+    "no match here",
+    "FOOOBAR",
+    "fobbr",
+};
+
+TEST_GROUP(ips_pcre_prefilter)
+{
+    Module* mod = nullptr;
+    IpsOption* screened[num_patterns] = { };
+    IpsOption* plain[num_patterns] = { };
+    PegCount prefiltered = 0;
+
+    void setup() override
+    {
+        s_parse_errors = 0;
+        mod = pcre_base()->mod_ctor();
+
+        s_conf.pcre_prefilter = false;
+
+        for ( unsigned i = 0; i < num_patterns; ++i )
+            plain[i] = get_option(mod, s_patterns[i]);
+
+        s_conf.pcre_prefilter = true;
+
+        for ( unsigned i = 0; i < num_patterns; ++i )
+            screened[i] = get_option(mod, s_patterns[i]);
+
+        prefiltered = get_peg(mod, "pcre_prefilter");
+        pcre_api()->verify(&s_conf);
+        prefiltered = get_peg(mod, "pcre_prefilter") - prefiltered;
+
+        for ( auto* s : s_scratchers )
+            s->setup(&s_conf);
+    }
+
+    void teardown() override
+    {
+        for ( unsigned i = 0; i < num_patterns; ++i )
+        {
+            pcre_api()->dtor(plain[i]);
+            pcre_api()->dtor(screened[i]);
+        }
+        for ( auto* s : s_scratchers )
+            s->cleanup(&s_conf);
+
+        pcre_api()->tterm(&s_conf);
+        pcre_base()->mod_dtor(mod);
+
+        s_scratchers.clear();
+        s_state.clear();
+        s_conf.pcre_prefilter = false;
+    }
+};
+
+TEST(ips_pcre_prefilter, parse)
+{
+    LONGS_EQUAL(0, s_parse_errors);
+
+    for ( unsigned i = 0; i < num_patterns; ++i )
+    {
+        CHECK(plain[i]);
+        CHECK(screened[i]);
+    }
+    // all of them made it into the prefilter
+    LONGS_EQUAL(num_patterns, prefiltered);
+}
+
+TEST(ips_pcre_prefilter, delimiters)
+{
+    // the delimiters are not part of the pattern
+    CHECK(eval(plain[0], "x") == IpsOption::MATCH);
+    CHECK(eval(plain[1], "x") == IpsOption::MATCH);
+    CHECK(eval(plain[2], "x") == IpsOption::MATCH);
+
+    CHECK(eval(screened[0], "x") == IpsOption::MATCH);
+    CHECK(eval(screened[1], "x") == IpsOption::MATCH);
+    CHECK(eval(screened[2], "x") == IpsOption::MATCH);
+}
+
+TEST(ips_pcre_prefilter, same_as_pcre)
+{
+    for ( unsigned i = 0; i < num_patterns; ++i )
+    {
+        for ( const auto* buf : s_buffers )
+            CHECK(eval(screened[i], buf) == eval(plain[i], buf));
+    }
+}
+
+TEST(ips_pcre_prefilter, no_match)
+{
+    CHECK(eval(screened[0], "abc") == IpsOption::NO_MATCH);
+    CHECK(eval(screened[1], "##") == IpsOption::NO_MATCH);
+    CHECK(eval(screened[2], "!!") == IpsOption::NO_MATCH);
+}
+
+//-------------------------------------------------------------------------
+// main
+//-------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    MemoryLeakWarningPlugin::turnOffNewDeleteOverloads();
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
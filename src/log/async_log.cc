@@ -0,0 +1,309 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// async_log.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "async_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utils/stats.h"
+
+#ifdef UNIT_TEST
+#include <string>
+
+#include "catch/snort_catch.h"
+#endif
+
+using namespace snort;
+
+// how long the writer sleeps between passes over the queues
+static const std::chrono::milliseconds drain_interval(10);
+
+static std::mutex writer_mutex;
+static std::condition_variable writer_cv;
+static std::thread* writer = nullptr;
+
+// accepting is cleared by the writer once it has made its last pass
+static bool running = false;
+static bool accepting = false;
+static unsigned queue_size = 0;
+
+// queues opened since the writer's last pass
+static std::vector<AsyncLogQueue*> added;
+
+static std::atomic<uint64_t> bytes_written { 0 };
+static std::atomic<uint64_t> total_drops { 0 };
+static std::atomic<uint64_t> total_dropped_bytes { 0 };
+
+//-------------------------------------------------------------------------
+// queue
+//-------------------------------------------------------------------------
+
+AsyncLogQueue::AsyncLogQueue(TextLog* txt, unsigned sz) : log(txt)
+{
+    size = 1;
+
+    while ( size < sz )
+        size <<= 1;
+
+    mask = size - 1;
+    buf = new char[size];
+}
+
+AsyncLogQueue::~AsyncLogQueue()
+{
+    delete[] buf;
+}
+
+bool AsyncLogQueue::put(const char* data, unsigned len)
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+    uint64_t t = tail.load(std::memory_order_acquire);
+
+    if ( len > size - (h - t) )
+    {
+        ++drops;
+        dropped_bytes += len;
+        return false;
+    }
+
+    uint64_t off = h & mask;
+    uint64_t n = std::min((uint64_t)len, size - off);
+
+    memcpy(buf + off, data, n);
+    memcpy(buf, data + n, len - n);
+
+    head.store(h + len, std::memory_order_release);
+    return true;
+}
+
+uint64_t AsyncLogQueue::read(const char*& data)
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    uint64_t h = head.load(std::memory_order_acquire);
+    uint64_t off = t & mask;
+
+    data = buf + off;
+    return std::min(h - t, size - off);
+}
+
+void AsyncLogQueue::pop(uint64_t len)
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    tail.store(t + len, std::memory_order_release);
+}
+
+//-------------------------------------------------------------------------
+// writer
+//-------------------------------------------------------------------------
+
+void AsyncLog::writer_thread()
+{
+    std::vector<AsyncLogQueue*> queues;
+    bool done = false;
+
+    while ( !done )
+    {
+        std::unique_lock<std::mutex> lk(writer_mutex);
+        writer_cv.wait_for(lk, drain_interval, [] { return !running; });
+
+        queues.insert(queues.end(), added.begin(), added.end());
+        added.clear();
+
+        // the last pass is made holding the lock so that no queue is
+        // closed while it is being drained; afterwards, owners clean up
+        done = !running;
+
+        if ( done )
+            accepting = false;
+        else
+            lk.unlock();
+
+        auto it = queues.begin();
+
+        while ( it != queues.end() )
+        {
+            AsyncLogQueue* q = *it;
+
+            // check before draining so the final flush is written
+            bool closed = q->closed.load(std::memory_order_acquire);
+            drain(q);
+
+            if ( closed )
+            {
+                TextLog_Free(q->get_log());
+                retire(q);
+                it = queues.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+}
+
+void AsyncLog::start(unsigned buffer_size)
+{
+    std::lock_guard<std::mutex> lk(writer_mutex);
+
+    if ( writer )
+        return;
+
+    queue_size = buffer_size;
+    running = accepting = true;
+    writer = new std::thread(writer_thread);
+}
+
+// packet threads must be done with their logs before this is called
+void AsyncLog::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(writer_mutex);
+
+        if ( !writer )
+            return;
+
+        running = false;
+    }
+    writer_cv.notify_one();
+
+    writer->join();
+    delete writer;
+    writer = nullptr;
+}
+
+void AsyncLog::print_stats()
+{
+    if ( !bytes_written and !total_drops )
+        return;
+
+    LogLabel("async log");
+    LogCount("bytes written", bytes_written);
+    LogCount("drops", total_drops);
+    LogCount("dropped bytes", total_dropped_bytes);
+}
+
+AsyncLogQueue* AsyncLog::open(TextLog* txt, unsigned min_size)
+{
+    std::lock_guard<std::mutex> lk(writer_mutex);
+
+    if ( !accepting )
+        return nullptr;
+
+    AsyncLogQueue* q = new AsyncLogQueue(txt, std::max(queue_size, min_size));
+    added.emplace_back(q);
+
+    return q;
+}
+
+bool AsyncLog::close(AsyncLogQueue* q)
+{
+    std::lock_guard<std::mutex> lk(writer_mutex);
+
+    if ( !accepting )
+        return false;
+
+    q->closed.store(true, std::memory_order_release);
+    return true;
+}
+
+// each write is a contiguous chunk so at most two per wrap of the ring
+uint64_t AsyncLog::drain(AsyncLogQueue* q)
+{
+    const char* data;
+    uint64_t len;
+    uint64_t total = 0;
+
+    while ( (len = q->read(data)) )
+    {
+        TextLog_Output(q->get_log(), data, len);
+        q->pop(len);
+        total += len;
+    }
+    bytes_written += total;
+    return total;
+}
+
+void AsyncLog::retire(AsyncLogQueue* q)
+{
+    total_drops += q->drops;
+    total_dropped_bytes += q->dropped_bytes;
+    delete q;
+}
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+static std::string read_all(AsyncLogQueue& q)
+{
+    std::string s;
+    const char* data;
+    uint64_t len;
+
+    while ( (len = q.read(data)) )
+    {
+        s.append(data, len);
+        q.pop(len);
+    }
+    return s;
+}
+
+TEST_CASE("async log queue wraps", "[async_log]")
+{
+    AsyncLogQueue q(nullptr, 10);
+
+    CHECK(q.put("abcdefghij", 10));
+    CHECK(read_all(q) == "abcdefghij");
+
+    // 16 byte ring so this one wraps
+    CHECK(q.put("klmnopqrst", 10));
+
+    const char* data;
+    CHECK(q.read(data) == 6);
+    CHECK(read_all(q) == "klmnopqrst");
+    CHECK(q.read(data) == 0);
+}
+
+TEST_CASE("async log queue drops when full", "[async_log]")
+{
+    AsyncLogQueue q(nullptr, 16);
+
+    CHECK(q.put("0123456789", 10));
+    CHECK(!q.put("abcdefghij", 10));
+    CHECK(q.put("abcdef", 6));
+    CHECK(q.drops == 1);
+    CHECK(q.dropped_bytes == 10);
+
+    CHECK(read_all(q) == "0123456789abcdef");
+    CHECK(q.put("ghij", 4));
+    CHECK(read_all(q) == "ghij");
+}
+
+#endif
@@ -0,0 +1,103 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// async_log.h
+
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+// Moves TextLog file output off the packet threads.  Alerts are still
+// formatted into the TextLog buffer by the thread that owns the log but a
+// flush copies the buffer into a single producer, single consumer byte ring
+// instead of calling fwrite.  One writer thread drains all the rings and
+// does the file writes and rolls.  When a ring is full the flushed buffer is
+// dropped and counted so memory is bounded by the ring size.
+
+#include <atomic>
+#include <cstdint>
+
+struct TextLog;
+
+namespace snort
+{
+// implemented in text_log.cc
+bool TextLog_Output(TextLog*, const char*, unsigned len);
+void TextLog_Free(TextLog*);
+
+class AsyncLogQueue
+{
+public:
+    AsyncLogQueue(TextLog*, unsigned size);
+    ~AsyncLogQueue();
+
+    AsyncLogQueue(const AsyncLogQueue&) = delete;
+    AsyncLogQueue& operator=(const AsyncLogQueue&) = delete;
+
+    // called by the thread that owns the log only
+    bool put(const char*, unsigned len);
+
+    // called by the writer thread, or by the owner once the writer is gone;
+    // read returns the length of the next contiguous chunk of queued bytes
+    uint64_t read(const char*&);
+    void pop(uint64_t len);
+
+    TextLog* get_log() const
+    { return log; }
+
+    std::atomic<bool> closed { false };
+
+    // updated by the owner only
+    uint64_t drops = 0;
+    uint64_t dropped_bytes = 0;
+
+private:
+    TextLog* log;
+    char* buf;
+    uint64_t size;
+    uint64_t mask;
+
+    std::atomic<uint64_t> head { 0 };  // written by the owner
+    std::atomic<uint64_t> tail { 0 };  // written by the drainer
+};
+
+class AsyncLog
+{
+public:
+    static void start(unsigned buffer_size);
+    static void stop();
+    static void print_stats();
+
+    // returns nullptr if the writer is not running
+    static AsyncLogQueue* open(TextLog*, unsigned min_size);
+
+    // returns false if the writer is gone and the caller must drain
+    // and retire the queue itself
+    static bool close(AsyncLogQueue*);
+
+    // write everything queued to the log
+    static uint64_t drain(AsyncLogQueue*);
+
+    // count the drops and delete the queue
+    static void retire(AsyncLogQueue*);
+
+private:
+    static void writer_thread();
+};
+}
+
+#endif
+
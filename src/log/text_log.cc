@@ -38,6 +38,7 @@
 
 #include "utils/util.h"
 
+#include "async_log.h"
 #include "log.h"
 
 using namespace snort;
@@ -56,6 +57,9 @@ struct TextLog
     size_t maxFile;
     time_t last;
 
+/* set when flushes are queued for the writer thread */
+    AsyncLogQueue* queue;
+
 /* buffer attributes: */
     unsigned int pos;
     unsigned int maxBuf;
@@ -115,7 +119,7 @@ void TextLog_Reset(TextLog* const txt)
  *-------------------------------------------------------------------
  */
 TextLog* TextLog_Init(
-    const char* name, unsigned int maxBuf, size_t maxFile)
+    const char* name, unsigned int maxBuf, size_t maxFile, bool async)
 {
     TextLog* txt;
 
@@ -133,6 +137,8 @@ TextLog* TextLog_Init(
     txt->maxBuf = maxBuf;
     TextLog_Reset(txt);
 
+    txt->queue = async ? AsyncLog::open(txt, maxBuf) : nullptr;
+
     return txt;
 }
 
@@ -146,6 +152,25 @@ void TextLog_Term(TextLog* const txt)
         return;
 
     TextLog_Flush(txt);
+
+    if ( txt->queue )
+    {
+        // the writer closes and frees the log once it is drained
+        if ( AsyncLog::close(txt->queue) )
+            return;
+
+        AsyncLog::drain(txt->queue);
+        AsyncLog::retire(txt->queue);
+    }
+    TextLog_Free(txt);
+}
+
+/*-------------------------------------------------------------------
+ * TextLog_Free: close file and release without flushing
+ *-------------------------------------------------------------------
+ */
+void TextLog_Free(TextLog* const txt)
+{
     TextLog_Close(txt->file);
 
     if ( txt->name )
@@ -175,24 +200,40 @@ static void TextLog_Roll(TextLog* const txt)
 }
 
 /*-------------------------------------------------------------------
- * TextLog_Flush: write buffered stream to file
+ * TextLog_Output: write given bytes to file
  *-------------------------------------------------------------------
  */
-bool TextLog_Flush(TextLog* const txt)
+bool TextLog_Output(TextLog* const txt, const char* buf, unsigned len)
 {
-    int ok;
+    if ( txt->maxFile and txt->size + len > txt->maxFile )
+        TextLog_Roll(txt);
 
-    if ( !txt->pos )
+    if ( fwrite(buf, len, 1, txt->file) != 1 )
         return false;
 
-    if ( txt->maxFile and txt->size + txt->pos > txt->maxFile )
-        TextLog_Roll(txt);
+    txt->size += len;
+    return true;
+}
+
+/*-------------------------------------------------------------------
+ * TextLog_Flush: write buffered stream to file or writer queue
+ *-------------------------------------------------------------------
+ */
+bool TextLog_Flush(TextLog* const txt)
+{
+    if ( !txt->pos )
+        return false;
 
-    ok = fwrite(txt->buf, txt->pos, 1, txt->file);
+    if ( txt->queue )
+    {
+        // a full queue drops the buffer rather than blocking
+        bool ok = txt->queue->put(txt->buf, txt->pos);
+        TextLog_Reset(txt);
+        return ok;
+    }
 
-    if ( ok == 1 )
+    if ( TextLog_Output(txt, txt->buf, txt->pos) )
     {
-        txt->size += txt->pos;
         TextLog_Reset(txt);
         return true;
     }
@@ -137,7 +137,7 @@ FullLogger::FullLogger(FullModule* m)
 
 void FullLogger::open()
 {
-    full_log = TextLog_Init(file.c_str(), LOG_BUFFER, limit);
+    full_log = TextLog_Init(file.c_str(), LOG_BUFFER, limit, true);
 }
 
 void FullLogger::close()
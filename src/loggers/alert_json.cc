@@ -814,7 +814,7 @@ JsonLogger::JsonLogger(JsonModule* m)
 
 void JsonLogger::open()
 {
-    json_log = TextLog_Init(file.c_str(), LOG_BUFFER, limit);
+    json_log = TextLog_Init(file.c_str(), LOG_BUFFER, limit, true);
 }
 
 void JsonLogger::close()
@@ -164,26 +164,41 @@ void Analyzer::set_main_hook(MainHook_f f)
 // message processing
 //-------------------------------------------------------------------------
 
+// Bring the header and the start of the packet data of a message that is about to be
+// processed into cache.  This covers the link, network and transport headers of most
+// packets, which decode touches first.
+static inline void prefetch_daq_msg(DAQ_Msg_h msg)
+{
+    if (!msg or daq_msg_get_type(msg) != DAQ_MSG_TYPE_PACKET)
+        return;
+
+    __builtin_prefetch(daq_msg_get_pkthdr(msg));
+
+    const uint8_t* data = daq_msg_get_data(msg);
+    __builtin_prefetch(data);
+    __builtin_prefetch(data + 64);
+}
+
 static void process_daq_sof_eof_msg(DAQ_Msg_h msg, DAQ_Verdict& verdict)
 {
     const DAQ_FlowStats_t *stats = (const DAQ_FlowStats_t*) daq_msg_get_hdr(msg);
-    const char* key;
+    unsigned pub_id;
 
     if (daq_msg_get_type(msg) == DAQ_MSG_TYPE_EOF)
     {
         packet_time_update(&stats->eof_timestamp);
         daq_stats.eof_messages++;
-        key = DAQ_EOF_MSG_EVENT;
+        pub_id = DAQ_EOF_MSG_EVENT_ID;
     }
     else
     {
         packet_time_update(&stats->sof_timestamp);
         daq_stats.sof_messages++;
-        key = DAQ_SOF_MSG_EVENT;
+        pub_id = DAQ_SOF_MSG_EVENT_ID;
     }
 
     DaqMessageEvent event(msg, verdict);
-    DataBus::publish(key, event);
+    DataBus::publish(pub_id, event);
 }
 
 static bool process_packet(Packet* p)
@@ -312,7 +327,7 @@ void Analyzer::post_process_daq_pkt_msg(Packet* p)
         {
             if (p->flow->flags.trigger_detained_packet_event)
             {
-                DataBus::publish(DETAINED_PACKET_EVENT, p);
+                DataBus::publish(DETAINED_PACKET_EVENT_ID, p);
             }
         }
         else
@@ -346,7 +361,7 @@ void Analyzer::post_process_daq_pkt_msg(Packet* p)
         if (p->flow and p->flow->flags.trigger_finalize_event)
         {
             FinalizePacketEvent event(p, verdict);
-            DataBus::publish(FINALIZE_PACKET_EVENT, event);
+            DataBus::publish(FINALIZE_PACKET_EVENT_ID, event);
         }
 
         if (verdict == DAQ_VERDICT_BLOCK or verdict == DAQ_VERDICT_BLACKLIST)
@@ -418,7 +433,7 @@ void Analyzer::process_daq_msg(DAQ_Msg_h msg, bool retry)
             {
                 daq_stats.other_messages++;
                 DaqMessageEvent event(msg, verdict);
-                DataBus::publish(DAQ_OTHER_MSG_EVENT, event);
+                DataBus::publish(DAQ_OTHER_MSG_EVENT_ID, event);
             }
             break;
     }
@@ -540,7 +555,7 @@ void Analyzer::idle()
     timeradd(&now, &increment, &now);
     packet_time_update(&now);
 
-    DataBus::publish(THREAD_IDLE_EVENT, nullptr);
+    DataBus::publish(THREAD_IDLE_EVENT_ID, nullptr);
 
     // Service the retry queue with the new packet time.
     process_retry_queue();
@@ -548,6 +563,7 @@ void Analyzer::idle()
     Stream::handle_timeouts(true);
 
     HighAvailabilityManager::process_receive();
+    HighAvailabilityManager::flush();
 
     handle_uncompleted_commands();
 
@@ -675,6 +691,7 @@ void Analyzer::term()
     RateFilter_Cleanup();
 
     TraceApi::thread_term();
+    DataBus::thread_term();
 
     ModuleManager::accumulate_module("memory");
 }
@@ -831,6 +848,13 @@ DAQ_RecvStatus Analyzer::process_messages()
     // This conveniently handles servicing offloads in the no messages received case as well.
     DetectionEngine::onload();
 
+    // Start pulling in the flows of the batch so the lookups don't all miss cache.
+    {
+        const DAQ_Msg_h* msgs;
+        unsigned num = daq_instance->get_pending_messages(msgs);
+        Stream::prefetch_flows(msgs, num);
+    }
+
     unsigned num_recv = 0;
     DAQ_Msg_h msg;
     while ((msg = daq_instance->next_message()) != nullptr)
@@ -844,15 +868,28 @@ DAQ_RecvStatus Analyzer::process_messages()
             daq_instance->finalize_message(msg, DAQ_VERDICT_PASS);
             continue;
         }
+        // Start pulling in the next message while this one is processed.
+        prefetch_daq_msg(daq_instance->peek_message());
+
         // FIXIT-M reimplement fail-open capability?
         num_recv++;
         // IMPORTANT: process_daq_msg() is responsible for finalizing the messages.
         process_daq_msg(msg, false);
         DetectionEngine::onload();
+    }
+
+    // The retry queue and uncompleted commands are serviced once per batch rather than after
+    // every message.  Retries are delayed by at least the retry interval anyway and commands
+    // only need to make progress between batches.
+    if (num_recv)
+    {
         process_retry_queue();
         handle_uncompleted_commands();
     }
 
+    // Send the HA messages coalesced while processing the batch.
+    HighAvailabilityManager::flush();
+
     if (exit_after_cnt && (exit_after_cnt -= num_recv) == 0)
         stop();
     if (pause_after_cnt && (pause_after_cnt -= num_recv) == 0)
@@ -971,6 +1008,6 @@ void Analyzer::reload_daq()
 
 void Analyzer::rotate()
 {
-    DataBus::publish(THREAD_ROTATE_EVENT, nullptr);
+    DataBus::publish(THREAD_ROTATE_EVENT_ID, nullptr);
 }
 
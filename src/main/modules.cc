@@ -26,7 +26,11 @@
 
 #include <sys/resource.h>
 
+#include <lua.hpp>
+#include <sstream>
+
 #include "codecs/codec_module.h"
+#include "control/control.h"
 #include "detection/detection_module.h"
 #include "detection/fp_config.h"
 #include "detection/rules.h"
@@ -44,6 +48,7 @@
 #include "log/messages.h"
 #include "managers/module_manager.h"
 #include "managers/plugin_manager.h"
+#include "memory/memory_cap.h"
 #include "memory/memory_module.h"
 #include "packet_io/active.h"
 #include "packet_io/sfdaq_module.h"
@@ -63,6 +68,7 @@
 #include "target_based/snort_protocols.h"
 #include "trace/trace_module.h"
 
+#include "analyzer_command.h"
 #include "snort_config.h"
 #include "snort_module.h"
 #include "thread_config.h"
@@ -154,6 +160,10 @@ static const Parameter search_engine_params[] =
     { "bleedover_warnings_enabled", Parameter::PT_BOOL, nullptr, "false",
       "print warning if a rule is demoted to any-any port group" },
 
+    { "build_threads", Parameter::PT_INT, "0:max32", "0",
+      "threads used to compile search engines and option trees "
+      "(0 means one per packet thread at startup and one during reload)" },
+
     { "enable_single_rule_group", Parameter::PT_BOOL, nullptr, "false",
       "put all rules into one group" },
 
@@ -187,6 +197,10 @@ static const Parameter search_engine_params[] =
     { "offload_search_method", Parameter::PT_DYNAMIC, (void*)&get_search_methods, nullptr,
       "set fast pattern offload algorithm - choose available search engine" },
 
+    { "reload_reuse", Parameter::PT_BOOL, nullptr, "true",
+      "on reload, copy search engines with unchanged patterns from the running "
+      "config instead of compiling them (rule_db_dir is ignored when enabled)" },
+
     { "rule_db_dir", Parameter::PT_STRING, nullptr, nullptr,
       "deserialize rule databases from given directory" },
 
@@ -249,6 +263,9 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
     if ( v.is("bleedover_port_limit") )
         fp->set_bleed_over_port_limit(v.get_uint32());
 
+    else if ( v.is("build_threads") )
+        fp->set_build_threads(v.get_uint32());
+
     else if ( v.is("bleedover_warnings_enabled") )
     {
         if ( v.get_bool() )
@@ -293,6 +310,9 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("detect_raw_tcp") )
         fp->set_stream_insert(v.get_bool());
 
+    else if ( v.is("reload_reuse") )
+        fp->set_reload_reuse(v.get_bool());
+
     else if ( v.is("rule_db_dir") )
         fp->set_rule_db_dir(v.get_string());
 
@@ -358,6 +378,9 @@ static const Parameter profiler_memory_params[] =
     { "max_depth", Parameter::PT_INT, "-1:255", "-1",
       "limit depth to max_depth (-1 = no limit)" },
 
+    { "sample_interval", Parameter::PT_INT, "0:maxSZ", "0",
+      "profile about once per this many bytes allocated or freed (0 = every call)" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -401,6 +424,13 @@ static bool s_profiler_module_set_max_depth(T& config, Value& v)
 static bool s_profiler_module_set_max_depth(RuleProfilerConfig&, Value&)
 { return false; }
 
+template<typename T>
+static bool s_profiler_module_set_sample_interval(T&, Value&)
+{ return false; }
+
+static bool s_profiler_module_set_sample_interval(MemoryProfilerConfig& config, Value& v)
+{ config.sample_interval = v.get_size(); return true; }
+
 template<typename T>
 static bool s_profiler_module_set(T& config, Value& v)
 {
@@ -416,12 +446,125 @@ static bool s_profiler_module_set(T& config, Value& v)
     else if ( v.is("max_depth") )
         return s_profiler_module_set_max_depth(config, v);
 
+    else if ( v.is("sample_interval") )
+        return s_profiler_module_set_sample_interval(config, v);
+
     else
         return false;
 
     return true;
 }
 
+class ProfilerReset : public AnalyzerCommand
+{
+public:
+    bool execute(Analyzer&, void**) override
+    {
+        Profiler::reset_thread_stats();
+        return true;
+    }
+
+    const char* stringify() override { return "PROFILER_RESET"; }
+};
+
+class ProfilerDump : public AnalyzerCommand
+{
+public:
+    ProfilerDump(ControlConn* conn) : ctrlcon(conn) { }
+    ~ProfilerDump() override;
+
+    bool execute(Analyzer&, void**) override
+    {
+        Profiler::accumulate_thread_stats();
+        return true;
+    }
+
+    const char* stringify() override { return "PROFILER_DUMP"; }
+
+private:
+    ControlConn* ctrlcon;
+};
+
+ProfilerDump::~ProfilerDump()
+{
+    std::ostringstream ss;
+    Profiler::dump_stats(ss);
+    ss << "\n";
+
+    // responses are formatted into a fixed buffer
+    const std::string& s = ss.str();
+    const int chunk = STD_BUF - 1;
+
+    for ( size_t i = 0; i < s.size(); i += chunk )
+    {
+        LogRespond(ctrlcon, "%.*s", chunk, s.c_str() + i);
+    }
+}
+
+static int profiler_start(lua_State* L)
+{
+    bool modules = luaL_opt(L, lua_toboolean, 1, true);
+    bool rules = luaL_opt(L, lua_toboolean, 2, true);
+
+    Profiler::set_enabled(modules, rules);
+
+    ControlConn* ctrlcon = ControlConn::query_from_lua(L);
+    LogRespond(ctrlcon, "== profiling modules %s, rules %s\n",
+        modules ? "on" : "off", rules ? "on" : "off");
+    return 0;
+}
+
+static int profiler_stop(lua_State* L)
+{
+    Profiler::set_enabled(false, false);
+
+    ControlConn* ctrlcon = ControlConn::query_from_lua(L);
+    LogRespond(ctrlcon, "== profiling off\n");
+    return 0;
+}
+
+static int profiler_reset(lua_State* L)
+{
+    ControlConn* ctrlcon = ControlConn::query_from_lua(L);
+    main_broadcast_command(new ProfilerReset, ctrlcon);
+    return 0;
+}
+
+static int profiler_dump(lua_State* L)
+{
+    ControlConn* ctrlcon = ControlConn::query_from_lua(L);
+    main_broadcast_command(new ProfilerDump(ctrlcon), ctrlcon);
+    return 0;
+}
+
+static const Parameter profiler_start_params[] =
+{
+    { "modules", Parameter::PT_BOOL, nullptr, "true",
+      "profile module time" },
+
+    { "rules", Parameter::PT_BOOL, nullptr, "true",
+      "profile rule time" },
+
+    { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
+};
+
+static const Command profiler_cmds[] =
+{
+    { "start", profiler_start, profiler_start_params,
+      "start profiling modules and/or rules" },
+
+    { "stop", profiler_stop, nullptr,
+      "stop profiling modules and rules" },
+
+    { "reset", profiler_reset, nullptr,
+      "clear module time and rule profiles" },
+
+    { "dump", profiler_dump, nullptr,
+      "show module and rule profiles as json" },
+
+    { nullptr, nullptr, nullptr, nullptr }
+};
+
 class ProfilerModule : public Module
 {
 public:
@@ -430,6 +573,9 @@ public:
     bool set(const char*, Value&, SnortConfig*) override;
     bool end(const char*, int, SnortConfig*) override;
 
+    const Command* get_commands() const override
+    { return profiler_cmds; }
+
     ProfileStats* get_profile(unsigned, const char*&, const char*&) const override;
 
     Usage get_usage() const override
@@ -458,6 +604,7 @@ bool ProfilerModule::end(const char*, int, SnortConfig* sc)
 {
     TimeProfilerStats::set_enabled(sc->profiler->time.show);
     RuleContext::set_enabled(sc->profiler->rule.show);
+    memory::MemoryCap::set_sample_interval(sc->profiler->memory.sample_interval);
     return true;
 }
 
@@ -706,6 +853,12 @@ static const Parameter output_event_trace_params[] =
 
 static const Parameter output_params[] =
 {
+    { "async_log", Parameter::PT_BOOL, nullptr, "false",
+      "write alert files from a dedicated thread instead of the packet threads" },
+
+    { "async_log_buffer", Parameter::PT_INT, "4096:max32", "1048576",
+      "bytes queued per packet thread alert file before alerts are dropped" },
+
     { "dump_chars_only", Parameter::PT_BOOL, nullptr, "false",
       "turns on character dumps (same as -C)" },
 
@@ -773,7 +926,13 @@ public:
 
 bool OutputModule::set(const char*, Value& v, SnortConfig* sc)
 {
-    if ( v.is("dump_chars_only") )
+    if ( v.is("async_log") )
+        v.update_mask(sc->output_flags, OUTPUT_FLAG__ASYNC_LOG);
+
+    else if ( v.is("async_log_buffer") )
+        sc->async_log_buffer = v.get_uint32();
+
+    else if ( v.is("dump_chars_only") )
         v.update_mask(sc->output_flags, OUTPUT_FLAG__CHAR_DATA);
 
     else if ( v.is("dump_payload") )
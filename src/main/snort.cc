@@ -40,6 +40,7 @@
 #include "helpers/process.h"
 #include "host_tracker/host_cache.h"
 #include "ips_options/ips_options.h"
+#include "log/async_log.h"
 #include "log/log.h"
 #include "log/messages.h"
 #include "loggers/loggers.h"
@@ -158,6 +159,9 @@ void Snort::init(int argc, char** argv)
     /* Set the global snort_conf that will be used during run time */
     SnortConfig::set_conf(sc);
 
+    if ( sc->async_log() )
+        AsyncLog::start(sc->async_log_buffer);
+
     // This call must be immediately after "SnortConfig::set_conf(sc)"
     // since the first trace call may happen somewhere after this point
     TraceApi::thread_init(sc->trace_config);
@@ -428,9 +432,13 @@ void Snort::cleanup()
 
     SFDAQ::term();
     FileService::close();
+    AsyncLog::stop();
 
     if ( !SnortConfig::get_conf()->test_mode() )  // FIXIT-M ideally the check is in one place
+    {
         PrintStatistics();
+        AsyncLog::print_stats();
+    }
 
     CloseLogger();
     ThreadConfig::term();
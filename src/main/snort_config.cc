@@ -66,8 +66,11 @@
 #include "main/snort.h"
 #include "target_based/host_attributes.h"
 #include "target_based/snort_protocols.h"
+#include "time/clock_defs.h"
+#include "time/stopwatch.h"
 #include "trace/trace_config.h"
 #include "utils/dnet_header.h"
+#include "utils/stats.h"
 #include "utils/util.h"
 #include "utils/util_cstring.h"
 
@@ -290,7 +293,11 @@ void SnortConfig::setup()
     else
         thiszone = gmt2local(0);
 
+    Stopwatch<SnortClock> parse_time, verify_time;
+
     init_policies(this);
+
+    parse_time.start();
     ParseRules(this);
 
     // Allocate evalOrder before calling the OrderRuleLists
@@ -306,12 +313,19 @@ void SnortConfig::setup()
     }
 
     ParseRulesFinish(this);
+    parse_time.stop();
     ShowPolicyStats(this);
 
     /* Need to do this after dynamic detection stuff is initialized, too */
+    verify_time.start();
     IpsManager::verify(this);
+    verify_time.stop();
     ModuleManager::load_commands(policy_map->get_shell());
 
+    LogLabel("rule load time");
+    LogTime("rule parsing", clock_usecs(TO_USECS(parse_time.get())));
+    LogTime("option verification", clock_usecs(TO_USECS(verify_time.get())));
+
     fpCreateFastPacketDetection(this);
 }
 
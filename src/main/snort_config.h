@@ -101,6 +101,7 @@ enum OutputFlag
     OUTPUT_FLAG__WIDE_HEX          = 0x00000800,
 
     OUTPUT_FLAG__ALERT_REFS        = 0x00001000,
+    OUTPUT_FLAG__ASYNC_LOG         = 0x00002000,
 };
 
 enum LoggingFlag
@@ -232,6 +233,7 @@ public:
     uint32_t output_flags = 0;
 #endif
     uint32_t tagged_packet_limit = 256;
+    uint32_t async_log_buffer = 1024 * 1024;
     uint16_t event_trace_max = 0;
 
     std::string log_dir;
@@ -258,6 +260,7 @@ public:
 
     bool hyperscan_literals = false;
     bool pcre_to_regex = false;
+    bool pcre_prefilter = false;
 
     bool global_rule_state = false;
     bool global_default_rule_state = true;
@@ -597,6 +600,9 @@ public:
     bool alert_refs() const
     { return output_flags & OUTPUT_FLAG__ALERT_REFS; }
 
+    bool async_log() const
+    { return output_flags & OUTPUT_FLAG__ASYNC_LOG; }
+
     // run flags
     bool no_lock_pid_file() const
     { return run_flags & RUN_FLAG__NO_LOCK_PID_FILE; }
@@ -369,7 +369,7 @@ static const Parameter s_params[] =
       "[<module prefix>] output module defaults in Lua format" },
 
     { "--dump-rule-databases", Parameter::PT_STRING, nullptr, nullptr,
-      "dump rule databases to given directory (hyperscan only)" },
+      "dump rule databases to given directory" },
 
     { "--dump-rule-deps", Parameter::PT_IMPLIED, nullptr, nullptr,
       "dump rule dependencies in json format for use by other tools" },
@@ -135,8 +135,9 @@ Packet::Packet(bool)
 }
 Packet::~Packet()  = default;
 IpsPolicy* get_ips_policy() { return nullptr; }
-void DataBus::publish(const char*, Packet*, Flow*) { }
-void DataBus::publish(const char*, DataEvent&, Flow*) { }
+void DataBus::publish(unsigned, Packet*, Flow*) { }
+void DataBus::publish(unsigned, DataEvent&, Flow*) { }
+void DataBus::thread_term() { }
 SFDAQInstance::SFDAQInstance(const char*, unsigned, const SFDAQConfig*) { }
 SFDAQInstance::~SFDAQInstance() = default;
 void SFDAQInstance::reload() { }
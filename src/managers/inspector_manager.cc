@@ -1460,7 +1460,7 @@ void InspectorManager::bumble(Packet* p)
 {
     Flow* flow = p->flow;
 
-    DataBus::publish(FLOW_SERVICE_CHANGE_EVENT, p);
+    DataBus::publish(FLOW_SERVICE_CHANGE_EVENT_ID, p);
 
     flow->clear_clouseau();
 
@@ -1540,7 +1540,7 @@ void InspectorManager::internal_execute(Packet* p)
         return;
 
     if (!p->flow)
-        DataBus::publish(PKT_WITHOUT_FLOW_EVENT, p);
+        DataBus::publish(PKT_WITHOUT_FLOW_EVENT_ID, p);
 
     FrameworkPolicy* fp = get_inspection_policy()->framework_policy;
     assert(fp);
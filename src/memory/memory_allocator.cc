@@ -24,6 +24,8 @@
 
 #include "memory_allocator.h"
 
+#include <malloc.h>
+
 #include <cstdlib>
 
 namespace memory
@@ -36,4 +38,9 @@ void* MemoryAllocator::allocate(size_t n)
 void MemoryAllocator::deallocate(void* p)
 { free(p); }
 
+#ifdef HAVE_MALLOC_USABLE_SIZE
+size_t MemoryAllocator::usable_size(void* p)
+{ return malloc_usable_size(p); }
+#endif
+
 } // namespace memory
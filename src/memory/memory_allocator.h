@@ -30,6 +30,10 @@ struct MemoryAllocator
 {
     static void* allocate(size_t);
     static void deallocate(void*);
+
+#ifdef HAVE_MALLOC_USABLE_SIZE
+    static size_t usable_size(void*);
+#endif
 };
 
 } // namespace memory
@@ -0,0 +1,318 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// memory_arena.h
+
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+// A per thread, size class arena for objects that are allocated and freed at
+// high rates such as Flow and FlowData.  Blocks are carved from mmapped
+// chunks of a single class, each aligned on its size so a block's chunk and
+// owner are found from its address.  Requests larger than the biggest class
+// are passed through to the global operator new.
+//
+// A block freed on a thread other than its owner is pushed on the owner's
+// remote list and returned to its chunk by the owner on its next allocation
+// miss or count update, so the counts of each thread are exact.  A chunk is
+// unmapped when its last block is freed if the thread caches more than
+// cache_limit bytes and the class has other chunks with free blocks.
+//
+// Chunks don't come from the heap so the arena does not show up in heap
+// totals.  MemoryCap adds the bytes in use and cached from the arena to the
+// heap usage of the thread instead.  Sanitizer builds bypass the arena so use
+// after free is still caught.
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "main/thread.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define MEMORY_ARENA_PASSTHROUGH
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MEMORY_ARENA_PASSTHROUGH
+#endif
+#endif
+
+namespace memory
+{
+
+struct ArenaCounts
+{
+    // bytes in blocks allocated from this thread's chunks and not yet
+    // returned to them
+    int64_t in_use;
+
+    // bytes in free blocks of this thread's chunks
+    int64_t cached;
+};
+
+class MemoryArena
+{
+public:
+    static constexpr size_t granularity = 32;
+    static constexpr size_t max_size = 2048;
+    static constexpr size_t chunk_size = 256 * 1024;
+    static constexpr size_t cache_limit = 16 * chunk_size;
+    static constexpr unsigned num_classes = max_size / granularity;
+
+    static void* allocate(size_t n)
+    {
+#ifdef MEMORY_ARENA_PASSTHROUGH
+        return ::operator new(n);
+#else
+        if ( n > max_size )
+            return ::operator new(n);
+
+        unsigned c = get_class(n);
+        State& s = get_state();
+        Chunk* k = s.partial[c];
+
+        if ( !k )
+        {
+            drain(s);
+
+            if ( !(k = s.partial[c]) )
+                k = refill(s, c);
+        }
+
+        Block* b = k->free;
+        k->free = b->next;
+        ++k->live;
+
+        if ( !k->free )
+            unlink(s, k);
+
+        s.counts.cached -= class_size(c);
+        s.counts.in_use += class_size(c);
+
+        return b;
+#endif
+    }
+
+    static void deallocate(void* p, size_t n)
+    {
+#ifdef MEMORY_ARENA_PASSTHROUGH
+        UNUSED(n);
+        ::operator delete(p);
+#else
+        if ( !p )
+            return;
+
+        if ( n > max_size )
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        Block* b = static_cast<Block*>(p);
+        Chunk* k = get_chunk(b);
+        State& s = get_state();
+
+        if ( k->owner == &s )
+            release(s, k, b);
+
+        else
+        {
+            State* o = k->owner;
+            b->next = o->remote.load(std::memory_order_relaxed);
+
+            while ( !o->remote.compare_exchange_weak(
+                b->next, b, std::memory_order_release, std::memory_order_relaxed) )
+            { }
+        }
+#endif
+    }
+
+    static const ArenaCounts& get_counts()
+    {
+        State& s = get_state();
+        drain(s);
+        return s.counts;
+    }
+
+    static size_t class_size(unsigned c)
+    { return (c + 1) * granularity; }
+
+private:
+    struct Block
+    {
+        Block* next;
+    };
+
+    struct State;
+
+    // header at the start of each chunk; the first block follows it
+    struct Chunk
+    {
+        State* owner;
+        Chunk* prev;
+        Chunk* next;
+        Block* free;
+        uint32_t live;
+        uint32_t cls;
+    };
+
+    // a thread's state is never freed so that blocks freed on other threads
+    // after the owner exits still have somewhere to go
+    struct State
+    {
+        Chunk* partial[num_classes] = { };
+        std::atomic<Block*> remote { nullptr };
+        ArenaCounts counts = { };
+    };
+
+    static unsigned get_class(size_t n)
+    { return n ? (n - 1) / granularity : 0; }
+
+    static size_t first_block(unsigned c)
+    {
+        const size_t sz = class_size(c);
+        return (sizeof(Chunk) + sz - 1) / sz * sz;
+    }
+
+    static size_t chunk_capacity(unsigned c)
+    { return (chunk_size - first_block(c)) / class_size(c) * class_size(c); }
+
+    static Chunk* get_chunk(const Block* b)
+    { return reinterpret_cast<Chunk*>((uintptr_t)b & ~(uintptr_t)(chunk_size - 1)); }
+
+    static State& get_state()
+    {
+        static THREAD_LOCAL State* state = nullptr;
+
+        if ( !state )
+            state = new State;
+
+        return *state;
+    }
+
+    static void link(State& s, Chunk* k)
+    {
+        k->prev = nullptr;
+        k->next = s.partial[k->cls];
+
+        if ( k->next )
+            k->next->prev = k;
+
+        s.partial[k->cls] = k;
+    }
+
+    static void unlink(State& s, Chunk* k)
+    {
+        if ( k->prev )
+            k->prev->next = k->next;
+        else
+            s.partial[k->cls] = k->next;
+
+        if ( k->next )
+            k->next->prev = k->prev;
+    }
+
+    static void release(State& s, Chunk* k, Block* b)
+    {
+        const size_t sz = class_size(k->cls);
+
+        if ( !k->free )
+            link(s, k);
+
+        b->next = k->free;
+        k->free = b;
+        --k->live;
+
+        s.counts.cached += sz;
+        s.counts.in_use -= sz;
+
+        // keep one chunk with free blocks per class so a class that hovers
+        // around a chunk boundary doesn't map and unmap on every call
+        if ( k->live or s.counts.cached <= (int64_t)cache_limit or
+            (s.partial[k->cls] == k and !k->next) )
+            return;
+
+        unlink(s, k);
+        s.counts.cached -= chunk_capacity(k->cls);
+        munmap(k, chunk_size);
+    }
+
+    // return blocks freed by other threads to their chunks
+    static void drain(State& s)
+    {
+        if ( !s.remote.load(std::memory_order_relaxed) )
+            return;
+
+        Block* b = s.remote.exchange(nullptr, std::memory_order_acquire);
+
+        while ( b )
+        {
+            Block* next = b->next;
+            release(s, get_chunk(b), b);
+            b = next;
+        }
+    }
+
+    // map twice the size and trim so the chunk is aligned on its size
+    static Chunk* refill(State& s, unsigned c)
+    {
+        void* p = mmap(nullptr, 2 * chunk_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if ( p == MAP_FAILED )
+            throw std::bad_alloc();
+
+        uint8_t* base = static_cast<uint8_t*>(p);
+        uint8_t* chunk = reinterpret_cast<uint8_t*>(
+            ((uintptr_t)base + chunk_size - 1) & ~(uintptr_t)(chunk_size - 1));
+
+        if ( chunk > base )
+            munmap(base, chunk - base);
+
+        if ( base + chunk_size > chunk )
+            munmap(chunk + chunk_size, base + chunk_size - chunk);
+
+        const size_t sz = class_size(c);
+        const size_t first = first_block(c);
+        const size_t n = chunk_capacity(c) / sz;
+
+        Chunk* k = reinterpret_cast<Chunk*>(chunk);
+        k->owner = &s;
+        k->live = 0;
+        k->cls = c;
+        k->free = nullptr;
+
+        for ( size_t i = n; i > 0; --i )
+        {
+            Block* b = reinterpret_cast<Block*>(chunk + first + (i - 1) * sz);
+            b->next = k->free;
+            k->free = b;
+        }
+
+        link(s, k);
+        s.counts.cached += n * sz;
+
+        return k;
+    }
+};
+
+}
+
+#endif
@@ -25,6 +25,8 @@
 #include <malloc.h>
 #include <sys/resource.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <vector>
 
@@ -41,6 +43,7 @@
 #include "profiler/memory_profiler_active_context.h"
 #include "utils/stats.h"
 
+#include "memory_arena.h"
 #include "memory_config.h"
 #include "memory_module.h"
 #include "prune_handler.h"
@@ -53,6 +56,8 @@ namespace memory
 static MemoryCounts ctl_mem_stats;
 static std::vector<MemoryCounts> pkt_mem_stats;
 
+static std::atomic<size_t> sample_interval { 0 };
+
 namespace
 {
 
@@ -60,6 +65,97 @@ namespace
 // helpers
 // -----------------------------------------------------------------------------
 
+static MemoryCounts& get_thread_stats()
+{
+    if ( !is_packet_thread() )
+        return ctl_mem_stats;
+
+    auto id = get_instance_id();
+    return pkt_mem_stats[id];
+}
+
+#ifdef ENABLE_MEMORY_OVERLOADS
+// allocations are tallied here and added to the thread's MemoryCounts in
+// batches so the hot path does not look up the thread's stats on each call;
+// max_in_use is only checked when a batch is added
+struct PendingCounts
+{
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t allocated;
+    uint64_t deallocated;
+};
+
+static THREAD_LOCAL PendingCounts pending;
+static constexpr uint64_t batch_size = 64 * 1024;
+
+static void add_pending(MemoryCounts& mc)
+{
+    mc.allocated += pending.allocated;
+    mc.allocations += pending.allocations;
+
+    // std::thread causes an extra deallocation in packet
+    // threads so deallocated can't be allowed to pass allocated
+    uint64_t in_use = mc.allocated - mc.deallocated;
+
+    if ( pending.deallocated > in_use )
+        pending.deallocated = in_use;
+
+    mc.deallocated += pending.deallocated;
+    mc.deallocations += pending.deallocations;
+
+    in_use -= pending.deallocated;
+
+    if ( in_use > mc.max_in_use )
+        mc.max_in_use = in_use;
+
+    pending = { };
+}
+#endif
+
+#ifdef ENABLE_MEMORY_PROFILER
+// byte countdowns to the next sample; each sample stands for the interval
+// bytes and for as many calls of its size as fit in those bytes
+static THREAD_LOCAL int64_t alloc_countdown;
+static THREAD_LOCAL int64_t dealloc_countdown;
+
+static bool sample(int64_t& countdown, size_t n, size_t& bytes, uint64_t& calls)
+{
+    size_t interval = sample_interval.load(std::memory_order_relaxed);
+
+    if ( !interval )
+    {
+        bytes = n;
+        calls = 1;
+        return true;
+    }
+
+    countdown -= n;
+
+    if ( countdown > 0 )
+        return false;
+
+    uint64_t k = 1 + (uint64_t)(-countdown) / interval;
+    countdown += k * interval;
+
+    bytes = k * interval;
+    calls = n ? std::max(bytes / n, (size_t)1) : k;
+    return true;
+}
+#endif
+
+// flows and flow data come from the arena instead of the heap; cached
+// blocks are still mapped so they count too
+static size_t get_arena_usage(MemoryCounts& mc)
+{
+    const ArenaCounts& ac = MemoryArena::get_counts();
+
+    mc.arena_in_use = ac.in_use > 0 ? ac.in_use : 0;
+    mc.arena_cached = ac.cached > 0 ? ac.cached : 0;
+
+    return mc.arena_in_use + mc.arena_cached;
+}
+
 #ifdef HAVE_JEMALLOC
 static size_t get_usage(MemoryCounts& mc)
 {
@@ -76,26 +172,28 @@ static size_t get_usage(MemoryCounts& mc)
     mc.allocated = *alloc_ptr;
     mc.deallocated = *dealloc_ptr;
 
+    size_t usage = get_arena_usage(mc);
+
     if ( mc.allocated > mc.deallocated )
-    {
-        size_t usage =  mc.allocated - mc.deallocated;
+        usage += mc.allocated - mc.deallocated;
 
-        if ( usage > mc.max_in_use )
-            mc.max_in_use = usage;
+    if ( usage > mc.max_in_use )
+        mc.max_in_use = usage;
 
-        return usage;
-    }
-    return 0;
+    return usage;
 }
 #else
-static size_t get_usage(const MemoryCounts& mc)
+static size_t get_usage(MemoryCounts& mc)
 {
+    size_t arena_usage = get_arena_usage(mc);
+
 #ifdef ENABLE_MEMORY_OVERLOADS
+    add_pending(mc);
     assert(mc.allocated >= mc.deallocated);
-    return mc.allocated - mc.deallocated;
+    return mc.allocated - mc.deallocated + arena_usage;
 
 #else
-    UNUSED(mc);
+    UNUSED(arena_usage);
     return 0;
 #endif
 }
@@ -147,13 +245,18 @@ void MemoryCap::cleanup()
 
 MemoryCounts& MemoryCap::get_mem_stats()
 {
-    if ( !is_packet_thread() )
-        return ctl_mem_stats;
+    MemoryCounts& mc = get_thread_stats();
 
-    auto id = get_instance_id();
-    return pkt_mem_stats[id];
+#ifdef ENABLE_MEMORY_OVERLOADS
+    add_pending(mc);
+#endif
+
+    return mc;
 }
 
+void MemoryCap::set_sample_interval(size_t n)
+{ sample_interval.store(n, std::memory_order_relaxed); }
+
 void MemoryCap::free_space()
 {
     assert(is_packet_thread());
@@ -167,42 +270,35 @@ void MemoryCap::free_space()
 #ifdef ENABLE_MEMORY_OVERLOADS
 void MemoryCap::allocate(size_t n)
 {
-    MemoryCounts& mc = memory::MemoryCap::get_mem_stats();
+    pending.allocated += n;
+    ++pending.allocations;
 
-    mc.allocated += n;
-    ++mc.allocations;
-
-    assert(mc.allocated >= mc.deallocated);
-    auto in_use = mc.allocated - mc.deallocated;
-
-    if ( in_use > mc.max_in_use )
-        mc.max_in_use = in_use;
+    if ( pending.allocated >= batch_size )
+        add_pending(get_thread_stats());
 
 #ifdef ENABLE_MEMORY_PROFILER
-    mp_active_context.update_allocs(n);
+    size_t bytes;
+    uint64_t calls;
+
+    if ( sample(alloc_countdown, n, bytes, calls) )
+        mp_active_context.update_allocs(bytes, calls);
 #endif
 }
 
 void MemoryCap::deallocate(size_t n)
 {
-    MemoryCounts& mc = memory::MemoryCap::get_mem_stats();
+    pending.deallocated += n;
+    ++pending.deallocations;
 
-    // std::thread causes an extra deallocation in packet
-    // threads so the below asserts don't hold
-    if ( mc.allocated >= mc.deallocated + n )
-    {
-        mc.deallocated += n;
-        ++mc.deallocations;
-    }
-
-#if 0
-    assert(mc.deallocated <= mc.allocated);
-    assert(mc.deallocations <= mc.allocations);
-    assert(mc.allocated or !mc.allocations);
-#endif
+    if ( pending.deallocated >= batch_size )
+        add_pending(get_thread_stats());
 
 #ifdef ENABLE_MEMORY_PROFILER
-    mp_active_context.update_deallocs(n);
+    size_t bytes;
+    uint64_t calls;
+
+    if ( sample(dealloc_countdown, n, bytes, calls) )
+        mp_active_context.update_deallocs(bytes, calls);
 #endif
 }
 #endif
@@ -40,6 +40,8 @@ struct MemoryCounts
     PegCount reap_attempts;
     PegCount reap_failures;
     PegCount max_in_use;
+    PegCount arena_in_use;
+    PegCount arena_cached;
 };
 
 class SO_PUBLIC MemoryCap
@@ -53,8 +55,12 @@ public:
     // call from main thread
     static void print(bool verbose, bool print_all = true);
 
+    // includes any allocations not yet added for this thread
     static MemoryCounts& get_mem_stats();
 
+    // profile about once per n bytes allocated or freed (0 = every call)
+    static void set_sample_interval(size_t n);
+
 #ifdef ENABLE_MEMORY_OVERLOADS
     static void allocate(size_t);
     static void deallocate(size_t);
@@ -183,6 +183,44 @@ void Interface<Allocator, Cap>::deallocate(void* p)
 template<typename Allocator, typename Cap>
 THREAD_LOCAL bool Interface<Allocator, Cap>::in_allocation_call = false;
 
+// When the heap can report the size of a block no header is needed.  The
+// usable size may be more than was requested but it is the same when the
+// block is freed so the accounting balances, and it includes the slack.
+template<typename Allocator = MemoryAllocator, typename Cap = MemoryCap>
+struct SizedInterface
+{
+    static void* allocate(size_t);
+    static void deallocate(void*);
+};
+
+template<typename Allocator, typename Cap>
+void* SizedInterface<Allocator, Cap>::allocate(size_t n)
+{
+    auto p = Allocator::allocate(n);
+
+    if ( !p )
+        return nullptr;
+
+    Cap::allocate(Allocator::usable_size(p));
+    return p;
+}
+
+template<typename Allocator, typename Cap>
+void SizedInterface<Allocator, Cap>::deallocate(void* p)
+{
+    if ( !p )
+        return;
+
+    Cap::deallocate(Allocator::usable_size(p));
+    Allocator::deallocate(p);
+}
+
+#ifdef HAVE_MALLOC_USABLE_SIZE
+using Manager = SizedInterface<>;
+#else
+using Manager = Interface<>;
+#endif
+
 } //namespace memory
 
 // -----------------------------------------------------------------------------
@@ -194,7 +232,7 @@ THREAD_LOCAL bool Interface<Allocator, Cap>::in_allocation_call = false;
 #ifdef ENABLE_MEMORY_OVERLOADS
 void* operator new(size_t n)
 {
-    auto p = memory::Interface<>::allocate(n);
+    auto p = memory::Manager::allocate(n);
     if ( !p )
         throw std::bad_alloc();
 
@@ -205,13 +243,13 @@ void* operator new[](size_t n)
 { return ::operator new(n); }
 
 void* operator new(size_t n, const std::nothrow_t&) noexcept
-{ return memory::Interface<>::allocate(n); }
+{ return memory::Manager::allocate(n); }
 
 void* operator new[](size_t n, const std::nothrow_t&) noexcept
-{ return memory::Interface<>::allocate(n); }
+{ return memory::Manager::allocate(n); }
 
 void operator delete(void* p) noexcept
-{ memory::Interface<>::deallocate(p); }
+{ memory::Manager::deallocate(p); }
 
 void operator delete[](void* p) noexcept
 { ::operator delete(p); }
@@ -246,6 +284,9 @@ struct AllocatorSpy
     static void deallocate(void* p)
     { deallocate_called = true; deallocate_arg = p; }
 
+    static size_t usable_size(void*)
+    { return usable_arg; }
+
     static void reset()
     {
         pool = nullptr;
@@ -253,6 +294,7 @@ struct AllocatorSpy
         allocate_arg = 0;
         deallocate_called = false;
         deallocate_arg = nullptr;
+        usable_arg = 0;
     }
 
     static void* pool;
@@ -260,6 +302,7 @@ struct AllocatorSpy
     static size_t allocate_arg;
     static bool deallocate_called;
     static void* deallocate_arg;
+    static size_t usable_arg;
 };
 
 void* AllocatorSpy::pool = nullptr;
@@ -267,6 +310,7 @@ bool AllocatorSpy::allocate_called = false;
 size_t AllocatorSpy::allocate_arg = 0;
 bool AllocatorSpy::deallocate_called = false;
 void* AllocatorSpy::deallocate_arg = nullptr;
+size_t AllocatorSpy::usable_arg = 0;
 
 struct CapSpy
 {
@@ -410,5 +454,53 @@ TEST_CASE( "memory manager interface", "[memory]" )
     AllocatorSpy::deallocate_arg = nullptr;
 }
 
+TEST_CASE( "memory manager sized interface", "[memory]" )
+{
+    using namespace t_memory;
+
+    AllocatorSpy::reset();
+    CapSpy::reset();
+
+    char pool[16];
+    AllocatorSpy::usable_arg = sizeof(pool);
+
+    using Interface = memory::SizedInterface<AllocatorSpy, CapSpy>;
+
+    SECTION( "allocation failure" )
+    {
+        auto p = Interface::allocate(1);
+
+        CHECK( p == nullptr );
+        CHECK( AllocatorSpy::allocate_called );
+        CHECK_FALSE( CapSpy::update_allocations_called );
+    }
+
+    SECTION( "allocation" )
+    {
+        AllocatorSpy::pool = pool;
+
+        auto p = Interface::allocate(1);
+
+        CHECK( p == (void*)pool );
+        CHECK( AllocatorSpy::allocate_arg == 1 );
+        CHECK( CapSpy::update_allocations_called );
+        CHECK( CapSpy::update_allocations_arg == sizeof(pool) );
+    }
+
+    SECTION( "deallocation" )
+    {
+        Interface::deallocate(nullptr);
+        CHECK_FALSE( AllocatorSpy::deallocate_called );
+
+        Interface::deallocate(pool);
+
+        CHECK( AllocatorSpy::deallocate_arg == (void*)pool );
+        CHECK( CapSpy::update_deallocations_called );
+        CHECK( CapSpy::update_deallocations_arg == sizeof(pool) );
+    }
+    AllocatorSpy::pool = nullptr;
+    AllocatorSpy::deallocate_arg = nullptr;
+}
+
 #endif
 
@@ -61,6 +61,8 @@ const PegInfo mem_pegs[] =
     { CountType::NOW, "reap_attempts", "attempts to reclaim memory" },
     { CountType::NOW, "reap_failures", "failures to reclaim memory" },
     { CountType::MAX, "max_in_use", "highest allocated - deallocated" },
+    { CountType::NOW, "arena_in_use", "bytes of flows and flow data in use from the arena" },
+    { CountType::NOW, "arena_cached", "bytes of free arena blocks held for reuse" },
     { CountType::END, nullptr, nullptr }
 };
 
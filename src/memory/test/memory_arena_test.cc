@@ -0,0 +1,167 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// memory_arena_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "memory/memory_arena.h"
+
+using namespace memory;
+
+#ifndef MEMORY_ARENA_PASSTHROUGH
+
+TEST_CASE("blocks are reused by size class", "[memory_arena]")
+{
+    ArenaCounts before = MemoryArena::get_counts();
+
+    void* p = MemoryArena::allocate(40);
+    CHECK(MemoryArena::get_counts().in_use == before.in_use + 64);
+
+    MemoryArena::deallocate(p, 40);
+    CHECK(MemoryArena::get_counts().in_use == before.in_use);
+
+    // 33 to 64 bytes share a class
+    void* q = MemoryArena::allocate(64);
+    CHECK(q == p);
+
+    void* r = MemoryArena::allocate(65);
+    CHECK(r != p);
+
+    MemoryArena::deallocate(q, 64);
+    MemoryArena::deallocate(r, 65);
+
+    ArenaCounts after = MemoryArena::get_counts();
+    CHECK(after.in_use == before.in_use);
+    CHECK(after.cached >= before.cached);
+}
+
+TEST_CASE("blocks are aligned and distinct", "[memory_arena]")
+{
+    std::vector<uint8_t*> v;
+
+    // more than one chunk of the smallest class
+    const unsigned n = 2 * MemoryArena::chunk_size / MemoryArena::granularity;
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        uint8_t* p = (uint8_t*)MemoryArena::allocate(MemoryArena::granularity);
+        CHECK(((uintptr_t)p % alignof(max_align_t)) == 0);
+        memset(p, i, MemoryArena::granularity);
+        v.emplace_back(p);
+    }
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        CHECK(v[i][0] == (uint8_t)i);
+        CHECK(v[i][MemoryArena::granularity - 1] == (uint8_t)i);
+        MemoryArena::deallocate(v[i], MemoryArena::granularity);
+    }
+}
+
+TEST_CASE("large requests bypass the arena", "[memory_arena]")
+{
+    ArenaCounts before = MemoryArena::get_counts();
+
+    void* p = MemoryArena::allocate(MemoryArena::max_size + 1);
+    CHECK(MemoryArena::get_counts().in_use == before.in_use);
+    CHECK(MemoryArena::get_counts().cached == before.cached);
+
+    MemoryArena::deallocate(p, MemoryArena::max_size + 1);
+}
+
+TEST_CASE("counts are per thread", "[memory_arena]")
+{
+    ArenaCounts before = MemoryArena::get_counts();
+    int64_t other = 0;
+
+    std::thread t([&other]()
+    {
+        void* p = MemoryArena::allocate(100);
+        other = MemoryArena::get_counts().in_use;
+        MemoryArena::deallocate(p, 100);
+    });
+    t.join();
+
+    CHECK(other == 128);
+    CHECK(MemoryArena::get_counts().in_use == before.in_use);
+}
+
+TEST_CASE("blocks freed on another thread return to the owner", "[memory_arena]")
+{
+    void* p = MemoryArena::allocate(100);
+    ArenaCounts before = MemoryArena::get_counts();
+    ArenaCounts other = { };
+
+    std::thread t([&other, p]()
+    {
+        MemoryArena::deallocate(p, 100);
+        other = MemoryArena::get_counts();
+    });
+    t.join();
+
+    CHECK(other.in_use == 0);
+    CHECK(other.cached == 0);
+
+    // the owner picks up the block on its next count update
+    ArenaCounts after = MemoryArena::get_counts();
+    CHECK(after.in_use == before.in_use - 128);
+    CHECK(after.cached == before.cached + 128);
+
+    void* q = MemoryArena::allocate(100);
+    CHECK(q == p);
+    MemoryArena::deallocate(q, 100);
+}
+
+TEST_CASE("empty chunks above the cache limit are unmapped", "[memory_arena]")
+{
+    std::vector<void*> v;
+
+    const unsigned per_chunk = MemoryArena::chunk_size / MemoryArena::max_size;
+    const unsigned n = 2 * per_chunk * (MemoryArena::cache_limit / MemoryArena::chunk_size);
+
+    for ( unsigned i = 0; i < n; ++i )
+        v.emplace_back(MemoryArena::allocate(MemoryArena::max_size));
+
+    CHECK(MemoryArena::get_counts().in_use >= (int64_t)(2 * MemoryArena::cache_limit));
+
+    for ( auto p : v )
+        MemoryArena::deallocate(p, MemoryArena::max_size);
+
+    ArenaCounts after = MemoryArena::get_counts();
+    CHECK(after.cached <= (int64_t)(MemoryArena::cache_limit + MemoryArena::chunk_size));
+}
+
+#else
+
+TEST_CASE("sanitizer builds use the heap", "[memory_arena]")
+{
+    void* p = MemoryArena::allocate(40);
+    CHECK(p);
+    CHECK(MemoryArena::get_counts().in_use == 0);
+    MemoryArena::deallocate(p, 40);
+}
+
+#endif
@@ -53,6 +53,7 @@
 using namespace snort;
 
 unsigned AppIdSession::inspector_id = 0;
+unsigned AppIdSession::pub_id = DATA_BUS_INVALID_ID;
 std::mutex AppIdSession::inferred_svcs_lock;
 uint16_t AppIdSession::inferred_svcs_ver = 0;
 
@@ -1142,7 +1143,7 @@ void AppIdSession::publish_appid_event(AppidChangeBits& change_bits, const Packe
         return;
 
     AppidEvent app_event(change_bits, is_http2, http2_stream_index, api, p);
-    DataBus::publish(APPID_EVENT_ANY_CHANGE, app_event, p.flow);
+    DataBus::publish(pub_id, app_event, p.flow);
     if (appidDebug->is_active())
     {
         std::string str;
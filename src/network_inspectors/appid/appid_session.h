@@ -298,9 +298,14 @@ public:
 
     bool in_expected_cache = false;
     static unsigned inspector_id;
+    static unsigned pub_id;
     static std::mutex inferred_svcs_lock;
 
-    static void init() { inspector_id = FlowData::create_flow_data_id(); }
+    static void init()
+    {
+        inspector_id = FlowData::create_flow_data_id();
+        pub_id = snort::DataBus::get_id(APPID_EVENT_ANY_CHANGE);
+    }
 
     void set_session_flags(uint64_t set_flags) { flags |= set_flags; }
     void clear_session_flags(uint64_t clear_flags) { flags &= ~clear_flags; }
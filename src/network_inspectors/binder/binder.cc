@@ -448,7 +448,7 @@ void Stuff::apply_service(Flow& flow)
             if (flow.ssn_state.snort_protocol_id == UNKNOWN_PROTOCOL_ID)
                 flow.ssn_state.snort_protocol_id = gadget->get_service();
 
-            DataBus::publish(SERVICE_INSPECTOR_CHANGE_EVENT, DetectionEngine::get_current_packet());
+            DataBus::publish(SERVICE_INSPECTOR_CHANGE_EVENT_ID, DetectionEngine::get_current_packet());
         }
     }
     else if (wizard)
@@ -755,7 +755,7 @@ void Binder::handle_flow_service_change(Flow& flow)
 
                     flow.set_data(data);
                 }
-                DataBus::publish(SERVICE_INSPECTOR_CHANGE_EVENT, DetectionEngine::get_current_packet());
+                DataBus::publish(SERVICE_INSPECTOR_CHANGE_EVENT_ID, DetectionEngine::get_current_packet());
             }
             else
                 flow.ssn_state.snort_protocol_id = UNKNOWN_PROTOCOL_ID;
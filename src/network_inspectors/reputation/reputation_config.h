@@ -24,10 +24,13 @@
 #include "main/thread.h"
 #include "sfrt/sfrt_flat.h"
 
+#include <memory>
 #include <vector>
 #include <set>
 #include <string>
 
+#include "reputation_image.h"
+
 #define NUM_INDEX_PER_ENTRY 4
 
 // Configuration for reputation network inspector
@@ -87,8 +90,11 @@ struct ReputationConfig
     AllowAction allow_action = DO_NOT_BLOCK;
     std::string blocklist_path;
     std::string allowlist_path;
+    std::string image_path;
     bool memcap_reached = false;
     uint8_t* reputation_segment = nullptr;
+    std::shared_ptr<ReputationImage> image;
+    uint64_t list_fingerprint = 0;
     table_flat_t* ip_list = nullptr;
     ListFiles list_files;
     std::string list_dir;
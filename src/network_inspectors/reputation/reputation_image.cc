@@ -0,0 +1,272 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_image.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "reputation_image.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "log/messages.h"
+#include "utils/util.h"
+
+using namespace snort;
+
+// file layout:
+//   header
+//   padding to data_offset
+//   data_size bytes of segment starting with the table_flat_t
+
+#define IMAGE_MAGIC   0x50455253  // "SREP", reads differently if byte swapped
+#define IMAGE_VERSION 1
+#define DATA_OFFSET   4096
+
+struct ImageHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fingerprint;
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint32_t num_entries;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ImageHeader) <= DATA_OFFSET, "image header must fit before data");
+
+// mappings shared by path; an entry is reused only if the file is unchanged
+static std::map<std::string, std::weak_ptr<ReputationImage>> images;
+static std::mutex images_mutex;
+
+static int64_t get_mtime(const struct stat& st)
+{ return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec; }
+
+// the lookups follow the offsets in the table without checking them so
+// every offset reachable from the table must be checked before it is used
+
+static const int rt_dims[] = { 16, 8, 4, 4 };
+static const int rt6_dims[] = { 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8 };
+
+static bool in_range(uint64_t offset, uint64_t len, uint64_t size)
+{ return offset <= size and len <= size - offset; }
+
+static bool valid_sub_table(const uint8_t* base, uint64_t size, const table_flat_t* table,
+    const dir_table_flat_t* root, int depth, MEM_OFFSET sub_ptr, std::set<MEM_OFFSET>& seen)
+{
+    // each sub table is referenced once so a repeat is a loop or a bomb
+    if ( !in_range(sub_ptr, sizeof(dir_sub_table_flat_t), size) or !seen.insert(sub_ptr).second )
+        return false;
+
+    const dir_sub_table_flat_t* sub = (const dir_sub_table_flat_t*)(base + sub_ptr);
+
+    if ( sub->width != root->dimensions[depth] or sub->num_entries != 1 << sub->width or
+        !in_range(sub->entries, (uint64_t)sizeof(DIR_Entry) * sub->num_entries, size) )
+        return false;
+
+    const DIR_Entry* entry = (const DIR_Entry*)(base + sub->entries);
+
+    for ( int i = 0; i < sub->num_entries; ++i )
+    {
+        // a zero length with a value is a sub table, else an index into data
+        if ( !entry[i].value or entry[i].length )
+        {
+            if ( entry[i].value >= table->num_ent )
+                return false;
+        }
+        else if ( depth + 1 >= root->dim_size or
+            !valid_sub_table(base, size, table, root, depth + 1, entry[i].value, seen) )
+            return false;
+    }
+    return true;
+}
+
+static bool valid_dir(const uint8_t* base, uint64_t size, const table_flat_t* table,
+    TABLE_PTR rt, const int* dims, int n)
+{
+    if ( !in_range(rt, sizeof(dir_table_flat_t), size) )
+        return false;
+
+    const dir_table_flat_t* root = (const dir_table_flat_t*)(base + rt);
+
+    // sfrt_flat_dir8x_lookup() assumes the DIR_8x16 dimensions
+    if ( root->dim_size != n or !std::equal(dims, dims + n, root->dimensions) )
+        return false;
+
+    std::set<MEM_OFFSET> seen;
+    return valid_sub_table(base, size, table, root, 0, root->sub_table, seen);
+}
+
+static bool valid_table(const table_flat_t* table, uint64_t size)
+{
+    if ( size < sizeof(*table) or table->table_flat_type != DIR_8x16 )
+        return false;
+
+    if ( table->list_info >= size or table->allocated > size or
+        !table->num_ent or table->num_ent > table->max_size or
+        !in_range(table->data, (uint64_t)sizeof(INFO) * table->max_size, size) )
+        return false;
+
+    const uint8_t* base = (const uint8_t*)table;
+    const INFO* data = (const INFO*)(base + table->data);
+
+    for ( uint32_t i = 0; i < table->num_ent; ++i )
+    {
+        if ( data[i] >= size )
+            return false;
+    }
+
+    return valid_dir(base, size, table, table->rt, rt_dims, sizeof(rt_dims) / sizeof(int)) and
+        valid_dir(base, size, table, table->rt6, rt6_dims, sizeof(rt6_dims) / sizeof(int));
+}
+
+ReputationImage::~ReputationImage()
+{
+    if ( map )
+        munmap(map, map_size);
+}
+
+std::shared_ptr<ReputationImage> ReputationImage::load(const char* path, uint64_t fingerprint)
+{
+    std::lock_guard<std::mutex> lock(images_mutex);
+
+    int fd = open(path, O_RDONLY);
+
+    if ( fd < 0 )
+        return nullptr;
+
+    struct stat st;
+
+    if ( fstat(fd, &st) )
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    auto it = images.find(path);
+
+    if ( it != images.end() )
+    {
+        std::shared_ptr<ReputationImage> image = it->second.lock();
+
+        if ( image and image->dev == st.st_dev and image->ino == st.st_ino and
+            image->mtime == get_mtime(st) and image->map_size == (size_t)st.st_size )
+        {
+            close(fd);
+
+            const ImageHeader* hdr = (const ImageHeader*)image->map;
+            return hdr->fingerprint == fingerprint ? image : nullptr;
+        }
+    }
+
+    if ( (size_t)st.st_size < DATA_OFFSET )
+    {
+        close(fd);
+        WarningMessage("reputation: %s is not a reputation image\n", path);
+        return nullptr;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if ( p == MAP_FAILED )
+    {
+        WarningMessage("reputation: can't map %s: %s\n", path, get_error(errno));
+        return nullptr;
+    }
+
+    std::shared_ptr<ReputationImage> image(new ReputationImage);
+    image->map = (uint8_t*)p;
+    image->map_size = st.st_size;
+    image->dev = st.st_dev;
+    image->ino = st.st_ino;
+    image->mtime = get_mtime(st);
+
+    const ImageHeader* hdr = (const ImageHeader*)p;
+
+    if ( hdr->magic != IMAGE_MAGIC or hdr->version != IMAGE_VERSION or
+        hdr->data_offset != DATA_OFFSET or
+        hdr->data_size > image->map_size - hdr->data_offset or
+        !valid_table((const table_flat_t*)(image->map + hdr->data_offset), hdr->data_size) )
+    {
+        WarningMessage("reputation: %s is not a valid reputation image\n", path);
+        return nullptr;
+    }
+
+    if ( hdr->fingerprint != fingerprint )
+        return nullptr;
+
+    image->data_offset = hdr->data_offset;
+    image->data_size = hdr->data_size;
+    image->num_entries = hdr->num_entries;
+    images[path] = image;
+
+    return image;
+}
+
+bool ReputationImage::save(const char* path, uint64_t fingerprint, uint32_t num_entries,
+    const uint8_t* segment, size_t size)
+{
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "wb");
+
+    if ( !fp )
+    {
+        WarningMessage("reputation: can't create %s: %s\n", tmp.c_str(), get_error(errno));
+        return false;
+    }
+
+    uint8_t head[DATA_OFFSET] = { };
+    ImageHeader* hdr = (ImageHeader*)head;
+
+    hdr->magic = IMAGE_MAGIC;
+    hdr->version = IMAGE_VERSION;
+    hdr->fingerprint = fingerprint;
+    hdr->data_offset = DATA_OFFSET;
+    hdr->data_size = size;
+    hdr->num_entries = num_entries;
+
+    bool ok = fwrite(head, sizeof(head), 1, fp) == 1 and
+        fwrite(segment, size, 1, fp) == 1;
+
+    if ( fclose(fp) )
+        ok = false;
+
+    if ( !ok or rename(tmp.c_str(), path) )
+    {
+        WarningMessage("reputation: can't write %s: %s\n", path, get_error(errno));
+        unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
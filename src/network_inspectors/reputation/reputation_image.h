@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_image.h
+
+#ifndef REPUTATION_IMAGE_H
+#define REPUTATION_IMAGE_H
+
+// A compiled reputation table.  The sfrt_flat segment only holds offsets so
+// the used part of it is written to a file as is and mapped read only on
+// load with no parsing.  The fingerprint identifies the lists the table was
+// built from so a stale image is not used.
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "sfrt/sfrt_flat.h"
+
+class ReputationImage
+{
+public:
+    ~ReputationImage();
+
+    table_flat_t* get_table() const
+    { return (table_flat_t*)(map + data_offset); }
+
+    uint32_t get_num_entries() const
+    { return num_entries; }
+
+    size_t get_size() const
+    { return map_size; }
+
+    // bytes of the segment starting with the table
+    size_t get_data_size() const
+    { return data_size; }
+
+    // returns null if path is missing, malformed or built from other lists.
+    // configs that load the same unchanged file share one mapping.
+    static std::shared_ptr<ReputationImage> load(const char* path, uint64_t fingerprint);
+
+    // writes the first size bytes of a segment with the table at offset 0.
+    // the file is replaced by rename so current mappings remain valid.
+    static bool save(const char* path, uint64_t fingerprint, uint32_t num_entries,
+        const uint8_t* segment, size_t size);
+
+private:
+    ReputationImage() = default;
+
+    uint8_t* map = nullptr;
+    size_t map_size = 0;
+    size_t data_offset = 0;
+    size_t data_size = 0;
+    uint32_t num_entries = 0;
+
+    dev_t dev = 0;
+    ino_t ino = 0;
+    int64_t mtime = 0;
+};
+
+#endif
+
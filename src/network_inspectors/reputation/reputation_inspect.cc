@@ -519,6 +519,13 @@ Reputation::Reputation(ReputationConfig* pc)
         read_manifest(MANIFEST_FILENAME, conf);
 
     add_block_allow_List(conf);
+
+    if ( !conf->image_path.empty() and ip_list_load_image(conf) )
+    {
+        reputationstats.memory_allocated = sfrt_flat_usage(conf->ip_list);
+        return;
+    }
+
     estimate_num_entries(conf);
     if (conf->num_entries <= 0)
     {
@@ -541,6 +548,7 @@ void Reputation::show(const SnortConfig*) const
     ConfigLogger::log_flag("scan_local", config.scanlocal);
     ConfigLogger::log_value("allow (action)", to_string(config.allow_action));
     ConfigLogger::log_value("allowlist", config.allowlist_path.c_str());
+    ConfigLogger::log_value("image", config.image_path.c_str());
 }
 
 void Reputation::eval(Packet* p)
@@ -75,6 +75,9 @@ static const Parameter s_params[] =
     { "allowlist", Parameter::PT_STRING, nullptr, nullptr,
       "allowlist file name with IP lists" },
 
+    { "image", Parameter::PT_STRING, nullptr, nullptr,
+      "compiled IP lists file; mapped if current, else built from the lists" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -144,6 +147,9 @@ bool ReputationModule::set(const char*, Value& v, SnortConfig*)
     else if ( v.is("allowlist") )
         conf->allowlist_path = v.get_string();
 
+    else if ( v.is("image") )
+        conf->image_path = v.get_string();
+
     return true;
 }
 
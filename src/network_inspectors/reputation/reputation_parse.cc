@@ -24,6 +24,7 @@
 #include "reputation_parse.h"
 
 #include <netinet/in.h>
+#include <sys/stat.h>
 
 #include <cassert>
 #include <climits>
@@ -77,6 +78,7 @@ unsigned long total_invalids;
 int totalNumEntries = 0;
 
 static void load_list_file(ListFile*, ReputationConfig* config);
+static int update_path_to_file(char* full_filename, unsigned int max_size, const char* filename);
 
 ReputationConfig::~ReputationConfig()
 {
@@ -114,6 +116,157 @@ static uint32_t estimate_size(uint32_t num_entries, uint32_t memcap)
     return (uint32_t)size;
 }
 
+static void set_list_types(ReputationConfig* config)
+{
+    for (size_t i = 0; i < config->list_files.size(); i++)
+    {
+        config->list_files[i]->list_index = (uint8_t)i + 1;
+        if (config->list_files[i]->file_type == ALLOW_LIST)
+        {
+            if (config->allow_action == DO_NOT_BLOCK)
+                config->list_files[i]->list_type = TRUSTED_DO_NOT_BLOCK;
+            else
+                config->list_files[i]->list_type = TRUSTED;
+        }
+        else if (config->list_files[i]->file_type == BLOCK_LIST)
+            config->list_files[i]->list_type = BLOCKED;
+        else if (config->list_files[i]->file_type == MONITOR_LIST)
+            config->list_files[i]->list_type = MONITORED;
+    }
+}
+
+// the table built from the lists depends only on the memcap and on their
+// order, types and content so file size and modification time stand in for
+// the content
+static uint64_t get_list_fingerprint(ReputationConfig* config)
+{
+    uint64_t hash = 0xcbf29ce484222325;  // FNV-1a
+
+    auto mix = [&hash](const void* p, size_t n)
+    {
+        for ( size_t i = 0; i < n; ++i )
+        {
+            hash ^= ((const uint8_t*)p)[i];
+            hash *= 0x100000001b3;
+        }
+    };
+
+    mix(&config->memcap, sizeof(config->memcap));
+
+    for (auto& file : config->list_files)
+    {
+        char full_path_filename[PATH_MAX+1];
+        update_path_to_file(full_path_filename, PATH_MAX, file->file_name.c_str());
+
+        struct stat st;
+        int64_t info[3] = { file->file_type, -1, -1 };
+
+        if ( !stat(full_path_filename, &st) )
+        {
+            info[1] = st.st_size;
+            info[2] = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+        }
+
+        mix(full_path_filename, strlen(full_path_filename) + 1);
+        mix(info, sizeof(info));
+    }
+
+    return hash;
+}
+
+static void save_image(ReputationConfig* config, size_t size)
+{
+    if ( !config->ip_list or config->memcap_reached )
+    {
+        ErrorMessage("Reputation image %s not saved; table is incomplete.\n",
+            config->image_path.c_str());
+        return;
+    }
+
+    char full_path_filename[PATH_MAX+1];
+    update_path_to_file(full_path_filename, PATH_MAX, config->image_path.c_str());
+
+    if ( !ReputationImage::save(full_path_filename, config->list_fingerprint,
+        sfrt_flat_num_entries(config->ip_list), config->reputation_segment, size) )
+        return;
+
+    LogMessage("    Saved reputation image %s\n", full_path_filename);
+
+    // switch to the mapped copy so the next reload can share it
+    auto image = ReputationImage::load(full_path_filename, config->list_fingerprint);
+
+    if ( !image )
+        return;
+
+    snort_free(config->reputation_segment);
+    config->reputation_segment = nullptr;
+    config->image = image;
+    config->ip_list = image->get_table();
+}
+
+// the image checks the table itself; the list information it points to is
+// checked here since only the config knows how many lists there are
+static bool valid_list_info(ReputationConfig* config)
+{
+    const table_flat_t* table = config->image->get_table();
+    const uint8_t* base = (const uint8_t*)table;
+    const INFO* data = (const INFO*)&base[table->data];
+    size_t size = config->image->get_data_size();
+    int num_lists = config->list_files.size();
+
+    for (uint32_t i = 0; i < table->num_ent; i++)
+    {
+        MEM_OFFSET info = data[i];
+
+        // every IPrepInfo holds at least one distinct list
+        for (int n = 0; info; n++)
+        {
+            if (n >= num_lists or info > size - sizeof(IPrepInfo))
+                return false;
+
+            const IPrepInfo* rep_info = (const IPrepInfo*)&base[info];
+
+            for (int j = 0; j < NUM_INDEX_PER_ENTRY; j++)
+            {
+                int list_index = rep_info->list_indexes[j];
+
+                if (list_index < 0 or list_index > num_lists)
+                    return false;
+            }
+            info = rep_info->next;
+        }
+    }
+    return true;
+}
+
+bool ip_list_load_image(ReputationConfig* config)
+{
+    char full_path_filename[PATH_MAX+1];
+    update_path_to_file(full_path_filename, PATH_MAX, config->image_path.c_str());
+
+    config->list_fingerprint = get_list_fingerprint(config);
+    config->image = ReputationImage::load(full_path_filename, config->list_fingerprint);
+
+    if ( !config->image )
+        return false;
+
+    if ( !valid_list_info(config) )
+    {
+        WarningMessage("reputation: %s does not match the lists\n", full_path_filename);
+        config->image.reset();
+        return false;
+    }
+
+    set_list_types(config);
+    config->ip_list = config->image->get_table();
+    config->num_entries = config->image->get_num_entries();
+
+    LogMessage("    Mapped reputation image %s, entries: %u\n",
+        full_path_filename, config->image->get_num_entries());
+
+    return true;
+}
+
 void ip_list_init(uint32_t max_entries, ReputationConfig* config)
 {
     if ( !config->ip_list )
@@ -137,23 +290,13 @@ void ip_list_init(uint32_t max_entries, ReputationConfig* config)
         }
 
         total_duplicates = 0;
-        for (size_t i = 0; i < config->list_files.size(); i++)
-        {
-            config->list_files[i]->list_index = (uint8_t)i + 1;
-            if (config->list_files[i]->file_type == ALLOW_LIST)
-            {
-                if (config->allow_action == DO_NOT_BLOCK)
-                    config->list_files[i]->list_type = TRUSTED_DO_NOT_BLOCK;
-                else
-                    config->list_files[i]->list_type = TRUSTED;
-            }
-            else if (config->list_files[i]->file_type == BLOCK_LIST)
-                config->list_files[i]->list_type = BLOCKED;
-            else if (config->list_files[i]->file_type == MONITOR_LIST)
-                config->list_files[i]->list_type = MONITORED;
+        set_list_types(config);
 
-            load_list_file(config->list_files[i], config);
-        }
+        for (auto& file : config->list_files)
+            load_list_file(file, config);
+
+        if ( !config->image_path.empty() )
+            save_image(config, mem_size - segment_unusedmem());
     }
 }
 
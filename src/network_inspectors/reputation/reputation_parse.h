@@ -25,6 +25,7 @@
 #define MANIFEST_FILENAME "interface.info"
 
 void ip_list_init(uint32_t,ReputationConfig *config);
+bool ip_list_load_image(ReputationConfig* config);
 void estimate_num_entries(ReputationConfig* config);
 int read_manifest(const char* filename, ReputationConfig* config);
 void add_block_allow_List(ReputationConfig* config);
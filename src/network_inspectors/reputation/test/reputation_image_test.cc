@@ -0,0 +1,251 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// reputation_image_test.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "network_inspectors/reputation/reputation_image.h"
+#include "sfip/sf_cidr.h"
+#include "sfrt/sfrt.h"
+#include "utils/segment_mem.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+using namespace snort;
+
+namespace snort
+{
+void WarningMessage(const char*, ...) { }
+const char* get_error(int) { return ""; }
+
+char* snort_strdup(const char* str)
+{
+    assert(str);
+    size_t n = strlen(str) + 1;
+    char* p = new char[n];
+    memcpy(p, str, n);
+    return p;
+}
+}
+
+#define IMAGE_FILE "reputation_image_test.img"
+#define SEGMENT_SIZE (1 << 20)
+#define FINGERPRINT 0x1234
+
+static uint8_t segment[SEGMENT_SIZE];
+
+static int64_t update_entry(INFO* current, INFO new_entry, SaveDest, uint8_t*)
+{
+    *current = new_entry;
+    return 0;
+}
+
+static void add(table_flat_t* table, const char* ip, unsigned bits, uint32_t value)
+{
+    SfCidr cidr;
+    uint32_t a;
+    inet_pton(AF_INET, ip, &a);
+    cidr.set(&a, AF_INET);
+    cidr.set_bits(96 + bits);
+
+    INFO info = segment_snort_calloc(1, sizeof(value));
+    memcpy(segment + info, &value, sizeof(value));
+    sfrt_flat_insert(&cidr, cidr.get_bits(), info, RT_FAVOR_ALL, table, update_entry);
+}
+
+static const uint32_t* lookup(table_flat_t* table, const char* ip)
+{
+    SfIp sip;
+    uint32_t a;
+    inet_pton(AF_INET, ip, &a);
+    sip.set(&a, AF_INET);
+    return (const uint32_t*)sfrt_flat_dir8x_lookup(&sip, table);
+}
+
+// returns the used size of the segment
+static size_t build()
+{
+    memset(segment, 0, sizeof(segment));
+    segment_meminit(segment, SEGMENT_SIZE);
+
+    table_flat_t* table = sfrt_flat_new(DIR_8x16, IPv6, 16, 1);
+    CHECK(table == (table_flat_t*)segment);
+
+    add(table, "10.1.0.0", 16, 7);
+    add(table, "192.168.1.1", 32, 9);
+
+    return SEGMENT_SIZE - segment_unusedmem();
+}
+
+TEST_GROUP(reputation_image)
+{
+    void teardown() override
+    {
+        unlink(IMAGE_FILE);
+    }
+};
+
+TEST(reputation_image, save_load)
+{
+    size_t size = build();
+    table_flat_t* table = (table_flat_t*)segment;
+
+    CHECK(ReputationImage::save(IMAGE_FILE, FINGERPRINT, sfrt_flat_num_entries(table),
+        segment, size));
+
+    auto image = ReputationImage::load(IMAGE_FILE, FINGERPRINT);
+    CHECK(image != nullptr);
+    CHECK(image->get_num_entries() == sfrt_flat_num_entries(table));
+    CHECK(sfrt_flat_usage(image->get_table()) == sfrt_flat_usage(table));
+
+    // the mapped table is looked up in place
+    memset(segment, 0, sizeof(segment));
+
+    const uint32_t* v = lookup(image->get_table(), "10.1.2.3");
+    CHECK(v and *v == 7);
+
+    v = lookup(image->get_table(), "192.168.1.1");
+    CHECK(v and *v == 9);
+
+    CHECK(!lookup(image->get_table(), "192.168.1.2"));
+}
+
+TEST(reputation_image, shared)
+{
+    size_t size = build();
+    CHECK(ReputationImage::save(IMAGE_FILE, FINGERPRINT, 2, segment, size));
+
+    auto image1 = ReputationImage::load(IMAGE_FILE, FINGERPRINT);
+    auto image2 = ReputationImage::load(IMAGE_FILE, FINGERPRINT);
+    CHECK(image1 != nullptr);
+    CHECK(image1 == image2);
+
+    // a rewritten file is mapped again while the old mapping stays valid
+    CHECK(ReputationImage::save(IMAGE_FILE, FINGERPRINT, 2, segment, size));
+    auto image3 = ReputationImage::load(IMAGE_FILE, FINGERPRINT);
+    CHECK(image3 != nullptr);
+    CHECK(image3 != image1);
+
+    const uint32_t* v = lookup(image1->get_table(), "10.1.2.3");
+    CHECK(v and *v == 7);
+}
+
+TEST(reputation_image, stale)
+{
+    size_t size = build();
+    CHECK(ReputationImage::save(IMAGE_FILE, FINGERPRINT, 2, segment, size));
+
+    CHECK(ReputationImage::load(IMAGE_FILE, FINGERPRINT + 1) == nullptr);
+
+    auto image = ReputationImage::load(IMAGE_FILE, FINGERPRINT);
+    CHECK(image != nullptr);
+    CHECK(ReputationImage::load(IMAGE_FILE, FINGERPRINT + 1) == nullptr);
+}
+
+TEST(reputation_image, invalid)
+{
+    CHECK(ReputationImage::load(IMAGE_FILE, FINGERPRINT) == nullptr);
+
+    FILE* fp = fopen(IMAGE_FILE, "wb");
+    CHECK(fp);
+
+    uint8_t junk[8192];
+    memset(junk, 0xa5, sizeof(junk));
+    fwrite(junk, sizeof(junk), 1, fp);
+    fclose(fp);
+
+    CHECK(ReputationImage::load(IMAGE_FILE, FINGERPRINT) == nullptr);
+
+    // truncated
+    size_t size = build();
+    CHECK(ReputationImage::save(IMAGE_FILE, FINGERPRINT, 2, segment, size));
+    CHECK(truncate(IMAGE_FILE, 4096 + size / 2) == 0);
+    CHECK(ReputationImage::load(IMAGE_FILE, FINGERPRINT) == nullptr);
+}
+
+static DIR_Entry* root_entries(TABLE_PTR rt)
+{
+    dir_table_flat_t* root = (dir_table_flat_t*)(segment + rt);
+    dir_sub_table_flat_t* sub = (dir_sub_table_flat_t*)(segment + root->sub_table);
+    return (DIR_Entry*)(segment + sub->entries);
+}
+
+static bool load_corrupt(size_t size)
+{
+    CHECK(ReputationImage::save(IMAGE_FILE, FINGERPRINT, 2, segment, size));
+    return ReputationImage::load(IMAGE_FILE, FINGERPRINT) != nullptr;
+}
+
+TEST(reputation_image, nested)
+{
+    size_t size = build();
+    table_flat_t* table = (table_flat_t*)segment;
+    CHECK(load_corrupt(size));
+
+    // 10.1/16 is a data index in the first level and 192.168 a sub table
+    DIR_Entry* entry = root_entries(table->rt);
+    CHECK(entry[0x0a01].length and entry[0x0a01].value);
+    CHECK(!entry[0xc0a8].length and entry[0xc0a8].value);
+
+    entry[0x0a01].value = table->num_ent;
+    CHECK(!load_corrupt(size));
+
+    size = build();
+    entry[0xc0a8].value = size;
+    CHECK(!load_corrupt(size));
+
+    size = build();
+    dir_sub_table_flat_t* sub = (dir_sub_table_flat_t*)(segment + entry[0xc0a8].value);
+    sub->entries = size - sizeof(DIR_Entry);
+    CHECK(!load_corrupt(size));
+
+    size = build();
+    sub->width = 16;
+    CHECK(!load_corrupt(size));
+
+    // a sub table may only be referenced once
+    size = build();
+    entry[0x0001] = entry[0xc0a8];
+    CHECK(!load_corrupt(size));
+
+    size = build();
+    INFO* data = (INFO*)(segment + table->data);
+    data[1] = size;
+    CHECK(!load_corrupt(size));
+
+    size = build();
+    entry = root_entries(table->rt6);
+    entry[0].value = size;
+    CHECK(!load_corrupt(size));
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
+
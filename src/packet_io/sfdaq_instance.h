@@ -56,6 +56,19 @@ public:
             return daq_msgs[curr_batch_idx++];
         return nullptr;
     }
+    // Look at the next message in the current batch without consuming it.
+    DAQ_Msg_h peek_message() const
+    {
+        if (curr_batch_idx < curr_batch_size)
+            return daq_msgs[curr_batch_idx];
+        return nullptr;
+    }
+    // Get the messages remaining in the current batch without consuming them.
+    unsigned get_pending_messages(const DAQ_Msg_h*& msgs) const
+    {
+        msgs = daq_msgs + curr_batch_idx;
+        return curr_batch_size - curr_batch_idx;
+    }
     int finalize_message(DAQ_Msg_h msg, DAQ_Verdict verdict);
     const char* get_error();
 
@@ -65,6 +65,7 @@ sfip_var_t* sfip_var_from_string(const char* addr, const char* caller)
         }
     }
 
+    sfvar_compile(ret);
     return ret;
 }
 
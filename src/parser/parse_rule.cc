@@ -244,9 +244,15 @@ static int ProcessIP(SnortConfig* sc, const char* addr, RuleTreeNode* rtn, int m
 
     /* Make sure the IP lists provided by the user are valid */
     if (mode == SRC)
+    {
         ValidateIPList(rtn->sip, addr);
+        sfvar_compile(rtn->sip);
+    }
     else
+    {
         ValidateIPList(rtn->dip, addr);
+        sfvar_compile(rtn->dip);
+    }
 
     return 0;
 }
@@ -450,32 +456,17 @@ static void XferHeader(RuleTreeNode* from, RuleTreeNode* to)
 }
 
 /****************************************************************************
- * Purpose:  Adds RuleTreeNode associated detection functions to the
- *          current rule's function list
+ * Purpose:  Appends a header check to the current rule's check list
  *
- * Arguments: *func => function pointer to the detection function
+ * Arguments: op    => the header check to add
  *            rtn   => pointer to the current rule
+ *            n     => number of checks added so far
  ***************************************************************************/
-static void AddRuleFuncToList(
-    int (* rfunc)(Packet*, RuleTreeNode*, struct RuleFpList*, int),
-    RuleTreeNode* rtn)
+static void AddRuleHeadOp(RuleHeadOp op, RuleTreeNode* rtn, unsigned& n)
 {
-    RuleFpList* idx = rtn->rule_func;
-
-    if ( !idx )
-    {
-        rtn->rule_func = new RuleFpList;
-        rtn->rule_func->RuleHeadFunc = rfunc;
-    }
-    else
-    {
-        while ( idx->next )
-            idx = idx->next;
-
-        idx->next = new RuleFpList;
-        idx = idx->next;
-        idx->RuleHeadFunc = rfunc;
-    }
+    // leave room for END
+    assert(n + 1 < RuleTreeNode::max_header_ops);
+    rtn->header_ops[n++] = op;
 }
 
 /****************************************************************************
@@ -486,7 +477,7 @@ static void AddRuleFuncToList(
  *            mode => indicates whether this is a rule for the source
  *                    or destination IP for the rule
  ***************************************************************************/
-static void AddrToFunc(RuleTreeNode* rtn, int mode)
+static void AddrToFunc(RuleTreeNode* rtn, int mode, unsigned& n)
 {
     /*
      * if IP and mask are both 0, this is a "any" IP and we don't need to
@@ -497,14 +488,14 @@ static void AddrToFunc(RuleTreeNode* rtn, int mode)
     case SRC:
         if ((rtn->flags & RuleTreeNode::ANY_SRC_IP) == 0)
         {
-            AddRuleFuncToList(CheckSrcIP, rtn);
+            AddRuleHeadOp(RuleHeadOp::SRC_IP, rtn, n);
         }
         break;
 
     case DST:
         if ((rtn->flags & RuleTreeNode::ANY_DST_IP) == 0)
         {
-            AddRuleFuncToList(CheckDstIP, rtn);
+            AddRuleHeadOp(RuleHeadOp::DST_IP, rtn, n);
         }
         break;
     }
@@ -519,7 +510,7 @@ static void AddrToFunc(RuleTreeNode* rtn, int mode)
  *            mode => indicates whether this is a rule for the source
  *                    or destination port for the rule
  ***************************************************************************/
-static void PortToFunc(RuleTreeNode* rtn, int any_flag, int except_flag, int mode)
+static void PortToFunc(RuleTreeNode* rtn, int any_flag, int except_flag, int mode, unsigned& n)
 {
     /*
      * if the any flag is set we don't need to perform any test to match on
@@ -534,11 +525,11 @@ static void PortToFunc(RuleTreeNode* rtn, int any_flag, int except_flag, int mod
         switch (mode)
         {
         case SRC:
-            AddRuleFuncToList(CheckSrcPortNotEq, rtn);
+            AddRuleHeadOp(RuleHeadOp::SRC_PORT_NE, rtn, n);
             break;
 
         case DST:
-            AddRuleFuncToList(CheckDstPortNotEq, rtn);
+            AddRuleHeadOp(RuleHeadOp::DST_PORT_NE, rtn, n);
             break;
         }
 
@@ -548,37 +539,43 @@ static void PortToFunc(RuleTreeNode* rtn, int any_flag, int except_flag, int mod
     switch (mode)
     {
     case SRC:
-        AddRuleFuncToList(CheckSrcPortEqual, rtn);
+        AddRuleHeadOp(RuleHeadOp::SRC_PORT_EQ, rtn, n);
         break;
 
     case DST:
-        AddRuleFuncToList(CheckDstPortEqual, rtn);
+        AddRuleHeadOp(RuleHeadOp::DST_PORT_EQ, rtn, n);
         break;
     }
 }
 
-// Configures the function list for the rule header detection
+// Configures the check list for the rule header detection
 // functions (addrs and ports)
 static void SetupRTNFuncList(RuleTreeNode* rtn)
 {
+    unsigned n = 0;
+
+    if ( rtn->snort_protocol_id >= SNORT_PROTO_FILE )
+        rtn->flags |= RuleTreeNode::USER_MODE;
+
+    // the bidirectional check has always been the only one for its rules
+    // (the proto isn't checked) so it stands alone
     if (rtn->flags & RuleTreeNode::BIDIRECTIONAL)
-        AddRuleFuncToList(CheckBidirectional, rtn);
+        AddRuleHeadOp(RuleHeadOp::BIDIRECTIONAL, rtn, n);
 
     else
     {
-        PortToFunc(rtn, (rtn->any_dst_port() ? 1 : 0), 0, DST);
-        PortToFunc(rtn, (rtn->any_src_port() ? 1 : 0), 0, SRC);
+        // the proto check is the cheapest so it goes first
+        if ( rtn->snort_protocol_id < SNORT_PROTO_FILE )
+            AddRuleHeadOp(RuleHeadOp::PROTO, rtn, n);
 
-        AddrToFunc(rtn, SRC);
-        AddrToFunc(rtn, DST);
-    }
+        PortToFunc(rtn, (rtn->any_dst_port() ? 1 : 0), 0, DST, n);
+        PortToFunc(rtn, (rtn->any_src_port() ? 1 : 0), 0, SRC, n);
 
-    if ( rtn->snort_protocol_id < SNORT_PROTO_FILE )
-        AddRuleFuncToList(CheckProto, rtn);
-    else
-        rtn->flags |= RuleTreeNode::USER_MODE;
+        AddrToFunc(rtn, SRC, n);
+        AddrToFunc(rtn, DST, n);
+    }
 
-    AddRuleFuncToList(RuleListEnd, rtn);
+    rtn->header_ops[n] = RuleHeadOp::END;
 }
 
 // make a new node and stick it at the end of the list
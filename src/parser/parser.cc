@@ -396,14 +396,6 @@ void FreeRuleTreeNode(RuleTreeNode* rtn)
     if (rtn->dip)
         sfvar_free(rtn->dip);
 
-    RuleFpList* idx = rtn->rule_func;
-
-    while (idx)
-    {
-        RuleFpList* tmp = idx;
-        idx = idx->next;
-        delete tmp;
-    }
     delete rtn->header;
 }
 
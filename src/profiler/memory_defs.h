@@ -30,11 +30,12 @@ struct MemoryStats
     uint64_t allocated;
     uint64_t deallocated;
 
-    void update_allocs(size_t n)
-    { ++allocs; allocated += n; }
+    // count > 1 when a sample stands for several calls
+    void update_allocs(size_t n, uint64_t count = 1)
+    { allocs += count; allocated += n; }
 
-    void update_deallocs(size_t n)
-    { ++deallocs; deallocated += n; }
+    void update_deallocs(size_t n, uint64_t count = 1)
+    { deallocs += count; deallocated += n; }
 
     void reset();
 
@@ -96,8 +97,8 @@ struct CombinedMemoryStats
     MemoryStats startup;
     MemoryStats runtime;
 
-    void update_allocs(size_t);
-    void update_deallocs(size_t);
+    void update_allocs(size_t, uint64_t count = 1);
+    void update_deallocs(size_t, uint64_t count = 1);
 
     void reset();
 
@@ -111,20 +112,20 @@ struct CombinedMemoryStats
     CombinedMemoryStats& operator+=(const CombinedMemoryStats&);
 };
 
-inline void CombinedMemoryStats::update_allocs(size_t n)
+inline void CombinedMemoryStats::update_allocs(size_t n, uint64_t count)
 {
     if ( snort::is_packet_thread() )
-        runtime.update_allocs(n);
+        runtime.update_allocs(n, count);
     else
-        startup.update_allocs(n);
+        startup.update_allocs(n, count);
 }
 
-inline void CombinedMemoryStats::update_deallocs(size_t n)
+inline void CombinedMemoryStats::update_deallocs(size_t n, uint64_t count)
 {
     if ( snort::is_packet_thread() )
-        runtime.update_deallocs(n);
+        runtime.update_deallocs(n, count);
     else
-        startup.update_deallocs(n);
+        startup.update_deallocs(n, count);
 }
 
 inline void CombinedMemoryStats::reset()
@@ -151,11 +152,11 @@ struct MemoryTracker
     void reset()
     { stats.reset(); }
 
-    void update_allocs(size_t n)
-    { stats.update_allocs(n); }
+    void update_allocs(size_t n, uint64_t count = 1)
+    { stats.update_allocs(n, count); }
 
-    void update_deallocs(size_t n)
-    { stats.update_deallocs(n); }
+    void update_deallocs(size_t n, uint64_t count = 1)
+    { stats.update_deallocs(n, count); }
 
     constexpr MemoryTracker() = default;
     constexpr MemoryTracker(const CombinedMemoryStats &stats) : stats(stats) { }
@@ -245,6 +245,17 @@ TEST_CASE( "memory stats", "[profiler][memory_profiler]" )
                 CHECK( (stats.deallocated == 14) );
             }
         }
+
+        SECTION( "sampled" )
+        {
+            stats.update_allocs(100, 5);
+            stats.update_deallocs(100, 5);
+
+            CHECK( (stats.allocs == 6) );
+            CHECK( (stats.deallocs == 7) );
+            CHECK( (stats.allocated == 103) );
+            CHECK( (stats.deallocated == 104) );
+        }
     }
 
     SECTION( "reset" )
@@ -27,11 +27,11 @@
 class MemoryActiveContext : public ActiveContext<MemoryTracker>
 {
 public:
-    void update_allocs(size_t n)
-    { get_default().update_allocs(n); }
+    void update_allocs(size_t n, uint64_t count = 1)
+    { get_default().update_allocs(n, count); }
 
-    void update_deallocs(size_t n)
-    { get_default().update_deallocs(n); }
+    void update_deallocs(size_t n, uint64_t count = 1)
+    { get_default().update_deallocs(n, count); }
 };
 
 extern THREAD_LOCAL MemoryActiveContext mp_active_context;
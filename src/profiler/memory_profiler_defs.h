@@ -38,6 +38,7 @@ struct MemoryProfilerConfig
     bool show = false;
     unsigned count = 0;
     int max_depth = -1;
+    size_t sample_interval = 0;
 };
 
 namespace snort
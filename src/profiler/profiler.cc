@@ -27,6 +27,7 @@
 #include <cassert>
 
 #include "framework/module.h"
+#include "helpers/json_stream.h"
 #include "main/snort_config.h"
 #include "main/thread_config.h"
 #include "time/stopwatch.h"
@@ -126,6 +127,71 @@ void Profiler::show_stats()
     show_rule_profiler_stats(config->rule);
 }
 
+void Profiler::set_enabled(bool modules, bool rules)
+{
+    TimeProfilerStats::set_enabled(modules);
+    RuleContext::set_enabled(rules);
+}
+
+void Profiler::accumulate_thread_stats()
+{ s_profiler_nodes.accumulate_nodes(); }
+
+void Profiler::reset_thread_stats()
+{
+    s_profiler_nodes.reset_local_nodes();
+    reset_rule_profiler_stats(get_instance_id());
+}
+
+static void dump_node(JsonStream& json, const ProfilerNode& node)
+{
+    const auto& stats = node.get_stats();
+
+    json.open();
+    json.put("name", node.name);
+    json.put("checks", stats.time.checks);
+    json.put("time_us", clock_usecs(TO_USECS(stats.time.elapsed)));
+
+#ifdef ENABLE_MEMORY_PROFILER
+    const auto& mem = stats.memory.stats.runtime;
+    json.put("allocs", mem.allocs);
+    json.put("deallocs", mem.deallocs);
+    json.put("allocated", mem.allocated);
+    json.put("deallocated", mem.deallocated);
+#endif
+
+    auto children = node.get_children();
+
+    if ( !children.empty() )
+    {
+        json.open_array("modules");
+
+        for ( auto* child : children )
+            dump_node(json, *child);
+
+        json.close_array();
+    }
+    json.close();
+}
+
+void Profiler::dump_stats(std::ostream& os)
+{
+    JsonStream json(os);
+    json.open();
+
+    json.open_array("modules");
+
+    for ( auto* pn : s_profiler_nodes.get_root().get_children() )
+        dump_node(json, *pn);
+
+    json.close_array();
+
+    dump_rule_profiler_stats(json);
+    json.close();
+
+    // the packet threads add their totals again at exit
+    s_profiler_nodes.reset_nodes();
+}
+
 #ifdef UNIT_TEST
 
 TEST_CASE( "profile stats", "[profiler]" )
@@ -21,6 +21,8 @@
 #ifndef PROFILER_H
 #define PROFILER_H
 
+#include <ostream>
+
 #include "main/thread.h"
 #include "profiler_defs.h"
 
@@ -42,6 +44,13 @@ public:
 
     static void reset_stats();
     static void show_stats();
+
+    // shell control while packets are flowing; the thread functions are
+    // called on each packet thread, dump_stats on main after they are done
+    static void set_enabled(bool modules, bool rules);
+    static void accumulate_thread_stats();
+    static void reset_thread_stats();
+    static void dump_stats(std::ostream&);
 };
 
 extern THREAD_LOCAL snort::ProfileStats totalPerfStats;
@@ -122,6 +122,18 @@ void ProfilerNode::accumulate()
     }
 }
 
+void ProfilerNode::reset_local()
+{
+    if ( is_set() )
+    {
+        // the getters hand out the thread local stats of the module
+        auto* local_stats = const_cast<ProfileStats*>((*getter)());
+
+        if ( local_stats )
+            local_stats->time.reset();
+    }
+}
+
 void ProfilerNodeMap::register_node(const std::string &n, const char* pn, Module* m)
 { setup_node(get_node(n), get_node(pn ? pn : ROOT_NODE), m); }
 
@@ -148,6 +160,12 @@ void ProfilerNodeMap::reset_nodes()
         it->second.reset();
 }
 
+void ProfilerNodeMap::reset_local_nodes()
+{
+    for ( auto it = nodes.begin(); it != nodes.end(); ++it )
+        it->second.reset_local();
+}
+
 const ProfilerNode& ProfilerNodeMap::get_root()
 { return get_node(ROOT_NODE); }
 
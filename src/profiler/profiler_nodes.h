@@ -49,6 +49,9 @@ public:
     // thread local call
     void accumulate();
 
+    // thread local call; clears time only
+    void reset_local();
+
     const snort::ProfileStats& get_stats() const
     { return stats; }
 
@@ -94,6 +97,7 @@ public:
     void accumulate_nodes();
     void accumulate_flex();
     void reset_nodes();
+    void reset_local_nodes();
 
     const ProfilerNode& get_root();
 
@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <vector>
 
@@ -38,6 +39,7 @@
 
 #include "detection/treenodes.h"
 #include "hash/ghash.h"
+#include "helpers/json_stream.h"
 #include "main/snort_config.h"
 #include "main/thread_config.h"
 #include "parser/parser.h"
@@ -57,6 +59,10 @@ using namespace snort;
 
 bool RuleContext::enabled = false;
 
+// the otn map and option tree walks use a cursor in the table so the shell
+// commands that run on the packet threads and main thread must take turns
+static std::mutex walk_mutex;
+
 static inline OtnState& operator+=(OtnState& lhs, const OtnState& rhs)
 {
     lhs.elapsed += rhs.elapsed;
@@ -222,6 +228,38 @@ static std::vector<View> build_entries()
     return entries;
 }
 
+// unlike build_entries, this leaves the rule states as is
+static std::vector<View> build_live_entries()
+{
+    const SnortConfig* sc = SnortConfig::get_conf();
+    assert(sc);
+
+    OtnStateMap snapshot;
+    detection_option_tree_snapshot_otn_stats(sc->detection_option_tree_hash_table, snapshot);
+    auto* otn_map = sc->otn_map;
+
+    std::vector<View> entries;
+
+    for ( auto* h = otn_map->find_first(); h; h = otn_map->find_next() )
+    {
+        auto* otn = static_cast<OptTreeNode*>(h->data);
+        assert(otn);
+
+        auto it = snapshot.find(otn);
+        OtnState state = (it != snapshot.end()) ? it->second : OtnState();
+
+        for ( unsigned i = 0; i < ThreadConfig::get_instance_max(); ++i )
+            state += otn->state[i];
+
+        if ( !state )
+            continue;
+
+        entries.emplace_back(state, &otn->sigInfo);
+    }
+
+    return entries;
+}
+
 // FIXIT-L logic duplicated from ProfilerPrinter
 static void print_single_entry(const View& v, unsigned n)
 {
@@ -337,9 +375,62 @@ void reset_rule_profiler_stats()
     }
 }
 
+void dump_rule_profiler_stats(JsonStream& json)
+{
+    std::vector<rule_stats::View> entries;
+    {
+        std::lock_guard<std::mutex> lock(walk_mutex);
+        entries = rule_stats::build_live_entries();
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [](const rule_stats::View& lhs, const rule_stats::View& rhs)
+        { return lhs.elapsed() > rhs.elapsed(); });
+
+    json.open_array("rules");
+
+    for ( const auto& v : entries )
+    {
+        json.open();
+        json.put("gid", v.sig_info.gid);
+        json.put("sid", v.sig_info.sid);
+        json.put("rev", v.sig_info.rev);
+        json.put("checks", v.checks());
+        json.put("matches", v.matches());
+        json.put("alerts", v.alerts());
+        json.put("time_us", clock_usecs(TO_USECS(v.elapsed())));
+        json.put("avg_check", clock_usecs(TO_USECS(v.avg_check())));
+        json.put("avg_match", clock_usecs(TO_USECS(v.avg_match())));
+        json.put("avg_no_match", clock_usecs(TO_USECS(v.avg_no_match())));
+        json.put("timeouts", v.timeouts());
+        json.put("suspends", v.suspends());
+        json.close();
+    }
+
+    json.close_array();
+}
+
+void reset_rule_profiler_stats(unsigned instance)
+{
+    const SnortConfig* sc = SnortConfig::get_conf();
+    assert(sc);
+
+    std::lock_guard<std::mutex> lock(walk_mutex);
+    detection_option_tree_reset_stats(sc->detection_option_tree_hash_table, instance);
+
+    auto* otn_map = sc->otn_map;
+
+    for ( auto* h = otn_map->find_first(); h; h = otn_map->find_next() )
+    {
+        auto* otn = static_cast<OptTreeNode*>(h->data);
+        assert(otn);
+        otn->state[instance] = OtnState();
+    }
+}
+
 void RuleContext::stop(bool match)
 {
-    if ( !enabled or finished )
+    if ( finished )
         return;
 
     finished = true;
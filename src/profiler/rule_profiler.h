@@ -21,9 +21,17 @@
 #ifndef RULE_PROFILER_H
 #define RULE_PROFILER_H
 
+namespace snort
+{
+class JsonStream;
+}
 struct RuleProfilerConfig;
 
 void show_rule_profiler_stats(const RuleProfilerConfig&);
 void reset_rule_profiler_stats();
 
+// live access from the shell while packet threads are running
+void dump_rule_profiler_stats(snort::JsonStream&);
+void reset_rule_profiler_stats(unsigned instance);
+
 #endif
@@ -47,8 +47,10 @@ struct RuleProfilerConfig
 class RuleContext
 {
 public:
+    // a context started while disabled is never counted even if profiling
+    // is enabled from the shell before it stops
     RuleContext(dot_node_state_t& stats) :
-        stats(stats)
+        stats(stats), finished(!enabled)
     { start(); }
 
     ~RuleContext()
@@ -71,7 +73,7 @@ public:
 private:
     dot_node_state_t& stats;
     Stopwatch<SnortClock> sw;
-    bool finished = false;
+    bool finished;
     static bool enabled;
 };
 
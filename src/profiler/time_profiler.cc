@@ -590,6 +590,38 @@ TEST_CASE( "time profiler time context", "[profiler][time_profiler]" )
     }
 }
 
+TEST_CASE( "time profiler time context toggled", "[profiler][time_profiler]" )
+{
+    TimeProfilerStats stats;
+
+    SECTION( "enabled while active" )
+    {
+        TimeProfilerStats::set_enabled(false);
+        {
+            TimeContext ctx(stats);
+            TimeProfilerStats::set_enabled(true);
+        }
+
+        CHECK( stats.ref_count == 0 );
+        CHECK( stats.checks == 0 );
+    }
+
+    SECTION( "disabled while active" )
+    {
+        TimeProfilerStats::set_enabled(true);
+        {
+            TimeContext ctx(stats);
+            CHECK( stats.ref_count == 1 );
+            TimeProfilerStats::set_enabled(false);
+        }
+
+        CHECK( stats.ref_count == 0 );
+        CHECK( stats.checks == 1 );
+    }
+
+    TimeProfilerStats::set_enabled(false);
+}
+
 TEST_CASE( "time context exclude", "[profiler][time_profiler]" )
 {
     // NOTE: this test *may* fail if the time it takes to execute the exclude context is 0_ticks (unlikely)
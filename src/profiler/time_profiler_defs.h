@@ -91,26 +91,30 @@ inline TimeProfilerStats& operator+=(TimeProfilerStats& lhs, const TimeProfilerS
     return lhs;
 }
 
+// profiling may be turned on or off from the shell while a context is
+// live so the exit must match the enter regardless of the current setting
 class TimeContext
 {
 public:
     TimeContext(TimeProfilerStats& stats) :
         stats(stats)
     {
-        if ( stats.is_enabled() and stats.enter() )
-            sw.start();
+        if ( stats.is_enabled() )
+        {
+            entered = true;
+
+            if ( stats.enter() )
+                sw.start();
+        }
     }
 
     ~TimeContext()
-    {
-        if ( stats.is_enabled() )
-            stop();
-    }
+    { stop(); }
 
     // Use this for finer grained control of the TimeContext "lifetime"
     void stop()
     {
-        if ( !stats.is_enabled() or stopped_once )
+        if ( !entered or stopped_once )
             return; // stop() should only be executed once per context
 
         stopped_once = true;
@@ -132,6 +136,7 @@ public:
 private:
     TimeProfilerStats& stats;
     Stopwatch<SnortClock> sw;
+    bool entered = false;
     bool stopped_once = false;
 };
 
@@ -146,8 +151,6 @@ public:
 
     ~TimeExclude()
     {
-        if ( !TimeProfilerStats::is_enabled() )
-            return;
         ctx.stop();
         stats.elapsed -= tmp.elapsed;
     }
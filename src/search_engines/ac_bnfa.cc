@@ -96,6 +96,18 @@ public:
     {
         return bnfaPatternCount(obj);
     }
+
+    bool serialize(uint8_t*& buf, size_t& sz) const override
+    { return obj and bnfaSerialize(obj, buf, sz); }
+
+    bool deserialize(const uint8_t* buf, size_t sz) override
+    { return obj and bnfaDeserialize(obj, buf, sz); }
+
+    void get_hash(std::string& hash) override
+    {
+        if (obj)
+            bnfaGetHash(obj, hash);
+    }
 };
 
 //-------------------------------------------------------------------------
@@ -83,6 +83,15 @@ public:
 
     int get_pattern_count() const override
     { return acsmPatternCount2(obj); }
+
+    bool serialize(uint8_t*& buf, size_t& sz) const override
+    { return acsmSerialize2(obj, buf, sz); }
+
+    bool deserialize(const uint8_t* buf, size_t sz) override
+    { return acsmDeserialize2(obj, buf, sz); }
+
+    void get_hash(std::string& hash) override
+    { acsmGetHash2(obj, hash); }
 };
 
 //-------------------------------------------------------------------------
@@ -64,6 +64,15 @@ public:
 
     int get_pattern_count() const override
     { return acsmPatternCount(obj); }
+
+    bool serialize(uint8_t*& buf, size_t& sz) const override
+    { return acsmSerialize(obj, buf, sz); }
+
+    bool deserialize(const uint8_t* buf, size_t sz) override
+    { return acsmDeserialize(obj, buf, sz); }
+
+    void get_hash(std::string& hash) override
+    { acsmGetHash(obj, hash); }
 };
 
 //-------------------------------------------------------------------------
@@ -55,11 +55,16 @@
 
 #include "acsmx.h"
 
+#include <algorithm>
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 #include "main/thread.h"
 #include "utils/util.h"
 
+#include "search_db.h"
+
 using namespace snort;
 
 static int max_memory = 0;
@@ -398,8 +403,12 @@ static inline int _acsmCompile(ACSM_STRUCT* acsm)
 
 int acsmCompile(SnortConfig* sc, ACSM_STRUCT* acsm)
 {
-    if ( int rval = _acsmCompile (acsm) )
-        return rval;
+    // state table is already in place if loaded with acsmDeserialize()
+    if ( !acsm->acsmStateTable )
+    {
+        if ( int rval = _acsmCompile (acsm) )
+            return rval;
+    }
 
     if ( acsm->agent )
         acsmBuildMatchStateTrees(sc, acsm);
@@ -464,6 +473,8 @@ void acsmFree(ACSM_STRUCT* acsm)
 {
     int i;
     ACSM_PATTERN* mlist, * ilist;
+    bool loaded = acsm->acsmStateTable != nullptr;
+
     for (i = 0; i < acsm->acsmMaxStates; i++)
     {
         mlist = acsm->acsmStateTable[i].MatchList;
@@ -500,6 +511,16 @@ void acsmFree(ACSM_STRUCT* acsm)
     {
         ilist = mlist;
         mlist = mlist->next;
+
+        // without a state table (never compiled or a rejected load) the
+        // pattern still holds the only reference to its user data
+        if ( !loaded )
+        {
+            if (acsm->agent && ilist->udata->id)
+                acsm->agent->user_free(ilist->udata->id);
+
+            AC_FREE(ilist->udata);
+        }
         AC_FREE(ilist->patrn);
         AC_FREE(ilist->casepatrn);
         AC_FREE(ilist);
@@ -512,6 +533,195 @@ int acsmPatternCount(ACSM_STRUCT* acsm)
     return acsm->numPatterns;
 }
 
+/*
+*   Serialization
+*
+*   Database layout, all words are 32 bits:
+*     header     SearchDbHeader
+*     params     patterns, max states, num states
+*     states     per state: NextState[ALPHABET_SIZE] then FailState
+*     matches    per state: count followed by pattern list indices
+*/
+#define ACSM_DB_ID      "acsm"
+#define ACSM_DB_VERSION 1
+
+static void acsmUnload(ACSM_STRUCT* acsm)
+{
+    for ( int i = 0; i < acsm->acsmMaxStates; i++ )
+    {
+        ACSM_PATTERN* mlist = acsm->acsmStateTable[i].MatchList;
+
+        while ( mlist )
+        {
+            ACSM_PATTERN* ilist = mlist;
+            mlist = mlist->next;
+            AC_FREE(ilist);
+        }
+    }
+
+    // each pattern's own reference is restored for a subsequent compile
+    for ( ACSM_PATTERN* p = acsm->acsmPatterns; p; p = p->next )
+        p->udata->ref_count = 1;
+
+    AC_FREE(acsm->acsmStateTable);
+    acsm->acsmStateTable = nullptr;
+    acsm->acsmMaxStates = acsm->acsmNumStates = 0;
+}
+
+void acsmGetHash(const ACSM_STRUCT* acsm, std::string& hash)
+{
+    SearchDbHash h(ACSM_DB_ID);
+
+    for ( const ACSM_PATTERN* p = acsm->acsmPatterns; p; p = p->next )
+    {
+        h.add(p->n);
+        h.add(p->casepatrn, p->n);
+        h.add(p->nocase);
+        h.add(p->negative);
+    }
+    h.get(hash);
+}
+
+bool acsmSerialize(const ACSM_STRUCT* acsm, uint8_t*& buf, size_t& sz)
+{
+    if ( !acsm->acsmStateTable )
+        return false;
+
+    // match list entries are copies of the pattern list entries
+    std::unordered_map<const uint8_t*, uint32_t> index;
+    uint32_t n = 0;
+
+    for ( const ACSM_PATTERN* p = acsm->acsmPatterns; p; p = p->next )
+        index[p->patrn] = n++;
+
+    SearchDbWriter db(ACSM_DB_ID, ACSM_DB_VERSION, sizeof(int));
+
+    db.put((uint32_t)acsm->numPatterns);
+    db.put((uint32_t)acsm->acsmMaxStates);
+    db.put((uint32_t)acsm->acsmNumStates);
+
+    for ( int k = 0; k < acsm->acsmMaxStates; k++ )
+    {
+        const ACSM_STATETABLE& st = acsm->acsmStateTable[k];
+        db.put(st.NextState, sizeof(st.NextState));
+        db.put(st.FailState);
+    }
+
+    for ( int k = 0; k < acsm->acsmMaxStates; k++ )
+    {
+        uint32_t cnt = 0;
+
+        for ( const ACSM_PATTERN* m = acsm->acsmStateTable[k].MatchList; m; m = m->next )
+            cnt++;
+
+        db.put(cnt);
+
+        for ( const ACSM_PATTERN* m = acsm->acsmStateTable[k].MatchList; m; m = m->next )
+        {
+            auto it = index.find(m->patrn);
+
+            if ( it == index.end() )
+                return false;
+
+            db.put(it->second);
+        }
+    }
+
+    return db.finish(buf, sz);
+}
+
+bool acsmDeserialize(ACSM_STRUCT* acsm, const uint8_t* buf, size_t sz)
+{
+    if ( acsm->acsmStateTable )
+        return false;
+
+    SearchDbReader db(buf, sz, ACSM_DB_ID, ACSM_DB_VERSION, sizeof(int));
+    uint32_t npats, max_states, num_states;
+
+    if ( !db.get(npats) or !db.get(max_states) or !db.get(num_states) )
+        return false;
+
+    if ( npats != (uint32_t)acsm->numPatterns or !max_states or num_states >= max_states or
+        max_states > sz / sizeof(int) )
+        return false;
+
+    std::vector<ACSM_PATTERN*> pats;
+
+    for ( ACSM_PATTERN* p = acsm->acsmPatterns; p; p = p->next )
+        pats.emplace_back(p);
+
+    acsm->acsmMaxStates = max_states;
+    acsm->acsmNumStates = num_states;
+    acsm->acsmStateTable = (ACSM_STATETABLE*)AC_MALLOC(sizeof(ACSM_STATETABLE) * max_states);
+
+    for ( uint32_t k = 0; k < max_states; k++ )
+    {
+        ACSM_STATETABLE& st = acsm->acsmStateTable[k];
+        bool ok = db.get(st.NextState, sizeof(st.NextState)) and db.get(st.FailState);
+
+        for ( int i = 0; ok and k <= num_states and i < ALPHABET_SIZE; i++ )
+        {
+            // the search indexes with these directly so reachable rows must be valid
+            if ( st.NextState[i] < 0 or (uint32_t)st.NextState[i] >= max_states )
+                ok = false;
+        }
+
+        if ( !ok )
+        {
+            acsmUnload(acsm);
+            return false;
+        }
+    }
+
+    // the first match entry of a pattern takes the pattern's own udata reference
+    std::vector<bool> used(pats.size(), false);
+
+    for ( uint32_t k = 0; k < max_states; k++ )
+    {
+        uint32_t cnt;
+
+        if ( !db.get(cnt) )
+        {
+            acsmUnload(acsm);
+            return false;
+        }
+
+        ACSM_PATTERN** tail = &acsm->acsmStateTable[k].MatchList;
+
+        while ( cnt-- )
+        {
+            uint32_t idx;
+
+            if ( !db.get(idx) or idx >= pats.size() )
+            {
+                acsmUnload(acsm);
+                return false;
+            }
+
+            ACSM_PATTERN* px = (ACSM_PATTERN*)AC_MALLOC(sizeof(ACSM_PATTERN));
+            memcpy(px, pats[idx], sizeof(ACSM_PATTERN));
+            px->next = nullptr;
+
+            if ( used[idx] )
+                px->udata->ref_count++;
+            else
+                used[idx] = true;
+
+            *tail = px;
+            tail = &px->next;
+        }
+    }
+
+    // each pattern ends in some state so it must be on at least one list
+    if ( !db.done() or std::find(used.begin(), used.end(), false) != used.end() )
+    {
+        acsmUnload(acsm);
+        return false;
+    }
+
+    return true;
+}
+
 static void Print_DFA( ACSM_STRUCT * acsm )
 {
     int k;
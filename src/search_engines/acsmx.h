@@ -26,6 +26,7 @@
 // version 1
 
 #include <cstdint>
+#include <string>
 
 #include "search_common.h"
 
@@ -107,6 +108,12 @@ int acsmSearch(ACSM_STRUCT * acsm, const uint8_t* T,
 void acsmFree(ACSM_STRUCT* acsm);
 int acsmPatternCount(ACSM_STRUCT* acsm);
 
+// compiled state machine persistence; deserialize must follow the same
+// add pattern calls as the serialized instance and precede acsmCompile()
+bool acsmSerialize(const ACSM_STRUCT*, uint8_t*& buf, size_t& sz);
+bool acsmDeserialize(ACSM_STRUCT*, const uint8_t* buf, size_t sz);
+void acsmGetHash(const ACSM_STRUCT*, std::string&);
+
 int acsmPrintDetailInfo(ACSM_STRUCT*);
 
 int acsmPrintSummaryInfo();
@@ -119,11 +119,15 @@
 
 #include <cassert>
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 #include "log/messages.h"
 #include "utils/stats.h"
 #include "utils/util.h"
 
+#include "search_db.h"
+
 using namespace snort;
 
 #define printf LogMessage
@@ -1353,8 +1357,12 @@ static inline int _acsmCompile2(ACSM_STRUCT2* acsm)
 
 int acsmCompile2(SnortConfig* sc, ACSM_STRUCT2* acsm)
 {
-    if ( int rval = _acsmCompile2(acsm) )
-        return rval;
+    // state tables are already in place if loaded with acsmDeserialize2()
+    if ( !acsm->acsmNextState )
+    {
+        if ( int rval = _acsmCompile2(acsm) )
+            return rval;
+    }
 
     if ( acsm->agent )
         acsmBuildMatchStateTrees2(sc, acsm);
@@ -1998,6 +2006,437 @@ int acsmPatternCount2(ACSM_STRUCT2* acsm)
     return acsm->numPatterns;
 }
 
+/*
+*   Serialization
+*
+*   Database layout, all words are uint32_t unless noted:
+*     header     SearchDbHeader
+*     params     format, dfa, compress, alphabet size, patterns, states,
+*                sizeofstate, transitions, has fail states
+*     fail       acstate_t per state (nfa only)
+*     rows       per state: row size in bytes followed by the row as built
+*                by the Conv_* functions (no pointers, so used as is)
+*     matches    per state: count followed by pattern list indices
+*/
+#define ACSM2_DB_ID      "acsm2"
+#define ACSM2_DB_VERSION 1
+
+/*
+*   Return the size of a state row in bytes or 0 if it doesn't fit in avail.
+*/
+static size_t acsmRowSize2(const ACSM_STRUCT2* acsm, const acstate_t* p, size_t avail)
+{
+    size_t words;
+
+    if ( acsm->acsmFormat == ACF_FULL )
+    {
+        // only full format rows may be compressed to 1 or 2 byte states
+        size_t sz = acsm->sizeofstate * (acsm->acsmAlphabetSize + 2);
+        return sz <= avail ? sz : 0;
+    }
+
+    avail /= sizeof(acstate_t);
+
+    if ( avail < 3 )
+        return 0;
+
+    switch ( p[0] )
+    {
+    case ACF_FULL:
+        words = acsm->acsmAlphabetSize + 2;
+        break;
+
+    case ACF_SPARSE:
+        words = 3 + 2 * (size_t)p[2];
+        break;
+
+    case ACF_BANDED:
+        words = 4 + (size_t)p[2];
+        break;
+
+    case ACF_SPARSE_BANDS:
+        words = 3;
+
+        for ( acstate_t nb = p[2]; nb > 0; nb-- )
+        {
+            if ( words >= avail )
+                return 0;
+
+            words += 2 + (size_t)p[words];
+        }
+        break;
+
+    default:
+        return 0;
+    }
+
+    return words <= avail ? words * sizeof(acstate_t) : 0;
+}
+
+/*
+*   Check that every transition in a loaded row stays in the state table.
+*/
+static bool acsmValidState2(const ACSM_STRUCT2* acsm, acstate_t state, acstate_t nstates)
+{
+    return state < nstates or (!acsm->dfa and state == ACSM_FAIL_STATE2);
+}
+
+static bool acsmValidRow2(const ACSM_STRUCT2* acsm, const acstate_t* p, acstate_t nstates)
+{
+    if ( acsm->acsmFormat == ACF_FULL )
+    {
+        for ( int i = 0; i < acsm->acsmAlphabetSize; i++ )
+        {
+            acstate_t state;
+
+            switch ( acsm->sizeofstate )
+            {
+            case 1:  state = *((const uint8_t*)p + 2 + i); break;
+            case 2:  state = *((const uint16_t*)p + 2 + i); break;
+            default: state = p[2 + i]; break;
+            }
+
+            if ( !acsmValidState2(acsm, state, nstates) )
+                return false;
+        }
+        return true;
+    }
+
+    switch ( p[0] )
+    {
+    case ACF_FULL:
+        for ( int i = 0; i < acsm->acsmAlphabetSize; i++ )
+        {
+            if ( !acsmValidState2(acsm, p[2 + i], nstates) )
+                return false;
+        }
+        break;
+
+    case ACF_SPARSE:
+        for ( acstate_t i = 0; i < p[2]; i++ )
+        {
+            if ( !acsmValidState2(acsm, p[4 + 2 * (size_t)i], nstates) )
+                return false;
+        }
+        break;
+
+    case ACF_BANDED:
+        for ( acstate_t i = 0; i < p[2]; i++ )
+        {
+            if ( !acsmValidState2(acsm, p[4 + (size_t)i], nstates) )
+                return false;
+        }
+        break;
+
+    case ACF_SPARSE_BANDS:
+    {
+        // acsmRowSize2 already checked that the bands fit in the row
+        size_t words = 3;
+
+        for ( acstate_t nb = p[2]; nb > 0; nb-- )
+        {
+            acstate_t n = p[words];
+            words += 2;
+
+            for ( acstate_t i = 0; i < n; i++ )
+            {
+                if ( !acsmValidState2(acsm, p[words + i], nstates) )
+                    return false;
+            }
+            words += n;
+        }
+        break;
+    }
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+/*
+*   Release partially loaded state tables so the patterns can still be compiled.
+*/
+static void acsmUnload2(ACSM_STRUCT2* acsm)
+{
+    if ( acsm->acsmMatchList )
+    {
+        for ( int i = 0; i < acsm->acsmNumStates; i++ )
+        {
+            ACSM_PATTERN2* mlist = acsm->acsmMatchList[i];
+
+            while ( mlist )
+            {
+                ACSM_PATTERN2* ilist = mlist;
+                mlist = mlist->next;
+                AC_FREE(ilist, sizeof(ACSM_PATTERN2), ACSM2_MEMORY_TYPE__MATCHLIST);
+            }
+        }
+        AC_FREE(acsm->acsmMatchList, sizeof(ACSM_PATTERN2*) * acsm->acsmNumStates,
+            ACSM2_MEMORY_TYPE__MATCHLIST);
+    }
+
+    if ( acsm->acsmNextState )
+    {
+        for ( int i = 0; i < acsm->acsmNumStates; i++ )
+        {
+            acstate_t* p = acsm->acsmNextState[i];
+
+            if ( p )
+                AC_FREE_DFA(p, acsmRowSize2(acsm, p, SIZE_MAX), acsm->sizeofstate);
+        }
+        AC_FREE_DFA(acsm->acsmNextState, acsm->acsmNumStates * sizeof(acstate_t*),
+            acsm->sizeofstate);
+    }
+
+    AC_FREE(acsm->acsmFailState, sizeof(acstate_t) * acsm->acsmNumStates,
+        ACSM2_MEMORY_TYPE__FAILSTATE);
+
+    acsm->acsmMatchList = nullptr;
+    acsm->acsmNextState = nullptr;
+    acsm->acsmFailState = nullptr;
+    acsm->acsmNumStates = acsm->acsmMaxStates = 0;
+    acsm->acsmNumTrans = 0;
+}
+
+void acsmGetHash2(const ACSM_STRUCT2* acsm, std::string& hash)
+{
+    SearchDbHash h(ACSM2_DB_ID);
+
+    h.add(acsm->acsmFormat);
+    h.add(acsm->dfa);
+    h.add(acsm->compress_states);
+
+    for ( const ACSM_PATTERN2* p = acsm->acsmPatterns; p; p = p->next )
+    {
+        h.add(p->n);
+        h.add(p->casepatrn, p->n);
+        h.add(p->nocase);
+        h.add(p->negative);
+    }
+    h.get(hash);
+}
+
+bool acsmSerialize2(const ACSM_STRUCT2* acsm, uint8_t*& buf, size_t& sz)
+{
+    if ( !acsm->acsmNextState )
+        return false;
+
+    // match list entries are copies of the pattern list entries
+    std::unordered_map<const uint8_t*, uint32_t> index;
+    uint32_t n = 0;
+
+    for ( const ACSM_PATTERN2* p = acsm->acsmPatterns; p; p = p->next )
+        index[p->patrn] = n++;
+
+    SearchDbWriter db(ACSM2_DB_ID, ACSM2_DB_VERSION, sizeof(acstate_t));
+
+    db.put((uint32_t)acsm->acsmFormat);
+    db.put((uint32_t)acsm->dfa);
+    db.put((uint32_t)acsm->compress_states);
+    db.put((uint32_t)acsm->acsmAlphabetSize);
+    db.put((uint32_t)acsm->numPatterns);
+    db.put((uint32_t)acsm->acsmNumStates);
+    db.put((uint32_t)acsm->sizeofstate);
+    db.put((uint32_t)acsm->acsmNumTrans);
+    db.put((uint32_t)(acsm->acsmFailState != nullptr));
+
+    if ( acsm->acsmFailState )
+        db.put(acsm->acsmFailState, sizeof(acstate_t) * acsm->acsmNumStates);
+
+    for ( int k = 0; k < acsm->acsmNumStates; k++ )
+    {
+        const acstate_t* p = acsm->acsmNextState[k];
+        uint32_t len = acsmRowSize2(acsm, p, SIZE_MAX);
+
+        if ( !len )
+            return false;
+
+        db.put(len);
+        db.put(p, len);
+    }
+
+    for ( int k = 0; k < acsm->acsmNumStates; k++ )
+    {
+        uint32_t cnt = 0;
+
+        for ( const ACSM_PATTERN2* m = acsm->acsmMatchList[k]; m; m = m->next )
+            cnt++;
+
+        db.put(cnt);
+
+        for ( const ACSM_PATTERN2* m = acsm->acsmMatchList[k]; m; m = m->next )
+        {
+            auto it = index.find(m->patrn);
+
+            if ( it == index.end() )
+                return false;
+
+            db.put(it->second);
+        }
+    }
+
+    return db.finish(buf, sz);
+}
+
+bool acsmDeserialize2(ACSM_STRUCT2* acsm, const uint8_t* buf, size_t sz)
+{
+    if ( acsm->acsmNextState )
+        return false;
+
+    SearchDbReader db(buf, sz, ACSM2_DB_ID, ACSM2_DB_VERSION, sizeof(acstate_t));
+    uint32_t fmt, dfa, compress, asize, npats, nstates, sizeofstate, ntrans, has_fail;
+
+    if ( !db.get(fmt) or !db.get(dfa) or !db.get(compress) or !db.get(asize) or
+        !db.get(npats) or !db.get(nstates) or !db.get(sizeofstate) or !db.get(ntrans) or
+        !db.get(has_fail) )
+        return false;
+
+    if ( fmt != (uint32_t)acsm->acsmFormat or dfa != (uint32_t)acsm->dfa or
+        compress != (uint32_t)acsm->compress_states or
+        asize != (uint32_t)acsm->acsmAlphabetSize or npats != (uint32_t)acsm->numPatterns or
+        !nstates or nstates >= ACSM_FAIL_STATE2 or nstates > sz / sizeof(uint32_t) or
+        (sizeofstate != 1 and sizeofstate != 2 and sizeofstate != 4) )
+        return false;
+
+    std::vector<ACSM_PATTERN2*> pats;
+
+    for ( ACSM_PATTERN2* p = acsm->acsmPatterns; p; p = p->next )
+        pats.emplace_back(p);
+
+    acsm->acsmNumStates = acsm->acsmMaxStates = nstates;
+    acsm->acsmNumTrans = ntrans;
+    acsm->sizeofstate = sizeofstate;
+
+    acsm->acsmMatchList =
+        (ACSM_PATTERN2**)AC_MALLOC(sizeof(ACSM_PATTERN2*) * nstates,
+            ACSM2_MEMORY_TYPE__MATCHLIST);
+
+    acsm->acsmNextState =
+        (acstate_t**)AC_MALLOC_DFA(nstates * sizeof(acstate_t*), sizeofstate);
+
+    if ( has_fail )
+    {
+        acsm->acsmFailState =
+            (acstate_t*)AC_MALLOC(sizeof(acstate_t) * nstates, ACSM2_MEMORY_TYPE__FAILSTATE);
+
+        if ( !db.get(acsm->acsmFailState, sizeof(acstate_t) * nstates) )
+        {
+            acsmUnload2(acsm);
+            return false;
+        }
+
+        for ( uint32_t k = 0; k < nstates; k++ )
+        {
+            if ( acsm->acsmFailState[k] >= nstates )
+            {
+                acsmUnload2(acsm);
+                return false;
+            }
+        }
+    }
+    else if ( !acsm->dfa )
+    {
+        acsmUnload2(acsm);
+        return false;
+    }
+
+    for ( uint32_t k = 0; k < nstates; k++ )
+    {
+        uint32_t len;
+        const uint8_t* row;
+
+        if ( !db.get(len) or !(row = db.take(len)) or len < sizeof(acstate_t) )
+        {
+            acsmUnload2(acsm);
+            return false;
+        }
+
+        acstate_t* p = (acstate_t*)AC_MALLOC_DFA(len, sizeofstate);
+        memcpy(p, row, len);
+
+        if ( acsmRowSize2(acsm, p, len) != len or !acsmValidRow2(acsm, p, nstates) )
+        {
+            AC_FREE_DFA(p, len, sizeofstate);
+            acsmUnload2(acsm);
+            return false;
+        }
+
+        acsm->acsmNextState[k] = p;
+    }
+
+    for ( uint32_t k = 0; k < nstates; k++ )
+    {
+        uint32_t cnt;
+
+        if ( !db.get(cnt) )
+        {
+            acsmUnload2(acsm);
+            return false;
+        }
+
+        ACSM_PATTERN2** tail = &acsm->acsmMatchList[k];
+
+        while ( cnt-- )
+        {
+            uint32_t idx;
+
+            if ( !db.get(idx) or idx >= pats.size() )
+            {
+                acsmUnload2(acsm);
+                return false;
+            }
+
+            // same as AddMatchListEntry but preserve the serialized order
+            ACSM_PATTERN2* px = (ACSM_PATTERN2*)
+                AC_MALLOC(sizeof(ACSM_PATTERN2), ACSM2_MEMORY_TYPE__MATCHLIST);
+
+            memcpy(px, pats[idx], sizeof(ACSM_PATTERN2));
+            px->next = nullptr;
+
+            *tail = px;
+            tail = &px->next;
+        }
+    }
+
+    if ( !db.done() )
+    {
+        acsmUnload2(acsm);
+        return false;
+    }
+
+    for ( const ACSM_PATTERN2* p : pats )
+    {
+        summary.num_patterns++;
+        summary.num_characters += p->n;
+    }
+
+    if ( acsm->compress_states )
+    {
+        if ( sizeofstate == 1 )
+            summary.num_1byte_instances++;
+        else if ( sizeofstate == 2 )
+            summary.num_2byte_instances++;
+        else
+            summary.num_4byte_instances++;
+    }
+
+    for ( uint32_t k = 0; k < nstates; k++ )
+    {
+        if ( acsm->acsmMatchList[k] )
+            summary.num_match_states++;
+    }
+
+    summary.num_states += acsm->acsmNumStates;
+    summary.num_transitions += acsm->acsmNumTrans;
+    summary.num_instances++;
+
+    memcpy(&summary.acsm, acsm, sizeof(ACSM_STRUCT2));
+
+    return true;
+}
+
 static void Print_DFA_MatchList(ACSM_STRUCT2* acsm, int state)
 {
     ACSM_PATTERN2* mlist;
@@ -25,6 +25,7 @@
 // Version 2.0
 
 #include <cstdint>
+#include <string>
 
 #include "search_common.h"
 
@@ -165,6 +166,13 @@ int acsm_search_dfa_full_all(
 
 void acsmFree2(ACSM_STRUCT2*);
 int acsmPatternCount2(ACSM_STRUCT2*);
+
+// compiled state machine persistence; deserialize must follow the same
+// add pattern calls as the serialized instance and precede acsmCompile2()
+bool acsmSerialize2(const ACSM_STRUCT2*, uint8_t*& buf, size_t& sz);
+bool acsmDeserialize2(ACSM_STRUCT2*, const uint8_t* buf, size_t sz);
+void acsmGetHash2(const ACSM_STRUCT2*, std::string&);
+
 void acsmCompressStates(ACSM_STRUCT2*, int);
 
 void acsmPrintInfo2(ACSM_STRUCT2* p);
@@ -147,11 +147,15 @@
 #include "bnfa_search.h"
 
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 #include "log/messages.h"
 #include "utils/stats.h"
 #include "utils/util.h"
 
+#include "search_db.h"
+
 using namespace snort;
 
 /*
@@ -1456,8 +1460,12 @@ static inline int _bnfaCompile(bnfa_struct_t* bnfa)
 
 int bnfaCompile(SnortConfig* sc, bnfa_struct_t* bnfa)
 {
-    if ( int rval = _bnfaCompile (bnfa) )
-        return rval;
+    /* the transition list is already in place if loaded with bnfaDeserialize() */
+    if ( !bnfa->bnfaTransList )
+    {
+        if ( int rval = _bnfaCompile (bnfa) )
+            return rval;
+    }
 
     if ( bnfa->agent )
         bnfaBuildMatchStateTrees(sc, bnfa);
@@ -1643,6 +1651,291 @@ int bnfaPatternCount(bnfa_struct_t* p)
     return p->bnfaPatternCnt;
 }
 
+/*
+*   Serialization
+*
+*   Database layout, all words are uint32_t:
+*     header     SearchDbHeader
+*     params     case mode, format, alphabet size, force full zero state,
+*                patterns, states, transitions, match states, list words
+*     list       the compacted sparse transition list, as is - it already
+*                uses indices rather than pointers
+*     matches    per state: count followed by pattern list indices
+*
+*   Only the sparse format is supported.
+*/
+#define BNFA_DB_ID      "bnfa"
+#define BNFA_DB_VERSION 1
+
+/*
+*   Walk the transition list and return its size in words, or 0 if the
+*   rows don't fit in nps words or the state ids are out of sequence.
+*/
+static unsigned _bnfa_trans_list_size(const bnfa_state_t* ps, unsigned nstates, unsigned nps)
+{
+    unsigned ps_index = 0;
+
+    for ( unsigned k = 0; k < nstates; k++ )
+    {
+        if ( nps - ps_index < 2 or ps[ps_index] != k )
+            return 0;
+
+        ps_index++;  /* skip state word */
+
+        bnfa_state_t cw = ps[ps_index++];
+        unsigned nc;
+
+        if ( cw & BNFA_SPARSE_FULL_BIT )
+            nc = BNFA_MAX_ALPHABET_SIZE;
+        else
+            nc = (cw & BNFA_SPARSE_COUNT_BITS) >> BNFA_SPARSE_COUNT_SHIFT;
+
+        if ( nps - ps_index < nc )
+            return 0;
+
+        ps_index += nc;
+    }
+    return ps_index;
+}
+
+/*
+*   Check that a loaded transition list is well formed and that every
+*   fail and transition index refers to the start of a state row.
+*/
+static bool _bnfa_trans_list_valid(const bnfa_state_t* ps, unsigned nstates, unsigned nps)
+{
+    if ( _bnfa_trans_list_size(ps, nstates, nps) != nps )
+        return false;
+
+    std::vector<bool> row(nps, false);
+    unsigned ps_index = 0;
+
+    for ( unsigned k = 0; k < nstates; k++ )
+    {
+        row[ps_index] = true;
+        ps_index++;
+
+        bnfa_state_t cw = ps[ps_index++];
+
+        if ( cw & BNFA_SPARSE_FULL_BIT )
+            ps_index += BNFA_MAX_ALPHABET_SIZE;
+        else
+            ps_index += (cw & BNFA_SPARSE_COUNT_BITS) >> BNFA_SPARSE_COUNT_SHIFT;
+    }
+
+    ps_index = 0;
+
+    for ( unsigned k = 0; k < nstates; k++ )
+    {
+        ps_index++;
+
+        bnfa_state_t cw = ps[ps_index];
+        unsigned nc = (cw & BNFA_SPARSE_FULL_BIT) ? BNFA_MAX_ALPHABET_SIZE :
+            (cw & BNFA_SPARSE_COUNT_BITS) >> BNFA_SPARSE_COUNT_SHIFT;
+
+        /* control word fail state and then the transitions */
+        for ( unsigned i = 0; i <= nc; i++, ps_index++ )
+        {
+            unsigned next = ps[ps_index] & BNFA_SPARSE_MAX_STATE;
+
+            if ( next >= nps or !row[next] )
+                return false;
+        }
+    }
+    return true;
+}
+
+/*
+*   Release a partially loaded state machine so the patterns can still be compiled.
+*/
+static void _bnfa_unload(bnfa_struct_t* bnfa, unsigned nps)
+{
+    if ( bnfa->bnfaMatchList )
+    {
+        for ( int i = 0; i < bnfa->bnfaNumStates; i++ )
+        {
+            bnfa_match_node_t* mlist = bnfa->bnfaMatchList[i];
+
+            while ( mlist )
+            {
+                bnfa_match_node_t* ilist = mlist;
+                mlist = mlist->next;
+                BNFA_FREE(ilist,sizeof(bnfa_match_node_t),bnfa->matchlist_memory);
+            }
+        }
+        BNFA_FREE(bnfa->bnfaMatchList,bnfa->bnfaNumStates*sizeof(bnfa_match_node_t*),
+            bnfa->matchlist_memory);
+    }
+
+    BNFA_FREE(bnfa->bnfaTransList,nps*sizeof(bnfa_state_t),bnfa->nextstate_memory);
+
+    bnfa->bnfaMatchList = nullptr;
+    bnfa->bnfaTransList = nullptr;
+    bnfa->bnfaNumStates = bnfa->bnfaMaxStates = 0;
+    bnfa->bnfaNumTrans = bnfa->bnfaMatchStates = 0;
+}
+
+void bnfaGetHash(const bnfa_struct_t* bnfa, std::string& hash)
+{
+    SearchDbHash h(BNFA_DB_ID);
+
+    h.add(bnfa->bnfaCaseMode);
+    h.add(bnfa->bnfaFormat);
+    h.add(bnfa->bnfaForceFullZeroState);
+
+    for ( const bnfa_pattern_t* p = bnfa->bnfaPatterns; p; p = p->next )
+    {
+        h.add(p->n);
+        h.add(p->casepatrn, p->n);
+        h.add(p->nocase);
+        h.add(p->negative);
+    }
+    h.get(hash);
+}
+
+bool bnfaSerialize(const bnfa_struct_t* bnfa, uint8_t*& buf, size_t& sz)
+{
+    if ( !bnfa->bnfaTransList or bnfa->bnfaFormat != BNFA_SPARSE )
+        return false;
+
+    std::unordered_map<const bnfa_pattern_t*, uint32_t> index;
+    uint32_t n = 0;
+
+    for ( const bnfa_pattern_t* p = bnfa->bnfaPatterns; p; p = p->next )
+        index[p] = n++;
+
+    unsigned nps = _bnfa_trans_list_size(
+        bnfa->bnfaTransList, bnfa->bnfaNumStates, BNFA_SPARSE_MAX_STATE);
+
+    if ( !nps )
+        return false;
+
+    SearchDbWriter db(BNFA_DB_ID, BNFA_DB_VERSION, sizeof(bnfa_state_t));
+
+    db.put((uint32_t)bnfa->bnfaCaseMode);
+    db.put((uint32_t)bnfa->bnfaFormat);
+    db.put((uint32_t)bnfa->bnfaAlphabetSize);
+    db.put((uint32_t)bnfa->bnfaForceFullZeroState);
+    db.put((uint32_t)bnfa->bnfaPatternCnt);
+    db.put((uint32_t)bnfa->bnfaNumStates);
+    db.put((uint32_t)bnfa->bnfaNumTrans);
+    db.put((uint32_t)bnfa->bnfaMatchStates);
+    db.put((uint32_t)nps);
+
+    db.put(bnfa->bnfaTransList, nps*sizeof(bnfa_state_t));
+
+    for ( int k = 0; k < bnfa->bnfaNumStates; k++ )
+    {
+        uint32_t cnt = 0;
+
+        for ( const bnfa_match_node_t* m = bnfa->bnfaMatchList[k]; m; m = m->next )
+            cnt++;
+
+        db.put(cnt);
+
+        for ( const bnfa_match_node_t* m = bnfa->bnfaMatchList[k]; m; m = m->next )
+        {
+            auto it = index.find((const bnfa_pattern_t*)m->data);
+
+            if ( it == index.end() )
+                return false;
+
+            db.put(it->second);
+        }
+    }
+
+    return db.finish(buf, sz);
+}
+
+bool bnfaDeserialize(bnfa_struct_t* bnfa, const uint8_t* buf, size_t sz)
+{
+    if ( bnfa->bnfaTransList or bnfa->bnfaFormat != BNFA_SPARSE )
+        return false;
+
+    SearchDbReader db(buf, sz, BNFA_DB_ID, BNFA_DB_VERSION, sizeof(bnfa_state_t));
+    uint32_t mode, fmt, asize, fzs, npats, nstates, ntrans, nmatch, nps;
+
+    if ( !db.get(mode) or !db.get(fmt) or !db.get(asize) or !db.get(fzs) or
+        !db.get(npats) or !db.get(nstates) or !db.get(ntrans) or !db.get(nmatch) or
+        !db.get(nps) )
+        return false;
+
+    if ( mode != (uint32_t)bnfa->bnfaCaseMode or fmt != (uint32_t)bnfa->bnfaFormat or
+        asize != (uint32_t)bnfa->bnfaAlphabetSize or
+        fzs != (uint32_t)bnfa->bnfaForceFullZeroState or npats != bnfa->bnfaPatternCnt or
+        !nstates or nstates > BNFA_SPARSE_MAX_STATE or !nps or nps > BNFA_SPARSE_MAX_STATE )
+        return false;
+
+    const uint8_t* list = db.take(nps*sizeof(bnfa_state_t));
+
+    if ( !list )
+        return false;
+
+    std::vector<bnfa_pattern_t*> pats;
+
+    for ( bnfa_pattern_t* p = bnfa->bnfaPatterns; p; p = p->next )
+        pats.emplace_back(p);
+
+    bnfa->bnfaNumStates = bnfa->bnfaMaxStates = nstates;
+
+    bnfa->bnfaTransList = BNFA_MALLOC(nps*sizeof(bnfa_state_t),bnfa->nextstate_memory);
+    memcpy(bnfa->bnfaTransList, list, nps*sizeof(bnfa_state_t));
+
+    bnfa->bnfaMatchList = (bnfa_match_node_t**)BNFA_MALLOC(
+        nstates*sizeof(bnfa_match_node_t*),bnfa->matchlist_memory);
+
+    if ( !_bnfa_trans_list_valid(bnfa->bnfaTransList, nstates, nps) )
+    {
+        _bnfa_unload(bnfa, nps);
+        return false;
+    }
+
+    for ( uint32_t k = 0; k < nstates; k++ )
+    {
+        uint32_t cnt;
+
+        if ( !db.get(cnt) )
+        {
+            _bnfa_unload(bnfa, nps);
+            return false;
+        }
+
+        bnfa_match_node_t** tail = &bnfa->bnfaMatchList[k];
+
+        while ( cnt-- )
+        {
+            uint32_t idx;
+
+            if ( !db.get(idx) or idx >= pats.size() )
+            {
+                _bnfa_unload(bnfa, nps);
+                return false;
+            }
+
+            /* preserve the serialized order */
+            bnfa_match_node_t* pmn = (bnfa_match_node_t*)BNFA_MALLOC(
+                sizeof(bnfa_match_node_t),bnfa->matchlist_memory);
+
+            pmn->data = pats[idx];
+            *tail = pmn;
+            tail = &pmn->next;
+        }
+    }
+
+    if ( !db.done() )
+    {
+        _bnfa_unload(bnfa, nps);
+        return false;
+    }
+
+    bnfa->bnfaNumTrans = ntrans;
+    bnfa->bnfaMatchStates = nmatch;
+
+    bnfaAccumInfo(bnfa);
+
+    return true;
+}
+
 static bnfa_struct_t summary;
 static int summary_cnt = 0;
 
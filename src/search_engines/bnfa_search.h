@@ -31,6 +31,7 @@
 */
 
 #include <cstdint>
+#include <string>
 
 #include "search_common.h"
 
@@ -176,6 +177,12 @@ unsigned _bnfa_search_csparse_nfa(
 
 int bnfaPatternCount(bnfa_struct_t* p);
 
+/* compiled state machine persistence; deserialize must follow the same
+   add pattern calls as the serialized instance and precede bnfaCompile() */
+bool bnfaSerialize(const bnfa_struct_t*, uint8_t*& buf, size_t& sz);
+bool bnfaDeserialize(bnfa_struct_t*, const uint8_t* buf, size_t sz);
+void bnfaGetHash(const bnfa_struct_t*, std::string&);
+
 void bnfaPrint(bnfa_struct_t* pstruct);   /* prints the nfa states-verbose!! */
 void bnfaPrintInfo(bnfa_struct_t* pstruct);    /* print info on this search engine */
 
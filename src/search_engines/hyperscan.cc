@@ -242,6 +242,14 @@ int HyperscanMpse::prep_patterns(SnortConfig* sc)
 {
     if ( hs_db )
     {
+        // loaded from a rule db or reused on reload; scratch must still
+        // be sized for it
+        if ( hs_error_t err = hs_alloc_scratch(hs_db, &s_scratch[get_instance_id()]) )
+        {
+            ParseError("can't allocate search scratch space (%d)", err);
+            return -3;
+        }
+
         if ( agent )
             user_ctor(sc);
 
@@ -0,0 +1,166 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+#ifndef SEARCH_DB_H
+#define SEARCH_DB_H
+
+// helpers for Mpse::serialize / deserialize / get_hash of the native
+// Aho-Corasick engines.  a database is a header followed by a flat run of
+// native endian words.  states and patterns are stored as indices, never
+// as pointers, so the image is relocatable and can be read directly from
+// an mmapped file.  the header identifies the engine, layout version and
+// word size so a database from another engine or build is rejected.
+//
+// patterns are referenced by their position in the engine's pattern list.
+// that order is fixed by the order of add_pattern() calls which is part of
+// the hash so a database is only loaded for an identical pattern set.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hash/hashes.h"
+
+#define SEARCH_DB_ID_SIZE 8
+
+struct SearchDbHeader
+{
+    char id[SEARCH_DB_ID_SIZE];
+    uint32_t version;
+    uint32_t word_size;
+};
+
+class SearchDbWriter
+{
+public:
+    SearchDbWriter(const char* id, uint32_t version, uint32_t word_size)
+    {
+        SearchDbHeader h = { };
+        strncpy(h.id, id, sizeof(h.id) - 1);
+        h.version = version;
+        h.word_size = word_size;
+        put(h);
+    }
+
+    template<typename T>
+    void put(const T& v)
+    { put(&v, sizeof(v)); }
+
+    void put(const void* p, size_t n)
+    {
+        const uint8_t* b = (const uint8_t*)p;
+        buf.insert(buf.end(), b, b + n);
+    }
+
+    // the returned buffer must be released with free()
+    bool finish(uint8_t*& out, size_t& sz) const
+    {
+        out = (uint8_t*)malloc(buf.size());
+
+        if ( !out )
+            return false;
+
+        memcpy(out, buf.data(), buf.size());
+        sz = buf.size();
+        return true;
+    }
+
+private:
+    std::vector<uint8_t> buf;
+};
+
+class SearchDbReader
+{
+public:
+    SearchDbReader(const uint8_t* p, size_t n, const char* id, uint32_t version, uint32_t word_size)
+    {
+        cur = p;
+        end = p + n;
+
+        SearchDbHeader h;
+
+        if ( !get(h) or strncmp(h.id, id, sizeof(h.id)) or
+            h.version != version or h.word_size != word_size )
+            cur = end = nullptr;
+    }
+
+    bool ok() const
+    { return cur != nullptr; }
+
+    bool done() const
+    { return cur and cur == end; }
+
+    template<typename T>
+    bool get(T& v)
+    { return get(&v, sizeof(v)); }
+
+    bool get(void* p, size_t n)
+    {
+        const uint8_t* b = take(n);
+
+        if ( !b )
+            return false;
+
+        memcpy(p, b, n);
+        return true;
+    }
+
+    // returns a pointer into the image, not a copy
+    const uint8_t* take(size_t n)
+    {
+        if ( !cur or (size_t)(end - cur) < n )
+            return nullptr;
+
+        const uint8_t* b = cur;
+        cur += n;
+        return b;
+    }
+
+private:
+    const uint8_t* cur;
+    const uint8_t* end;
+};
+
+class SearchDbHash
+{
+public:
+    SearchDbHash(const char* id)
+    { data = id; }
+
+    template<typename T>
+    void add(const T& v)
+    { add(&v, sizeof(v)); }
+
+    void add(const void* p, size_t n)
+    { data.append((const char*)p, n); }
+
+    void get(std::string& hash) const
+    {
+        uint8_t buf[MD5_HASH_SIZE];
+        snort::md5((const uint8_t*)data.c_str(), data.size(), buf);
+        hash.assign((const char*)buf, sizeof(buf));
+    }
+
+private:
+    std::string data;
+};
+
+#endif
+
@@ -0,0 +1,435 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// search_engines_benchmark.cc
+// benchmarks for the search engines
+//
+// each engine is built from the same synthetic pattern set and searches
+// synthetic payloads.  set SNORT_BENCHMARK_PCAP to a pcap file to also
+// search the TCP and UDP payloads it contains.
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "framework/base_api.h"
+#include "framework/counts.h"
+#include "framework/module.h"
+#include "framework/mpse.h"
+#include "framework/mpse_batch.h"
+#include "helpers/scratch_allocator.h"
+#include "main/snort_config.h"
+#include "utils/stats.h"
+
+using namespace snort;
+
+//-------------------------------------------------------------------------
+// stubs
+//-------------------------------------------------------------------------
+
+namespace snort
+{
+SnortConfig s_conf;
+THREAD_LOCAL SnortConfig* snort_conf = &s_conf;
+
+static std::vector<void *> s_state;
+static ScratchAllocator* scratcher = nullptr;
+
+SnortConfig::SnortConfig(const SnortConfig* const, const char*)
+{
+    state = &s_state;
+    num_slots = 1;
+    fast_pattern_config = nullptr;
+}
+
+SnortConfig::~SnortConfig() = default;
+
+int SnortConfig::request_scratch(ScratchAllocator* s)
+{
+    scratcher = s;
+    s_state.resize(1);
+    return 0;
+}
+
+void SnortConfig::release_scratch(int)
+{
+    scratcher = nullptr;
+    s_state.clear();
+    s_state.shrink_to_fit();
+}
+
+const SnortConfig* SnortConfig::get_conf()
+{ return snort_conf; }
+
+unsigned get_instance_id()
+{ return 0; }
+
+void LogValue(const char*, const char*, FILE*) { }
+void LogMessage(const char*, ...) { }
+void ParseError(const char*, ...) { }
+void ErrorMessage(const char*, ...) { }
+[[noreturn]] void FatalError(const char*,...) { exit(1); }
+void LogCount(char const*, uint64_t, FILE*) { }
+void LogStat(const char*, double, FILE*) { }
+void md5(const unsigned char*, size_t, unsigned char*) { }
+
+Mpse::Mpse(const char*) { }
+
+int Mpse::search(
+    const unsigned char* T, int n, MpseMatch match,
+    void* context, int* current_state)
+{
+    return _search(T, n, match, context, current_state);
+}
+
+int Mpse::search_all(
+    const unsigned char* T, int n, MpseMatch match,
+    void* context, int* current_state)
+{
+    return _search(T, n, match, context, current_state);
+}
+
+void Mpse::search(MpseBatch&, MpseType) { }
+void Mpse::_search(MpseBatch&, MpseType) { }
+}
+
+void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
+void show_stats(PegCount*, const PegInfo*, const IndexVec&, const char*, FILE*) { }
+
+extern const BaseApi* se_ac_bnfa[];
+extern const BaseApi* se_ac_std[];
+extern const BaseApi* se_ac_banded;
+extern const BaseApi* se_ac_full;
+extern const BaseApi* se_ac_sparse;
+extern const BaseApi* se_ac_sparse_bands;
+#ifdef HAVE_HYPERSCAN
+extern const BaseApi* se_hyperscan[];
+#endif
+
+static void* s_tree = (void*)"tree";
+static void* s_list = (void*)"list";
+
+static MpseAgent s_agent =
+{
+    [](SnortConfig*, void*, void** ppt)
+    {
+        *ppt = s_tree;
+        return 0;
+    },
+    [](void*, void** ppl)
+    {
+        *ppl = s_list;
+        return 0;
+    },
+
+    [](void*) { },
+    [](void**) { },
+    [](void**) { }
+};
+
+static int match(void*, void*, int, void* context, void*)
+{
+    ++*(unsigned*)context;
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+// data
+//-------------------------------------------------------------------------
+
+#define NUM_PATTERNS 2000
+#define PAYLOAD_SIZE 1460
+#define NUM_PAYLOADS 64
+
+typedef std::vector<std::string> Payloads;
+
+static const std::vector<std::string>& get_patterns()
+{
+    static std::vector<std::string> patterns;
+
+    if ( patterns.empty() )
+    {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> len(4, 16);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::uniform_int_distribution<int> alpha('a', 'z');
+
+        for ( unsigned i = 0; i < NUM_PATTERNS; ++i )
+        {
+            std::string s;
+            int n = len(rng);
+
+            // mostly text like rule content with some binary
+            for ( int j = 0; j < n; ++j )
+                s += (i % 4) ? (char)alpha(rng) : (char)byte(rng);
+
+            patterns.emplace_back(s);
+        }
+    }
+    return patterns;
+}
+
+static Payloads make_binary_payloads()
+{
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> byte(0, 255);
+    Payloads v;
+
+    for ( unsigned i = 0; i < NUM_PAYLOADS; ++i )
+    {
+        std::string s;
+
+        for ( unsigned j = 0; j < PAYLOAD_SIZE; ++j )
+            s += (char)byte(rng);
+
+        v.emplace_back(s);
+    }
+    return v;
+}
+
+// text with a pattern planted every few hundred bytes
+static Payloads make_text_payloads()
+{
+    const std::vector<std::string>& patterns = get_patterns();
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> alpha('a', 'z');
+    std::uniform_int_distribution<unsigned> pick(0, NUM_PATTERNS - 1);
+    Payloads v;
+
+    for ( unsigned i = 0; i < NUM_PAYLOADS; ++i )
+    {
+        std::string s;
+
+        while ( s.size() < PAYLOAD_SIZE )
+        {
+            if ( s.size() % 256 < 16 )
+                s += patterns[pick(rng)];
+            else
+                s += (char)alpha(rng);
+        }
+        s.resize(PAYLOAD_SIZE);
+        v.emplace_back(s);
+    }
+    return v;
+}
+
+// minimal pcap reader for ethernet, ipv4 / ipv6, tcp / udp
+static uint32_t get32(const uint8_t* p, bool swap)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+static void add_payload(const uint8_t* p, size_t n, Payloads& v)
+{
+    size_t off = 14;
+
+    if ( n < off )
+        return;
+
+    uint16_t type = (p[12] << 8) | p[13];
+
+    if ( type == 0x8100 and n >= off + 4 )
+    {
+        type = (p[16] << 8) | p[17];
+        off += 4;
+    }
+
+    uint8_t proto;
+
+    if ( type == 0x0800 and n >= off + 20 )
+    {
+        proto = p[off + 9];
+        off += (p[off] & 0x0f) * 4;
+    }
+    else if ( type == 0x86dd and n >= off + 40 )
+    {
+        proto = p[off + 6];
+        off += 40;
+    }
+    else
+        return;
+
+    if ( proto == 6 and n >= off + 20 )
+        off += (p[off + 12] >> 4) * 4;
+
+    else if ( proto == 17 )
+        off += 8;
+
+    else
+        return;
+
+    if ( n > off )
+        v.emplace_back((const char*)p + off, n - off);
+}
+
+static Payloads load_pcap_payloads()
+{
+    Payloads v;
+    const char* file = getenv("SNORT_BENCHMARK_PCAP");
+
+    if ( !file )
+        return v;
+
+    std::ifstream in(file, std::ios::binary);
+    std::string buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const uint8_t* p = (const uint8_t*)buf.data();
+
+    if ( buf.size() < 24 )
+        return v;
+
+    uint32_t magic = get32(p, false);
+    bool swap;
+
+    if ( magic == 0xa1b2c3d4 or magic == 0xa1b23c4d )
+        swap = false;
+
+    else if ( magic == 0xd4c3b2a1 or magic == 0x4d3cb2a1 )
+        swap = true;
+
+    else
+        return v;
+
+    size_t off = 24;
+
+    while ( off + 16 <= buf.size() )
+    {
+        uint32_t caplen = get32(p + off + 8, swap);
+        off += 16;
+
+        if ( caplen > buf.size() - off )
+            break;
+
+        add_payload(p + off, caplen, v);
+        off += caplen;
+    }
+    return v;
+}
+
+//-------------------------------------------------------------------------
+// benchmarks
+//-------------------------------------------------------------------------
+
+class Engine
+{
+public:
+    Engine(const BaseApi* api)
+    {
+        mpse_api = (const MpseApi*)api;
+        mod = mpse_api->base.mod_ctor ? mpse_api->base.mod_ctor() : nullptr;
+
+        if ( mpse_api->init )
+            mpse_api->init();
+
+        mpse = mpse_api->ctor(snort_conf, mod, &s_agent);
+
+        Mpse::PatternDescriptor desc;
+
+        for ( const auto& s : get_patterns() )
+            mpse->add_pattern((const uint8_t*)s.data(), s.size(), desc, nullptr);
+
+        mpse->prep_patterns(snort_conf);
+
+        if ( scratcher )
+            scratch = scratcher->setup(snort_conf);
+    }
+
+    ~Engine()
+    {
+        if ( scratch )
+            scratcher->cleanup(snort_conf);
+
+        mpse_api->dtor(mpse);
+
+        if ( mod )
+            mpse_api->base.mod_dtor(mod);
+    }
+
+    unsigned search(const Payloads& v)
+    {
+        unsigned hits = 0;
+
+        for ( const auto& s : v )
+        {
+            int state = 0;
+            mpse->search((const uint8_t*)s.data(), s.size(), match, &hits, &state);
+        }
+        return hits;
+    }
+
+private:
+    const MpseApi* mpse_api;
+    Module* mod;
+    Mpse* mpse;
+    bool scratch = false;
+};
+
+static void run(const char* name, const BaseApi* api)
+{
+    static const Payloads binary = make_binary_payloads();
+    static const Payloads text = make_text_payloads();
+    static const Payloads pcap = load_pcap_payloads();
+
+    Engine eng(api);
+
+    BENCHMARK(std::string(name) + " binary")
+    { return eng.search(binary); };
+
+    BENCHMARK(std::string(name) + " text")
+    { return eng.search(text); };
+
+    if ( !pcap.empty() )
+    {
+        BENCHMARK(std::string(name) + " pcap")
+        { return eng.search(pcap); };
+    }
+}
+
+TEST_CASE("ac_bnfa", "[search_engines]")
+{ run("ac_bnfa", se_ac_bnfa[0]); }
+
+TEST_CASE("ac_std", "[search_engines]")
+{ run("ac_std", se_ac_std[0]); }
+
+TEST_CASE("ac_full", "[search_engines]")
+{ run("ac_full", se_ac_full); }
+
+TEST_CASE("ac_sparse", "[search_engines]")
+{ run("ac_sparse", se_ac_sparse); }
+
+TEST_CASE("ac_banded", "[search_engines]")
+{ run("ac_banded", se_ac_banded); }
+
+TEST_CASE("ac_sparse_bands", "[search_engines]")
+{ run("ac_sparse_bands", se_ac_sparse_bands); }
+
+#ifdef HAVE_HYPERSCAN
+TEST_CASE("hyperscan", "[search_engines]")
+{ run("hyperscan", se_hyperscan[0]); }
+#endif
+
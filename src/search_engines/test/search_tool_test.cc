@@ -33,8 +33,10 @@
 #include "framework/base_api.h"
 #include "framework/mpse.h"
 #include "framework/mpse_batch.h"
+#include "hash/hashes.h"
 #include "main/snort_config.h"
 #include "managers/mpse_manager.h"
+#include "search_engines/search_db.h"
 
 // must appear after snort_config.h to avoid broken c++ map include
 #include <CppUTest/CommandLineTestRunner.h>
@@ -75,6 +77,14 @@ void LogMessage(const char*, ...) { }
 void LogCount(char const*, uint64_t, FILE*) { }
 void LogStat(const char*, double, FILE*) { }
 
+void md5(const unsigned char* data, size_t size, unsigned char* digest)
+{
+    memset(digest, 0, MD5_HASH_SIZE);
+
+    for ( size_t i = 0; i < size; ++i )
+        digest[i % MD5_HASH_SIZE] ^= data[i] + i;
+}
+
 static void* s_tree = (void*)"tree";
 static void* s_list = (void*)"list";
 
@@ -123,6 +133,10 @@ const char* FastPatternConfig::get_search_method()
 
 extern const BaseApi* se_ac_bnfa;
 extern const BaseApi* se_ac_full;
+extern const BaseApi* se_ac_sparse;
+extern const BaseApi* se_ac_banded;
+extern const BaseApi* se_ac_sparse_bands;
+extern const BaseApi* se_ac_std[];
 Mpse* mpse = nullptr;
 
 void MpseManager::delete_search_engine(Mpse* eng)
@@ -155,6 +169,18 @@ bool MpseGroup::create_normal_mpse(const SnortConfig*, const char* type)
     else if ( !strcmp(type, "ac_full") )
         api = (const MpseApi*) se_ac_full;
 
+    else if ( !strcmp(type, "ac_sparse") )
+        api = (const MpseApi*) se_ac_sparse;
+
+    else if ( !strcmp(type, "ac_banded") )
+        api = (const MpseApi*) se_ac_banded;
+
+    else if ( !strcmp(type, "ac_sparse_bands") )
+        api = (const MpseApi*) se_ac_sparse_bands;
+
+    else if ( !strcmp(type, "ac_std") )
+        api = (const MpseApi*) se_ac_std[0];
+
     else
         return false;
 
@@ -200,6 +226,129 @@ static int Test_SearchStrFound(
     return s_found == -1;
 }
 
+static SearchTool* new_tool(const char* method, bool dfa, bool all = true)
+{
+    SearchTool::set_conf(snort_conf);
+    SearchTool* stool = new SearchTool(method, dfa);
+    SearchTool::set_conf(nullptr);
+
+    stool->add("the", 3, 1);
+    stool->add("tuba", 4, 77);
+    stool->add("uba", 3, 78);
+    stool->add("away", 4, 2112);
+
+    if ( all )
+        stool->add("nothere", 7, 1000);
+
+    return stool;
+}
+
+// serialize the prepped tool and check a copy loaded from the image
+// finds the same matches without compiling
+static void check_db(SearchTool* stool, const char* method, bool dfa)
+{
+    Mpse* mpse = stool->mpsegrp->normal_mpse;
+    uint8_t* buf = nullptr;
+    size_t len = 0;
+
+    CHECK(mpse->serialize(buf, len));
+    CHECK(buf and len);
+
+    SearchTool* copy = new_tool(method, dfa);
+    Mpse* cpse = copy->mpsegrp->normal_mpse;
+
+    std::string h1, h2;
+    mpse->get_hash(h1);
+    cpse->get_hash(h2);
+    CHECK(!h1.empty() and h1 == h2);
+
+    CHECK(!cpse->deserialize(buf, len - 1));
+    CHECK(cpse->deserialize(buf, len));
+    CHECK(!cpse->deserialize(buf, len));
+    copy->prep();
+
+    //                     0         1         2         3
+    //                     0123456789012345678901234567890
+    const char* datastr = "the tuba ran away with the tuna";
+    const ExpectedMatch xm[] =
+    {
+        { 1, 3 },
+        { 78, 8 },
+        { 2112, 17 },
+        { 1, 26 },
+        { 0, 0 }
+    };
+
+    s_expect = xm;
+    s_found = 0;
+
+    int result = copy->find(datastr, strlen(datastr), Test_SearchStrFound);
+
+    CHECK(result == 4);
+    CHECK(s_found == 4);
+
+    uint8_t* cbuf = nullptr;
+    size_t clen = 0;
+
+    CHECK(cpse->serialize(cbuf, clen));
+    CHECK(clen == len and !memcmp(buf, cbuf, len));
+
+    free(cbuf);
+    delete copy;
+
+    // a different pattern set must be rejected
+    SearchTool* other = new_tool(method, dfa, false);
+    Mpse* opse = other->mpsegrp->normal_mpse;
+
+    opse->get_hash(h2);
+    CHECK(h1 != h2);
+    CHECK(!opse->deserialize(buf, len));
+    delete other;
+
+    free(buf);
+}
+
+static int no_match(void*, void*, int, void*, void*)
+{ return 0; }
+
+// a damaged image must either be rejected or load tables that the search
+// can walk safely.  each word after the header is overwritten in turn with
+// a state far beyond the end of the table.
+static void check_bad_db(const char* method, bool dfa)
+{
+    SearchTool* stool = new_tool(method, dfa);
+    stool->prep();
+
+    uint8_t* buf = nullptr;
+    size_t len = 0;
+
+    CHECK(stool->mpsegrp->normal_mpse->serialize(buf, len));
+    CHECK(buf and len > sizeof(SearchDbHeader));
+
+    const char* datastr = "the tuba ran away with the tuna";
+    const uint32_t bad_state = 0x10000;
+    std::vector<uint8_t> bad(len);
+
+    for ( size_t off = sizeof(SearchDbHeader); off + sizeof(bad_state) <= len;
+        off += sizeof(bad_state) )
+    {
+        memcpy(bad.data(), buf, len);
+        memcpy(bad.data() + off, &bad_state, sizeof(bad_state));
+
+        SearchTool* copy = new_tool(method, dfa);
+
+        if ( copy->mpsegrp->normal_mpse->deserialize(bad.data(), len) )
+        {
+            copy->prep();
+            copy->find_all(datastr, strlen(datastr), no_match);
+        }
+        delete copy;
+    }
+
+    free(buf);
+    delete stool;
+}
+
 //-------------------------------------------------------------------------
 // ac_bnfa tests
 //-------------------------------------------------------------------------
@@ -292,6 +441,16 @@ TEST(search_tool_bnfa, search_all)
     CHECK(s_found == 4);
 }
 
+TEST(search_tool_bnfa, serialize)
+{
+    check_db(stool, "ac_bnfa", false);
+}
+
+TEST(search_tool_bnfa, bad_db)
+{
+    check_bad_db("ac_bnfa", false);
+}
+
 //-------------------------------------------------------------------------
 // ac_full tests
 //-------------------------------------------------------------------------
@@ -385,6 +544,59 @@ TEST(search_tool_full, search_all)
     CHECK(s_found == 5);
 }
 
+TEST(search_tool_full, serialize)
+{
+    check_db(stool, "ac_full", true);
+}
+
+TEST(search_tool_full, bad_db)
+{
+    check_bad_db("ac_full", true);
+    check_bad_db("ac_full", false);
+}
+
+//-------------------------------------------------------------------------
+// other formats; these only check that the tables survive a round trip
+// since the search itself is covered above
+//-------------------------------------------------------------------------
+
+TEST_GROUP(search_tool_db)
+{
+    void check(const char* method, bool dfa)
+    {
+        SearchTool* stool = new_tool(method, dfa);
+        stool->prep();
+
+        check_db(stool, method, dfa);
+        check_bad_db(method, dfa);
+
+        delete stool;
+    }
+};
+
+TEST(search_tool_db, ac_std)
+{
+    check("ac_std", true);
+}
+
+TEST(search_tool_db, ac_sparse)
+{
+    check("ac_sparse", true);
+    check("ac_sparse", false);
+}
+
+TEST(search_tool_db, ac_banded)
+{
+    check("ac_banded", true);
+    check("ac_banded", false);
+}
+
+TEST(search_tool_db, ac_sparse_bands)
+{
+    check("ac_sparse_bands", true);
+    check("ac_sparse_bands", false);
+}
+
 //-------------------------------------------------------------------------
 // main
 //-------------------------------------------------------------------------
@@ -87,30 +87,31 @@ public:
     void reload_prune(size_t new_size)
     {
         Purgatory data;
-        std::lock_guard<std::mutex> cache_lock(cache_mutex);
+        LruBase::lock();
         max_size = new_size;
-        while (current_size > max_size && !list.empty())
+        for ( auto& shard : shards )
         {
-            LruListIter list_iter = --list.end();
-            data.emplace_back(list_iter->second); // increase reference count
-            // This instructs the session_tracker to take a lock before detaching
-            // from ssd, when it is getting destroyed.
-            list_iter->second->set_reload_prune(true);
-            decrease_size(list_iter->second.get());
-            map.erase(list_iter->first);
-            list.erase(list_iter);
-            ++stats.reload_prunes;
+            while (current_size > max_size && !shard.list.empty())
+            {
+                LruListIter list_iter = --shard.list.end();
+                data.emplace_back(list_iter->second); // increase reference count
+                // This instructs the session_tracker to take a lock before detaching
+                // from ssd, when it is getting destroyed.
+                list_iter->second->set_reload_prune(true);
+                decrease_size(list_iter->second.get());
+                shard.map.erase(list_iter->first);
+                shard.list.erase(list_iter);
+                ++shard.stats.reload_prunes;
+            }
         }
+        LruBase::unlock();
     }
 
 private:
     using LruBase = LruCacheShared<Key, Value, Hash, Eq, Purgatory>;
-    using LruBase::cache_mutex;
     using LruBase::current_size;
-    using LruBase::list;
-    using LruBase::map;
     using LruBase::max_size;
-    using LruBase::stats;
+    using LruBase::shards;
     using LruListIter = typename LruBase::LruListIter;
     void increase_size(Value* value_ptr=nullptr) override
     {
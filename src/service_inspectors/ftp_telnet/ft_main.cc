@@ -192,7 +192,7 @@ int FTPCheckConfigs(SnortConfig* sc, void* pData)
 
 void do_detection(Packet* p)
 {
-    DataBus::publish(PACKET_EVENT, p);
+    DataBus::publish(PACKET_EVENT_ID, p);
     DetectionEngine::disable_all(p);
 }
 
@@ -235,7 +235,7 @@ void FtpDataFlowData::handle_expected(Packet* p)
             DataBus::publish(OPPORTUNISTIC_TLS_EVENT, evt, p->flow);
         }
         else
-            DataBus::publish(SSL_SEARCH_ABANDONED, p);
+            DataBus::publish(SSL_SEARCH_ABANDONED_ID, p);
     }
 }
 
@@ -1844,7 +1844,7 @@ int check_ftp(FTP_SESSION* ftpssn, Packet* p, int iMode)
                     !(ftpssn->flags & FTP_FLG_SEARCH_ABANDONED))
                 {
                     ftpssn->flags |= FTP_FLG_SEARCH_ABANDONED;
-                    DataBus::publish(SSL_SEARCH_ABANDONED, p);
+                    DataBus::publish(SSL_SEARCH_ABANDONED_ID, p);
                     ++ftstats.ssl_search_abandoned;
                 }
 
@@ -45,6 +45,7 @@ void HttpApi::http_init()
     HttpFlowData::init();
     HttpContextData::init();
     HttpCursorData::init();
+    HttpMsgSection::init();
 }
 
 const char* HttpApi::classic_buffer_names[] =
@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_arena.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "http_arena.h"
+
+#include <cstddef>
+#include <new>
+
+HttpArena::~HttpArena()
+{
+    reset();
+}
+
+void HttpArena::reset()
+{
+    while (chunks != nullptr)
+    {
+        Chunk* const tmp = chunks;
+        chunks = chunks->next;
+        ::operator delete(tmp);
+    }
+    current = nullptr;
+    available = 0;
+}
+
+uint8_t* HttpArena::new_chunk(uint32_t size)
+{
+    Chunk* const chunk = (Chunk*)::operator new(offsetof(Chunk, data) + size);
+    chunk->next = chunks;
+    chunks = chunk;
+    return chunk->data;
+}
+
+uint8_t* HttpArena::alloc(uint32_t size)
+{
+    // Keep buffers 8-byte aligned for the few that hold arrays of integers
+    size = (size + 7) & ~7u;
+
+    if ((size > available) || (current == nullptr))
+    {
+        // Large buffers get a chunk of their own so the current chunk can still be used
+        if (size > chunk_size / 2)
+            return new_chunk(size);
+
+        current = new_chunk(chunk_size);
+        available = chunk_size;
+    }
+
+    uint8_t* const buffer = current;
+    current += size;
+    available -= size;
+    return buffer;
+}
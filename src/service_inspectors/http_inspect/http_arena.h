@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_arena.h
+
+#ifndef HTTP_ARENA_H
+#define HTTP_ARENA_H
+
+#include <cstdint>
+
+// Bump allocator for the normalized buffers of one message section. The buffers are not freed
+// individually. They are all released when the section is deleted. Fields pointing into the
+// arena must not own their buffer.
+class HttpArena
+{
+public:
+    HttpArena() = default;
+    HttpArena(const HttpArena&) = delete;
+    HttpArena& operator=(const HttpArena&) = delete;
+    ~HttpArena();
+
+    uint8_t* alloc(uint32_t size);
+
+    // Releases every buffer at once. The arena may be used again afterward.
+    void reset();
+
+private:
+    struct Chunk
+    {
+        Chunk* next;
+        uint8_t data[1];
+    };
+
+    static const uint32_t chunk_size = 4096;
+
+    Chunk* chunks = nullptr;
+    uint8_t* current = nullptr;
+    uint32_t available = 0;
+
+    uint8_t* new_chunk(uint32_t size);
+};
+
+#endif
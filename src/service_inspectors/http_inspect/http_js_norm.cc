@@ -379,8 +379,8 @@ void HttpJsNorm::do_inline(const Field& input, Field& output,
         ssn->release_js_ctx();
 }
 
-void HttpJsNorm::do_legacy(const Field& input, Field& output, HttpInfractions* infractions,
-    HttpEventGen* events, int max_javascript_whitespaces) const
+void HttpJsNorm::do_legacy(const Field& input, Field& output, HttpArena& arena,
+    HttpInfractions* infractions, HttpEventGen* events, int max_javascript_whitespaces) const
 {
     bool js_present = false;
     int index = 0;
@@ -392,7 +392,7 @@ void HttpJsNorm::do_legacy(const Field& input, Field& output, HttpInfractions* i
     js.allowed_levels = MAX_ALLOWED_OBFUSCATION;
     js.alerts = 0;
 
-    uint8_t* buffer = new uint8_t[input.length()];
+    uint8_t* const buffer = arena.alloc(input.length());
 
     while (ptr < end)
     {
@@ -484,13 +484,10 @@ void HttpJsNorm::do_legacy(const Field& input, Field& output, HttpInfractions* i
                 events->create_event(EVENT_MIXED_ENCODINGS);
             }
         }
-        output.set(index, buffer, true);
+        output.set(index, buffer);
     }
     else
-    {
-        delete[] buffer;
         output.set(input);
-    }
 }
 
 int HttpJsNorm::search_js_found(void*, void*, int index, void* index_ptr, void*)
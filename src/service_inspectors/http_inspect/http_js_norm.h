@@ -24,6 +24,7 @@
 
 #include "search_engines/search_tool.h"
 
+#include "http_arena.h"
 #include "http_field.h"
 #include "http_flow_data.h"
 #include "http_event.h"
@@ -44,8 +45,8 @@ public:
     void set_detection_depth(size_t depth)
     { detection_depth = depth; }
 
-    void do_legacy(const Field& input, Field& output, HttpInfractions*, HttpEventGen*,
-        int max_javascript_whitespaces) const;
+    void do_legacy(const Field& input, Field& output, HttpArena&, HttpInfractions*,
+        HttpEventGen*, int max_javascript_whitespaces) const;
     void do_inline(const Field& input, Field& output, HttpInfractions*, HttpFlowData*, bool) const;
     void do_external(const Field& input, Field& output, HttpInfractions*, HttpFlowData*, bool) const;
 
@@ -64,7 +64,7 @@ void HttpMsgBody::publish()
 
     HttpRequestBodyEvent http_request_body_event(this, publish_octets, last_piece, session_data);
 
-    DataBus::publish(HTTP2_REQUEST_BODY_EVENT_KEY, http_request_body_event, flow);
+    DataBus::publish(pub_id_request_body, http_request_body_event, flow);
     publish_octets += publish_length;
 #ifdef REG_TEST
     if (HttpTestManager::use_test_output(HttpTestManager::IN_HTTP))
@@ -164,11 +164,11 @@ void HttpMsgBody::analyze()
                     decompressed_file_body.length();
                 assert(total_length <=
                     (int64_t)FileService::decode_conf.get_decompress_buffer_size());
-                uint8_t* const cumulative_buffer = new uint8_t[total_length];
+                uint8_t* const cumulative_buffer = arena.alloc(total_length);
                 memcpy(cumulative_buffer, partial_detect_buffer, partial_detect_length);
                 memcpy(cumulative_buffer + partial_detect_length, decompressed_file_body.start(),
                     decompressed_file_body.length());
-                cumulative_data.set(total_length, cumulative_buffer, true);
+                cumulative_data.set(total_length, cumulative_buffer);
                 do_legacy_js_normalization(cumulative_data, js_norm_body);
                 if ((int32_t)partial_js_detect_length == js_norm_body.length())
                 {
@@ -226,26 +226,22 @@ void HttpMsgBody::do_utf_decoding(const Field& input, Field& output)
     {
         int bytes_copied;
         bool decoded;
-        uint8_t* buffer = new uint8_t[input.length()];
+        uint8_t* const buffer = arena.alloc(input.length());
         decoded = session_data->utf_state->decode_utf(
             input.start(), input.length(), buffer, input.length(), &bytes_copied);
 
         if (!decoded)
         {
-            delete[] buffer;
             output.set(input);
             add_infraction(INF_UTF_NORM_FAIL);
             create_event(EVENT_UTF_NORM_FAIL);
         }
         else if (bytes_copied > 0)
         {
-            output.set(bytes_copied, buffer, true);
+            output.set(bytes_copied, buffer);
         }
         else
-        {
-            delete[] buffer;
             output.set(input);
-        }
     }
 
     else
@@ -276,7 +272,7 @@ void HttpMsgBody::do_file_decompression(const Field& input, Field& output)
         return;
     }
     const uint32_t buffer_size = session_data->file_decomp_buffer_size_remaining[source_id];
-    uint8_t* buffer = new uint8_t[buffer_size];
+    uint8_t* const buffer = arena.alloc(buffer_size);
     session_data->fd_alert_context.infractions = transaction->get_infractions(source_id);
     session_data->fd_alert_context.events = session_data->events[source_id];
     session_data->fd_state->Next_In = input.start();
@@ -293,7 +289,6 @@ void HttpMsgBody::do_file_decompression(const Field& input, Field& output)
         // Fall through
     case File_Decomp_NoSig:
     case File_Decomp_Error:
-        delete[] buffer;
         output.set(input);
         File_Decomp_StopFree(session_data->fd_state);
         session_data->fd_state = nullptr;
@@ -304,7 +299,7 @@ void HttpMsgBody::do_file_decompression(const Field& input, Field& output)
         // Fall through
     default:
         const uint32_t output_length = session_data->fd_state->Next_Out - buffer;
-        output.set(output_length, buffer, true);
+        output.set(output_length, buffer);
         assert((uint64_t)session_data->file_decomp_buffer_size_remaining[source_id] >=
             output_length);
         session_data->file_decomp_buffer_size_remaining[source_id] -= output_length;
@@ -382,7 +377,7 @@ void HttpMsgBody::do_legacy_js_normalization(const Field& input, Field& output)
         return;
     }
 
-    params->js_norm_param.js_norm->do_legacy(input, output,
+    params->js_norm_param.js_norm->do_legacy(input, output, arena,
         transaction->get_infractions(source_id), session_data->events[source_id],
         params->js_norm_param.max_javascript_whitespaces);
 }
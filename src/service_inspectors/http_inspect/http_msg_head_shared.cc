@@ -136,7 +136,7 @@ void HttpMsgHeadShared::create_norm_head_list()
             {
                 headers_present[header_name_id[j]] = true;
                 NormalizedHeader* tmp_ptr = norm_heads;
-                norm_heads = new NormalizedHeader(tmp_ptr, 1, header_name_id[j]);
+                norm_heads = new NormalizedHeader(tmp_ptr, 1, header_name_id[j], arena);
             }
         }
     }
@@ -278,7 +278,7 @@ void HttpMsgHeadShared::derive_header_name_id(int index)
 
     // Normalize header field name to lower case and remove LWS for matching purposes
     int32_t lower_length = 0;
-    uint8_t* lower_name = new uint8_t[length];
+    uint8_t* const lower_name = arena.alloc(length);
     for (int32_t k=0; k < length; k++)
     {
         if (!is_sp_tab_cr_lf[buffer[k]])
@@ -298,7 +298,6 @@ void HttpMsgHeadShared::derive_header_name_id(int index)
         }
     }
     header_name_id[index] = (HeaderId)str_to_code(lower_name, lower_length, params->header_list);
-    delete[] lower_name;
 }
 
 NormalizedHeader* HttpMsgHeadShared::get_header_node(HeaderId header_id) const
@@ -344,7 +343,7 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     }
 
     // Step through headers again and do the copying this time
-    uint8_t* const buffer = new uint8_t[length];
+    uint8_t* const buffer = arena.alloc(length);
     int32_t current = 0;
     for (int k = 0; k < num_headers; k++)
     {
@@ -357,7 +356,7 @@ const Field& HttpMsgHeadShared::get_classic_raw_header()
     }
     assert(current == length);
 
-    classic_raw_header.set(length, buffer, true);
+    classic_raw_header.set(length, buffer);
     return classic_raw_header;
 }
 
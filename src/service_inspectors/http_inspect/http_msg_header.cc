@@ -62,10 +62,10 @@ void HttpMsgHeader::publish()
 
     HttpEvent http_header_event(this, session_data->for_http2, stream_id);
 
-    const char* key = (source_id == SRC_CLIENT) ?
-        HTTP_REQUEST_HEADER_EVENT_KEY : HTTP_RESPONSE_HEADER_EVENT_KEY;
+    const unsigned pub_id = (source_id == SRC_CLIENT) ?
+        pub_id_request_header : pub_id_response_header;
 
-    DataBus::publish(key, http_header_event, flow);
+    DataBus::publish(pub_id, http_header_event, flow);
 }
 
 const Field& HttpMsgHeader::get_true_ip()
@@ -120,7 +120,7 @@ void HttpMsgRequest::parse_start_line()
     {
         uri = new HttpUri(start_line.start() + first_end + 1, last_begin - first_end - 1,
             method_id, params->uri_param, transaction->get_infractions(source_id),
-            session_data->events[source_id]);
+            session_data->events[source_id], arena);
     }
     else
     {
@@ -165,7 +165,7 @@ bool HttpMsgRequest::handle_zero_nine()
                 uri_end--);
             uri = new HttpUri(start_line.start() + uri_begin, uri_end - uri_begin + 1, method_id,
                 params->uri_param, transaction->get_infractions(source_id),
-                session_data->events[source_id]);
+                session_data->events[source_id], arena);
         }
         else
         {
@@ -320,7 +320,7 @@ void HttpMsgRequest::publish()
         !flow->flags.data_decrypted && get_method_id() != METH_CONNECT)
     {
         session_data->ssl_search_abandoned = true;
-        DataBus::publish(SSL_SEARCH_ABANDONED, DetectionEngine::get_current_packet());
+        DataBus::publish(SSL_SEARCH_ABANDONED_ID, DetectionEngine::get_current_packet());
     }
 
     if (SnortConfig::get_conf()->aux_ip_is_enabled())
@@ -40,12 +40,25 @@
 #include "http_param.h"
 #include "http_query_parser.h"
 #include "http_test_manager.h"
+#include "pub_sub/http_events.h"
+#include "pub_sub/http_request_body_event.h"
 #include "stream/flush_bucket.h"
 
 using namespace HttpCommon;
 using namespace HttpEnums;
 using namespace snort;
 
+unsigned HttpMsgSection::pub_id_request_header = DATA_BUS_INVALID_ID;
+unsigned HttpMsgSection::pub_id_response_header = DATA_BUS_INVALID_ID;
+unsigned HttpMsgSection::pub_id_request_body = DATA_BUS_INVALID_ID;
+
+void HttpMsgSection::init()
+{
+    pub_id_request_header = DataBus::get_id(HTTP_REQUEST_HEADER_EVENT_KEY);
+    pub_id_response_header = DataBus::get_id(HTTP_RESPONSE_HEADER_EVENT_KEY);
+    pub_id_request_body = DataBus::get_id(HTTP2_REQUEST_BODY_EVENT_KEY);
+}
+
 HttpMsgSection::HttpMsgSection(const uint8_t* buffer, const uint16_t buf_size,
        HttpFlowData* session_data_, SourceId source_id_, bool buf_owner, Flow* flow_,
        const HttpParaList* params_) :
@@ -149,7 +162,7 @@ const Field& HttpMsgSection::classic_normalize(const Field& raw, Field& norm,
         norm.set(raw);
         return norm;
     }
-    UriNormalizer::classic_normalize(raw, norm, do_path, uri_param);
+    UriNormalizer::classic_normalize(raw, norm, do_path, uri_param, &arena);
     return norm;
 }
 
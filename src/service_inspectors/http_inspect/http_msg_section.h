@@ -23,6 +23,7 @@
 #include "detection/detection_util.h"
 #include "framework/cursor.h"
 
+#include "http_arena.h"
 #include "http_buffer_info.h"
 #include "http_common.h"
 #include "http_cursor_data.h"
@@ -76,6 +77,12 @@ public:
     // Publish an inspection event for other modules to consume.
     virtual void publish() { }
 
+    // DataBus ids of the published events
+    static unsigned pub_id_request_header;
+    static unsigned pub_id_response_header;
+    static unsigned pub_id_request_body;
+    static void init();
+
     void clear();
     bool is_clear() { return cleared; }
 
@@ -116,11 +123,14 @@ protected:
 
     bool cleared = false;
 
+    // Normalized buffers derived from this section
+    HttpArena arena;
+
     // Convenience methods shared by multiple subclasses
     void add_infraction(int infraction);
     void create_event(int sid);
     void update_depth() const;
-    static const Field& classic_normalize(const Field& raw, Field& norm,
+    const Field& classic_normalize(const Field& raw, Field& norm,
         bool do_path, const HttpParaList::UriParam& uri_param);
 #ifdef REG_TEST
     void print_section_title(FILE* output, const char* title) const;
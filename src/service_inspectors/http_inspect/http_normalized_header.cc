@@ -58,7 +58,8 @@ public:
     void normalize(const HttpEnums::HeaderId head_id, const int count,
         HttpInfractions* infractions, HttpEventGen* events,
         const HttpEnums::HeaderId header_name_id[], const Field header_value[],
-        const int32_t num_headers, Field& result_field, Field& comma_separated_raw) const;
+        const int32_t num_headers, Field& result_field, Field& comma_separated_raw,
+        HttpArena& arena) const;
 
 private:
     const HttpEnums::EventSid repeat_event;
@@ -213,7 +214,7 @@ static int32_t derive_header_content(const uint8_t* value, int32_t length, uint8
 void NormalizedHeader::HeaderNormalizer::normalize(const HeaderId head_id, const int count,
     HttpInfractions* infractions, HttpEventGen* events, const HeaderId header_name_id[],
     const Field header_value[], const int32_t num_headers, Field& result_field,
-    Field& comma_separated_raw) const
+    Field& comma_separated_raw, HttpArena& arena) const
 {
     assert(count > 0);
 
@@ -250,13 +251,13 @@ void NormalizedHeader::HeaderNormalizer::normalize(const HeaderId head_id, const
     // number of normalization functions is odd or even, the initial buffer is chosen so that the
     // final normalization leaves the normalized header value in norm_value.
 
-    uint8_t* const norm_value = new uint8_t[buffer_length];
-    uint8_t* const temp_space = new uint8_t[buffer_length];
+    uint8_t* const norm_value = arena.alloc(buffer_length);
+    uint8_t* const temp_space = arena.alloc(buffer_length);
     uint8_t* const norm_start = (num_normalizers%2 == 0) ? norm_value : temp_space;
     uint8_t* working = norm_start;
     int32_t data_length = 0;
     const bool create_combined_raw = (count > 1);
-    uint8_t* const combined_raw = (create_combined_raw) ? new uint8_t[buffer_length] : nullptr;
+    uint8_t* const combined_raw = (create_combined_raw) ? arena.alloc(buffer_length) : nullptr;
     uint8_t* working_raw = combined_raw;
     for (int j=0; j < num_matches; j++)
     {
@@ -284,7 +285,7 @@ void NormalizedHeader::HeaderNormalizer::normalize(const HeaderId head_id, const
     if (create_combined_raw)
     {
         assert((working_raw - combined_raw) == buffer_length);
-        comma_separated_raw.set(buffer_length, combined_raw, true);
+        comma_separated_raw.set(buffer_length, combined_raw);
     }
 
     // Many fields names can appear more than once but some should not. If an event or infraction
@@ -323,8 +324,7 @@ void NormalizedHeader::HeaderNormalizer::normalize(const HeaderId head_id, const
             data_length = normalizer[i](norm_value, data_length, temp_space, infractions, events);
         }
     }
-    delete[] temp_space;
-    result_field.set(data_length, norm_value, true);
+    result_field.set(data_length, norm_value);
 }
 
 //-------------------------------------------------------------------------
@@ -341,7 +341,7 @@ const Field& NormalizedHeader::get_norm(HttpInfractions* infractions, HttpEventG
     if (norm.length() == STAT_NOT_COMPUTE)
     {
         header_norms[id]->normalize(id, count, infractions, events,
-            header_name_id, header_value, num_headers, norm, comma_separated_raw);
+            header_name_id, header_value, num_headers, norm, comma_separated_raw, arena);
     }
 
     return norm;
@@ -357,7 +357,7 @@ const Field& NormalizedHeader::get_comma_separated_raw(HttpMsgHeadShared& msg_he
     if (comma_separated_raw.length() == STAT_NOT_COMPUTE)
     {
         header_norms[id]->normalize(id, count, infractions, events,
-            header_name_id, header_value, num_headers, norm, comma_separated_raw);
+            header_name_id, header_value, num_headers, norm, comma_separated_raw, arena);
     }
 
     return comma_separated_raw;
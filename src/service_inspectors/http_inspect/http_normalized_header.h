@@ -20,6 +20,7 @@
 #ifndef HTTP_NORMALIZED_HEADER_H
 #define HTTP_NORMALIZED_HEADER_H
 
+#include "http_arena.h"
 #include "http_event.h"
 #include "http_field.h"
 
@@ -32,8 +33,8 @@ class HttpMsgHeadShared;
 class NormalizedHeader
 {
 public:
-    NormalizedHeader(NormalizedHeader* next_, int32_t count_, HttpEnums::HeaderId id_) :
-        next(next_), count(count_), id(id_) {}
+    NormalizedHeader(NormalizedHeader* next_, int32_t count_, HttpEnums::HeaderId id_,
+        HttpArena& arena_) : next(next_), count(count_), id(id_), arena(arena_) {}
     const Field& get_norm(HttpInfractions* infractions, HttpEventGen* events,
         const HttpEnums::HeaderId header_name_id[], const Field header_value[],
         const int32_t num_headers);
@@ -65,6 +66,7 @@ private:
 
     Field norm;
     Field comma_separated_raw;
+    HttpArena& arena;
 };
 
 #endif
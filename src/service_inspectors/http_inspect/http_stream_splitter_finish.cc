@@ -197,7 +197,7 @@ bool HttpStreamSplitter::finish(Flow* flow)
         {
             HttpRequestBodyEvent http_request_body_event(nullptr,
                 session_data->publish_octets[source_id], true, session_data);
-            DataBus::publish(HTTP2_REQUEST_BODY_EVENT_KEY, http_request_body_event, flow);
+            DataBus::publish(HttpMsgSection::pub_id_request_body, http_request_body_event, flow);
 #ifdef REG_TEST
             if (HttpTestManager::use_test_output(HttpTestManager::IN_HTTP))
             {
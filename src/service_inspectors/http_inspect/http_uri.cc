@@ -226,7 +226,7 @@ void HttpUri::normalize()
             {
                 const int total_length = uri.length();
 
-                uint8_t* const new_buf = new uint8_t[total_length];
+                uint8_t* const new_buf = arena.alloc(total_length);
                 uint8_t* current = new_buf;
 
                 *infractions += INF_URI_NEED_NORM_HOST;
@@ -248,7 +248,7 @@ void HttpUri::normalize()
 
                 assert(current - new_buf <= total_length);
 
-                classic_norm.set(current - new_buf, new_buf, true);
+                classic_norm.set(current - new_buf, new_buf);
                 return;
             }
 
@@ -296,7 +296,7 @@ void HttpUri::normalize()
             int total_length = path.length() ? path.length() + UriNormalizer::URI_NORM_EXPANSION : 0;
             total_length += (query.length() >= 0) ? query.length() + 1 : 0;
             total_length += (fragment.length() >= 0) ? fragment.length() + 1 : 0;
-            uint8_t* const new_buf = new uint8_t[total_length];
+            uint8_t* const new_buf = arena.alloc(total_length);
             uint8_t* current = new_buf;
 
             if (path.length() > 0)
@@ -357,7 +357,7 @@ void HttpUri::normalize()
 
             check_oversize_dir(path_norm);
 
-            classic_norm.set(current - new_buf, new_buf, true);
+            classic_norm.set(current - new_buf, new_buf);
         }
         default:
             return;
@@ -375,14 +375,14 @@ const Field& HttpUri::get_norm_scheme()
 
     if (k < scheme.length())
     {
-        uint8_t* const buf = new uint8_t[scheme.length()];
+        uint8_t* const buf = arena.alloc(scheme.length());
         *infractions += INF_URI_NEED_NORM_SCHEME;
         for (int i=0; i < scheme.length(); i++)
         {
             buf[i] = scheme.start()[i] +
                 (((scheme.start()[i] < 'A') || (scheme.start()[i] > 'Z')) ? 0 : 'a' - 'A');
         }
-        scheme_norm.set(scheme.length(), buf, true);
+        scheme_norm.set(scheme.length(), buf);
     }
     else
         scheme_norm.set(scheme);
@@ -398,12 +398,12 @@ const Field& HttpUri::get_norm_host()
     if (host.length() > 0 and
         UriNormalizer::need_norm(host, false, uri_param, infractions, events))
     {
-        uint8_t *buf = new uint8_t[host.length()];
+        uint8_t* const buf = arena.alloc(host.length());
 
         *infractions += INF_URI_NEED_NORM_HOST;
 
         UriNormalizer::normalize(host, host_norm, false, buf, uri_param,
-            infractions, events, true);
+            infractions, events);
     }
     else
         host_norm.set(host);
@@ -20,6 +20,7 @@
 #ifndef HTTP_URI_H
 #define HTTP_URI_H
 
+#include "http_arena.h"
 #include "http_str_to_code.h"
 #include "http_module.h"
 #include "http_uri_norm.h"
@@ -38,9 +39,9 @@ class HttpUri
 public:
     HttpUri(const uint8_t* start, int32_t length, HttpEnums::MethodId method_id_,
         const HttpParaList::UriParam& uri_param_, HttpInfractions* infractions_,
-        HttpEventGen* events_) :
+        HttpEventGen* events_, HttpArena& arena_) :
         uri(length, start), infractions(infractions_), events(events_), method_id(method_id_),
-        uri_param(uri_param_)
+        uri_param(uri_param_), arena(arena_)
         { normalize(); }
     const Field& get_uri() const { return uri; }
     HttpEnums::UriType get_uri_type() { return uri_type; }
@@ -85,6 +86,7 @@ private:
     HttpEnums::UriType uri_type = HttpEnums::URI__NOT_COMPUTE;
     const HttpEnums::MethodId method_id;
     const HttpParaList::UriParam& uri_param;
+    HttpArena& arena;
 
     void normalize();
     void parse_uri();
@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// http_arena_test.cc
+// unit test main
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "service_inspectors/http_inspect/http_arena.h"
+
+#include <cstring>
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+static bool aligned(const uint8_t* p)
+{ return ((uintptr_t)p & 7) == 0; }
+
+TEST_GROUP(http_arena_test) {};
+
+TEST(http_arena_test, alignment)
+{
+    HttpArena arena;
+
+    for (uint32_t size = 1; size <= 64; size++)
+    {
+        uint8_t* const buffer = arena.alloc(size);
+        CHECK(aligned(buffer));
+        memset(buffer, 0xa5, size);
+    }
+}
+
+TEST(http_arena_test, contiguous)
+{
+    HttpArena arena;
+
+    // Sizes are rounded up to 8 so consecutive small buffers are adjacent in one chunk
+    uint8_t* const first = arena.alloc(5);
+    uint8_t* const second = arena.alloc(16);
+    uint8_t* const third = arena.alloc(1);
+    CHECK(second == first + 8);
+    CHECK(third == second + 16);
+}
+
+TEST(http_arena_test, growth)
+{
+    HttpArena arena;
+
+    // Filling the 4096 byte chunk exactly and then allocating once more starts a new chunk
+    uint8_t* const first = arena.alloc(2048);
+    uint8_t* const second = arena.alloc(2048);
+    CHECK(second == first + 2048);
+    memset(first, 0, 4096);
+
+    uint8_t* const third = arena.alloc(8);
+    CHECK(third != second + 2048);
+    CHECK(aligned(third));
+    memset(third, 0, 8);
+
+    uint8_t* const fourth = arena.alloc(8);
+    CHECK(fourth == third + 8);
+}
+
+TEST(http_arena_test, large)
+{
+    HttpArena arena;
+
+    uint8_t* const small = arena.alloc(100);
+
+    // A large buffer gets a chunk of its own and the current chunk is still used
+    uint8_t* const large = arena.alloc(100000);
+    CHECK(large != nullptr);
+    CHECK(aligned(large));
+    memset(large, 0, 100000);
+
+    uint8_t* const next = arena.alloc(100);
+    CHECK(next == small + 104);
+}
+
+TEST(http_arena_test, reset)
+{
+    HttpArena arena;
+
+    for (int k = 0; k < 100; k++)
+        memset(arena.alloc(1000), 0, 1000);
+    memset(arena.alloc(10000), 0, 10000);
+
+    arena.reset();
+    arena.reset();
+
+    // Everything was released so the arena starts over with a fresh chunk
+    uint8_t* const first = arena.alloc(24);
+    uint8_t* const second = arena.alloc(24);
+    CHECK(aligned(first));
+    CHECK(second == first + 24);
+    memset(first, 0, 48);
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,141 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// http_uri_norm_benchmark.cc
+// benchmarks for URI normalization
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "helpers/literal_search.h"
+#include "log/messages.h"
+
+#include "service_inspectors/http_inspect/http_js_norm.h"
+#include "service_inspectors/http_inspect/http_uri_norm.h"
+
+using namespace snort;
+
+namespace snort
+{
+// Stubs whose sole purpose is to make the benchmark code link
+void ParseWarning(WarningGroup, const char*, ...) {}
+void ParseError(const char*, ...) {}
+void Value::get_bits(std::bitset<256ul>&) const {}
+void Value::set_first_token() {}
+bool Value::get_next_token(std::string& ) { return false; }
+int DetectionEngine::queue_event(unsigned int, unsigned int) { return 0; }
+LiteralSearch::Handle* LiteralSearch::setup() { return nullptr; }
+void LiteralSearch::cleanup(LiteralSearch::Handle*) {}
+LiteralSearch* LiteralSearch::instantiate(LiteralSearch::Handle*, const uint8_t*, unsigned, bool,
+    bool) { return nullptr; }
+}
+
+void show_stats(PegCount*, const PegInfo*, unsigned, const char*) { }
+void show_stats(PegCount*, const PegInfo*, const IndexVec&, const char*, FILE*) { }
+
+HttpJsNorm::HttpJsNorm(const HttpParaList::UriParam& uri_param_, int64_t normalization_depth_,
+    int32_t identifier_depth_, uint8_t max_template_nesting_, uint32_t max_bracket_depth_,
+    uint32_t max_scope_depth_, const std::unordered_set<std::string>& built_in_ident_) :
+    uri_param(uri_param_), normalization_depth(normalization_depth_),
+    identifier_depth(identifier_depth_), max_template_nesting(max_template_nesting_),
+    max_bracket_depth(max_bracket_depth_), max_scope_depth(max_scope_depth_),
+    built_in_ident(built_in_ident_), mpse_otag(nullptr), mpse_attr(nullptr), mpse_type(nullptr) {}
+HttpJsNorm::~HttpJsNorm() = default;
+void HttpJsNorm::configure() {}
+int64_t Parameter::get_int(char const*) { return 0; }
+
+static const std::vector<std::string> clean_paths =
+{
+    "/index.html",
+    "/images/logo.png",
+    "/api/v1/users/12345/profile",
+    "/static/js/vendor/jquery-3.5.1.min.js",
+    "/a/fairly/long/path/with/many/segments/that/needs/no/normalization/at/all.php",
+};
+
+static const std::vector<std::string> dirty_paths =
+{
+    "/uri//to/%6eormalize",
+    "/cgi-bin/../../../../etc/passwd",
+    "/scripts/..%255c..%255cwinnt/system32/cmd.exe",
+    "/%u0041%u0042%u0043/./index.asp",
+    "/path%2Fwith%2Fencoded%2Fslashes/and%20spaces%20too/file.txt",
+    "/a/./b/../c//d/./e/../../f%C0%AFg/h.jsp",
+};
+
+static unsigned need_norm(const std::vector<std::string>& v,
+    const HttpParaList::UriParam& uri_param)
+{
+    HttpInfractions infractions;
+    HttpEventGen events;
+    unsigned n = 0;
+
+    for ( const auto& s : v )
+    {
+        Field input(s.size(), (const uint8_t*)s.data());
+        n += UriNormalizer::need_norm(input, true, uri_param, &infractions, &events);
+    }
+    return n;
+}
+
+static unsigned normalize(const std::vector<std::string>& v,
+    const HttpParaList::UriParam& uri_param)
+{
+    uint8_t buffer[1000];
+    HttpInfractions infractions;
+    HttpEventGen events;
+    unsigned n = 0;
+
+    for ( const auto& s : v )
+    {
+        Field input(s.size(), (const uint8_t*)s.data());
+        Field result;
+        UriNormalizer::normalize(input, result, true, buffer, uri_param, &infractions, &events);
+        n += result.length();
+    }
+    return n;
+}
+
+TEST_CASE("uri normalization", "[http_inspect]")
+{
+    HttpParaList::UriParam uri_param;
+
+    BENCHMARK("need_norm clean")
+    { return need_norm(clean_paths, uri_param); };
+
+    BENCHMARK("need_norm dirty")
+    { return need_norm(dirty_paths, uri_param); };
+
+    BENCHMARK("normalize dirty")
+    { return normalize(dirty_paths, uri_param); };
+
+    uri_param.percent_u = true;
+    uri_param.iis_unicode = true;
+    uri_param.utf8_bare_byte = true;
+    uri_param.iis_double_decode = true;
+    uri_param.backslash_to_slash = true;
+
+    BENCHMARK("normalize dirty iis")
+    { return normalize(dirty_paths, uri_param); };
+}
@@ -486,7 +486,7 @@ static void IMAP_ProcessServerPacket(Packet* p, IMAPData* imap_ssn)
                     and !p->flow->flags.data_decrypted)
                 {
                     imap_ssn->session_flags |= IMAP_FLAG_ABANDON_EVT;
-                    DataBus::publish(SSL_SEARCH_ABANDONED, p);
+                    DataBus::publish(SSL_SEARCH_ABANDONED_ID, p);
                     imapstats.ssl_search_abandoned++;
                 }
                 imap_ssn->state = STATE_DATA;
@@ -446,7 +446,7 @@ static void POP_ProcessServerPacket(Packet* p, POPData* pop_ssn)
                         and !p->flow->flags.data_decrypted)
                     {
                         pop_ssn->session_flags |= POP_FLAG_ABANDON_EVT;
-                        DataBus::publish(SSL_SEARCH_ABANDONED, p);
+                        DataBus::publish(SSL_SEARCH_ABANDONED_ID, p);
                         popstats.ssl_search_abandoned++;
                     }
 
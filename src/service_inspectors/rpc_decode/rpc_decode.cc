@@ -235,7 +235,7 @@ static RpcStatus RpcStatefulInspection(RpcSsnData* rsdata, Packet* p)
                     if (RpcPrepRaw(data, rsdata->frag_len, p) != RPC_STATUS__SUCCESS)
                         return RPC_STATUS__ERROR;
 
-                    DataBus::publish(PACKET_EVENT, p);
+                    DataBus::publish(PACKET_EVENT_ID, p);
                 }
 
                 if ( (dsize > 0) )
@@ -306,7 +306,7 @@ static RpcStatus RpcStatefulInspection(RpcSsnData* rsdata, Packet* p)
                 if ( (dsize > 0) )
                     RpcPreprocEvent(rsdata, RPC_MULTIPLE_RECORD);
 
-                DataBus::publish(PACKET_EVENT, p);
+                DataBus::publish(PACKET_EVENT_ID, p);
                 RpcBufClean(&rsdata->frag);
             }
 
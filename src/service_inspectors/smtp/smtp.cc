@@ -1115,7 +1115,7 @@ static void SMTP_ProcessServerPacket(
                     and !(smtp_ssn->state_flags & SMTP_FLAG_ABANDON_EVT))
                 {
                     smtp_ssn->state_flags |= SMTP_FLAG_ABANDON_EVT;
-                    DataBus::publish(SSL_SEARCH_ABANDONED, p);
+                    DataBus::publish(SSL_SEARCH_ABANDONED_ID, p);
                     ++smtpstats.ssl_search_abandoned;
                 }
                 break;
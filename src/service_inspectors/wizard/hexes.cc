@@ -137,6 +137,11 @@ const MagicPage* HexBook::find_spell(
 {
     while ( i < n )
     {
+        p = follow(s, n, p, i);
+
+        if ( i == n )
+            break;
+
         int c = s[i];
 
         if ( p->next[c] )
@@ -24,6 +24,7 @@
 #include "magic.h"
 
 #include <cassert>
+#include <map>
 
 MagicPage::MagicPage(const MagicBook& b) : book(b)
 {
@@ -60,3 +61,164 @@ MagicBook::MagicBook()
 MagicBook::~MagicBook()
 { delete root; }
 
+//-------------------------------------------------------------------------
+// the trie is kept for building and wild cards but runs of literal bytes
+// are matched through a flat table indexed by page and byte class so the
+// hot loop doesn't chase a 2K page per byte
+//-------------------------------------------------------------------------
+
+void MagicBook::index_pages(MagicPage* p)
+{
+    p->index = pages.size();
+    pages.emplace_back(p);
+
+    for ( int c = 0; c < 256; ++c )
+    {
+        if ( p->next[c] and p->next[c] != p )
+            index_pages(p->next[c]);
+    }
+    if ( p->any )
+        index_pages(p->any);
+}
+
+void MagicBook::compile()
+{
+    pages.clear();
+    table.clear();
+    index_pages(root);
+
+    if ( pages.size() >= stop )
+    {
+        pages.clear();
+        return;
+    }
+
+    // bytes that go to the same pages from every page are one class
+    std::map<std::vector<uint16_t>, uint8_t> classes;
+    std::vector<uint16_t> column(pages.size());
+
+    for ( int c = 0; c < 256; ++c )
+    {
+        uint8_t f = fold(c);
+
+        for ( unsigned i = 0; i < pages.size(); ++i )
+        {
+            const MagicPage* p = pages[i];
+            column[i] = (p->any or !p->next[f]) ? stop : p->next[f]->index;
+        }
+        auto res = classes.emplace(column, classes.size());
+        xlat[c] = res.first->second;
+    }
+
+    width = classes.size();
+    table.resize(pages.size() * width);
+
+    for ( const auto& cls : classes )
+    {
+        for ( unsigned i = 0; i < pages.size(); ++i )
+            table[i * width + cls.second] = cls.first[i];
+    }
+}
+
+const MagicPage* MagicBook::follow(
+    const uint8_t* s, unsigned n, const MagicPage* p, unsigned& i) const
+{
+    if ( table.empty() )
+        return p;
+
+    unsigned x = p->index;
+
+    while ( i < n )
+    {
+        uint16_t y = table[x * width + xlat[s[i]]];
+
+        if ( y == stop )
+            break;
+
+        x = y;
+        ++i;
+    }
+    return pages[x];
+}
+
+
+#ifdef CATCH_TEST_BUILD
+
+#include "catch/catch.hpp"
+
+#include <cstring>
+
+static const char* cast(const MagicBook& b, const char* s, unsigned n)
+{
+    const MagicPage* p = b.page1();
+    b.set_bookmark();
+    return b.find_spell((const uint8_t*)s, n, p);
+}
+
+static const char* cast(const MagicBook& b, const char* s)
+{ return cast(b, s, strlen(s)); }
+
+static void add(MagicBook& b, const char* key, const char* val)
+{
+    const char* v = val;
+    b.add_spell(key, v);
+}
+
+TEST_CASE("compiled spells match the trie", "[wizard]")
+{
+    SpellBook sb;
+    add(sb, "GET", "http");
+    add(sb, "SSH-", "ssh");
+    add(sb, "220*FTP", "ftp");
+    add(sb, "* OK", "imap");
+
+    const char* data[] =
+    { "GET / HTTP/1.1", "get /", "  ssh-2.0", "220 service FTP ready", "* OK IMAP",
+      "PUT /", "SS", "" };
+
+    std::vector<const char*> before;
+
+    for ( auto s : data )
+        before.emplace_back(cast(sb, s));
+
+    sb.compile();
+
+    for ( unsigned i = 0; i < before.size(); ++i )
+        CHECK(cast(sb, data[i]) == before[i]);
+
+    CHECK(!strcmp(cast(sb, "get /"), "http"));
+    CHECK(!strcmp(cast(sb, "\r\nssh-1.99"), "ssh"));
+    CHECK(!strcmp(cast(sb, "220 service FTP ready"), "ftp"));
+}
+
+TEST_CASE("compiled hexes match the trie", "[wizard]")
+{
+    HexBook hb;
+    add(hb, "|05 00|", "dcerpc");
+    add(hb, "|16 03|?|00|", "ssl");
+    add(hb, "AB|00|", "test");
+
+    const char* data[] = { "\x05\x00\x0b", "\x16\x03\x01\x00", "\x16\x03", "AB\x00", "ab\x00", "x" };
+    unsigned lens[] = { 3, 4, 2, 3, 3, 1 };
+
+    std::vector<const char*> before;
+
+    for ( unsigned i = 0; i < 6; ++i )
+        before.emplace_back(cast(hb, data[i], lens[i]));
+
+    hb.compile();
+
+    for ( unsigned i = 0; i < 6; ++i )
+        CHECK(cast(hb, data[i], lens[i]) == before[i]);
+
+    CHECK(!strcmp(cast(hb, "\x16\x03\x02\x00", 4), "ssl"));
+    CHECK(!cast(hb, "ab\x00", 3));
+
+    // continue a match across segments
+    const MagicBook& b = hb;
+    const MagicPage* p = b.page1();
+    CHECK(!b.find_spell((const uint8_t*)"\x05", 1, p));
+    CHECK(!strcmp(b.find_spell((const uint8_t*)"\x00", 1, p), "dcerpc"));
+}
+
+#endif
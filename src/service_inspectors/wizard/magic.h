@@ -20,6 +20,8 @@
 #ifndef MAGIC_H
 #define MAGIC_H
 
+#include <cctype>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,7 @@ struct MagicPage
     MagicPage* any;
 
     const MagicBook& book;
+    unsigned index = 0;
 
     MagicPage(const MagicBook&);
     ~MagicPage();
@@ -57,6 +60,9 @@ public:
     const MagicPage* page1() const
     { return root; }
 
+    // flatten the trie into a transition table once all spells are added
+    void compile();
+
     virtual void set_bookmark(const MagicPage* page = nullptr) const
     { (void)page; }
     virtual const MagicPage* get_bookmark() const
@@ -68,6 +74,23 @@ protected:
 
     virtual const MagicPage* find_spell(const uint8_t*, unsigned,
         const MagicPage*, unsigned) const = 0;
+
+    // byte as keyed in the trie
+    virtual uint8_t fold(uint8_t c) const
+    { return c; }
+
+    // take literal transitions until a wild card page or a miss
+    const MagicPage* follow(const uint8_t*, unsigned, const MagicPage*, unsigned&) const;
+
+private:
+    void index_pages(MagicPage*);
+
+    static constexpr uint16_t stop = 0xFFFF;
+
+    std::vector<const MagicPage*> pages;
+    std::vector<uint16_t> table;  // [page index * width + class]
+    uint8_t xlat[256];            // byte to class
+    unsigned width = 0;
 };
 
 //-------------------------------------------------------------------------
@@ -88,6 +111,10 @@ public:
     const MagicPage* get_bookmark() const override
     { return glob; }
 
+protected:
+    uint8_t fold(uint8_t c) const override
+    { return toupper(c); }
+
 private:
     bool translate(const char*, HexVector&);
     void add_spell(const char*, const char*, HexVector&, unsigned, MagicPage*);
@@ -131,6 +131,11 @@ const MagicPage* SpellBook::find_spell(
 {
     while ( i < n )
     {
+        p = follow(s, n, p, i);
+
+        if ( i == n )
+            break;
+
         int c = toupper(s[i]);
 
         if ( p->next[c] )
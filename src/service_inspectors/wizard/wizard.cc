@@ -228,6 +228,12 @@ Wizard::Wizard(WizardModule* m)
     c2s_spells = m->get_book(true, false);
     s2c_spells = m->get_book(false, false);
 
+    c2s_hexes->compile();
+    s2c_hexes->compile();
+
+    c2s_spells->compile();
+    s2c_spells->compile();
+
     curses = m->get_curse_book();
     max_search_depth = m->get_max_search_depth();
 }
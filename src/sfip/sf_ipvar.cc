@@ -31,7 +31,10 @@
 
 #include "sf_ipvar.h"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
+
 #include "utils/util.h"
 
 #include "sf_cidr.h"
@@ -50,6 +53,7 @@ using namespace snort;
 static SfIpRet sfvar_list_compare(sfip_node_t*, sfip_node_t*);
 static inline void sfip_node_free(sfip_node_t*);
 static inline void sfip_node_freelist(sfip_node_t*);
+static inline void sfvar_drop_table(sfip_var_t*);
 
 static inline sfip_var_t* _alloc_var()
 {
@@ -67,6 +71,8 @@ void sfvar_free(sfip_var_t* var)
     if (var->value)
         snort_free(var->value);
 
+    sfvar_drop_table(var);
+
     if (var->mode == SFIP_LIST)
     {
         sfip_node_freelist(var->head);
@@ -423,6 +429,7 @@ SfIpRet sfvar_add(sfip_var_t* dst, sfip_var_t* src)
     sfip_var_t* copiedvar;
 
     assert(dst and src);
+    sfvar_drop_table(dst);
 
     if ((copiedvar = sfvar_deep_copy(src)) == nullptr)
     {
@@ -452,6 +459,8 @@ static SfIpRet sfvar_add_node(sfip_var_t* var, sfip_node_t* node, int negated)
     if (!var || !node)
         return SFIP_ARG_ERR;
 
+    sfvar_drop_table(var);
+
     // As of this writing, 11/20/06, nodes are always added to
     // the list, regardless of the mode (list or table).
 
@@ -1014,6 +1023,259 @@ sfip_var_t* sfvar_alloc(vartable_t* table, const char* variable, SfIpRet* status
     return ret;
 }
 
+//-------------------------------------------------------------------------
+// compiled lookups - the positive and negated lists of each family are
+// reduced to one sorted array of disjoint ranges so a check is a binary
+// search instead of a walk of both lists.  the ranges mirror what
+// SfCidr::fast_cont4() and fast_cont6() match, quirks included.
+//-------------------------------------------------------------------------
+
+struct Ip6Key
+{
+    uint64_t hi;
+    uint64_t lo;
+
+    bool operator<(const Ip6Key& k) const
+    { return hi < k.hi or (hi == k.hi and lo < k.lo); }
+
+    bool operator==(const Ip6Key& k) const
+    { return hi == k.hi and lo == k.lo; }
+};
+
+template <typename T>
+struct IpRange
+{
+    T lo;
+    T hi;
+};
+
+struct sfip_table_t
+{
+    std::vector<IpRange<uint32_t>> v4;
+    std::vector<IpRange<Ip6Key>> v6;
+};
+
+static inline uint32_t succ(uint32_t k)
+{ return k + 1; }
+
+static inline uint32_t pred(uint32_t k)
+{ return k - 1; }
+
+static inline Ip6Key succ(Ip6Key k)
+{
+    if ( ++k.lo == 0 )
+        ++k.hi;
+    return k;
+}
+
+static inline Ip6Key pred(Ip6Key k)
+{
+    if ( k.lo-- == 0 )
+        --k.hi;
+    return k;
+}
+
+static inline Ip6Key get_key6(const uint32_t* w)
+{
+    Ip6Key k;
+    k.hi = ((uint64_t)ntohl(w[0]) << 32) | ntohl(w[1]);
+    k.lo = ((uint64_t)ntohl(w[2]) << 32) | ntohl(w[3]);
+    return k;
+}
+
+static const IpRange<uint32_t> all4 = { 0, UINT32_MAX };
+static const IpRange<Ip6Key> all6 = { { 0, 0 }, { UINT64_MAX, UINT64_MAX } };
+
+// a v4 cidr has 96 to 128 bits; a zero address matches everything and an
+// address with host bits set matches nothing
+static bool get_range(const SfCidr* c, IpRange<uint32_t>& r)
+{
+    uint32_t addr = ntohl(c->get_addr()->get_ip4_value());
+
+    if ( !addr )
+    {
+        r = all4;
+        return true;
+    }
+
+    uint32_t shift = 128 - c->get_bits();
+    uint32_t host = (shift and shift < 32) ? (1u << shift) - 1 : 0;
+
+    if ( addr & host )
+        return false;
+
+    r = { addr, addr | host };
+    return true;
+}
+
+// only the bits of the last word of the prefix are masked so a partial word
+// with host bits set matches nothing and any words after it are ignored
+static bool get_range(const SfCidr* c, IpRange<Ip6Key>& r)
+{
+    const uint32_t* w = c->get_addr()->get_ip6_ptr();
+    unsigned bits = c->get_bits();
+    uint32_t lo[4], hi[4];
+
+    for ( unsigned i = 0; i < 4; ++i )
+    {
+        unsigned b = bits > 32 * i ? std::min(bits - 32 * i, 32u) : 0;
+        uint32_t host = (b < 32) ? (0xFFFFFFFF >> b) : 0;
+        uint32_t v = ntohl(w[i]);
+
+        if ( b and (v & host) )
+            return false;
+
+        lo[i] = b ? v : 0;
+        hi[i] = lo[i] | host;
+    }
+
+    r.lo.hi = ((uint64_t)lo[0] << 32) | lo[1];
+    r.lo.lo = ((uint64_t)lo[2] << 32) | lo[3];
+    r.hi.hi = ((uint64_t)hi[0] << 32) | hi[1];
+    r.hi.lo = ((uint64_t)hi[2] << 32) | hi[3];
+
+    return true;
+}
+
+template <typename T>
+static void add_range(const SfCidr* c, std::vector<IpRange<T>>& v)
+{
+    IpRange<T> r;
+
+    if ( get_range(c, r) )
+        v.emplace_back(r);
+}
+
+// sort and coalesce overlapping and adjacent ranges
+template <typename T>
+static void merge_ranges(std::vector<IpRange<T>>& v)
+{
+    if ( v.empty() )
+        return;
+
+    std::sort(v.begin(), v.end(),
+        [](const IpRange<T>& a, const IpRange<T>& b) { return a.lo < b.lo; });
+
+    unsigned n = 0;
+
+    for ( unsigned i = 1; i < v.size(); ++i )
+    {
+        IpRange<T>& last = v[n];
+
+        if ( !(last.hi < v[i].lo) or succ(last.hi) == v[i].lo )
+        {
+            if ( last.hi < v[i].hi )
+                last.hi = v[i].hi;
+        }
+        else
+            v[++n] = v[i];
+    }
+    v.resize(n + 1);
+}
+
+// both inputs are merged
+template <typename T>
+static std::vector<IpRange<T>> subtract_ranges(
+    const std::vector<IpRange<T>>& pos, const std::vector<IpRange<T>>& neg)
+{
+    std::vector<IpRange<T>> out;
+    unsigned j = 0;
+
+    for ( const auto& p : pos )
+    {
+        T lo = p.lo;
+        bool open = true;
+
+        while ( j < neg.size() and neg[j].hi < lo )
+            ++j;
+
+        for ( unsigned k = j; k < neg.size() and !(p.hi < neg[k].lo); ++k )
+        {
+            if ( lo < neg[k].lo )
+                out.push_back({ lo, pred(neg[k].lo) });
+
+            if ( !(neg[k].hi < p.hi) )
+            {
+                open = false;
+                break;
+            }
+            lo = succ(neg[k].hi);
+        }
+        if ( open )
+            out.push_back({ lo, p.hi });
+    }
+    return out;
+}
+
+template <typename T>
+static inline bool in_ranges(const std::vector<IpRange<T>>& v, const T& k)
+{
+    auto it = std::upper_bound(v.begin(), v.end(), k,
+        [](const T& key, const IpRange<T>& r) { return key < r.lo; });
+
+    if ( it == v.begin() )
+        return false;
+
+    --it;
+    return !(it->hi < k);
+}
+
+static inline void sfvar_drop_table(sfip_var_t* var)
+{
+    delete var->table;
+    var->table = nullptr;
+}
+
+void sfvar_compile(sfip_var_t* var)
+{
+    if ( !var )
+        return;
+
+    std::vector<IpRange<uint32_t>> pos4, neg4;
+    std::vector<IpRange<Ip6Key>> pos6, neg6;
+
+    // no positive entries or an "any" entry matches everything not negated
+    bool any = !var->head;
+
+    for ( sfip_node_t* node = var->head; node; node = node->next )
+    {
+        if ( !node->ip->is_set() )
+            any = true;
+
+        else if ( node->ip->get_family() == AF_INET )
+            add_range(node->ip, pos4);
+
+        else if ( node->ip->get_family() == AF_INET6 )
+            add_range(node->ip, pos6);
+    }
+
+    if ( any )
+    {
+        pos4.assign(1, all4);
+        pos6.assign(1, all6);
+    }
+
+    for ( sfip_node_t* node = var->neg_head; node; node = node->next )
+    {
+        if ( node->ip->get_family() == AF_INET )
+            add_range(node->ip, neg4);
+
+        else if ( node->ip->get_family() == AF_INET6 )
+            add_range(node->ip, neg6);
+    }
+
+    merge_ranges(pos4);
+    merge_ranges(neg4);
+    merge_ranges(pos6);
+    merge_ranges(neg6);
+
+    sfvar_drop_table(var);
+
+    var->table = new sfip_table_t;
+    var->table->v4 = subtract_ranges(pos4, neg4);
+    var->table->v6 = subtract_ranges(pos6, neg6);
+}
+
 /* Support function for sfvar_ip_in  */
 static inline bool sfvar_ip_in4(sfip_var_t* var, const SfIp* ip)
 {
@@ -1157,6 +1419,14 @@ bool sfvar_ip_in(sfip_var_t* var, const SfIp* ip)
      * codepaths for IPv6 and IPv4 traffic, rather than the dual-stack
      * functions. */
 
+    if (var->table)
+    {
+        if (ip->get_family() == AF_INET)
+            return in_ranges(var->table->v4, (uint32_t)ntohl(ip->get_ip4_value()));
+
+        return in_ranges(var->table->v6, get_key6(ip->get_ip6_ptr()));
+    }
+
     if (ip->get_family() == AF_INET)
     {
         return sfvar_ip_in4(var, ip);
@@ -1466,5 +1736,45 @@ TEST_CASE("SfIpVarAny", "[SfIpVar]")
     sfvt_free_table(table);
 }
 
+TEST_CASE("SfIpVarCompiled", "[SfIpVar]")
+{
+    vartable_t* table = sfvt_alloc_table();
+    sfip_var_t* var;
+
+    const char* vars[] =
+    {
+        "a [10.0.0.0/8, !10.1.0.0/16, 192.168.1.0/24, 2001:db8::/32, !2001:db8:1::/48]",
+        "b [!10.0.0.0/8, !fe80::/10]",
+        "c [any]",
+        "d [1.2.3.4, 1.2.3.5, 1.2.3.6/31, 255.255.255.255]",
+        "e [0.0.0.0/0, !127.0.0.0/8]",
+    };
+
+    const char* addrs[] =
+    {
+        "10.0.0.1", "10.1.2.3", "10.255.255.255", "11.0.0.0", "192.168.1.7", "192.168.2.1",
+        "1.2.3.4", "1.2.3.7", "1.2.3.8", "127.0.0.1", "0.0.0.0", "255.255.255.255",
+        "2001:db8::1", "2001:db8:1::1", "2001:db9::", "fe80::1", "::1",
+    };
+
+    for ( auto v : vars )
+    {
+        CHECK(sfvt_add_str(table, v, &var) == SFIP_SUCCESS);
+
+        for ( auto a : addrs )
+        {
+            SfIp ip;
+            CHECK(ip.set(a) == SFIP_SUCCESS);
+
+            bool listed = sfvar_ip_in(var, &ip);
+            sfvar_compile(var);
+            CHECK(var->table);
+            CHECK(sfvar_ip_in(var, &ip) == listed);
+            sfvar_drop_table(var);
+        }
+    }
+    sfvt_free_table(table);
+}
+
 #endif
 
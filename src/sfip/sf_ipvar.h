@@ -64,6 +64,9 @@ typedef struct _ip_node
                     /* Should merge them later */
 } sfip_node_t;
 
+/* Sorted address ranges compiled from the lists */
+struct sfip_table_t;
+
 /* An IP variable onkect */
 struct sfip_var_t
 {
@@ -79,6 +82,10 @@ struct sfip_var_t
      * or the IP routing table */
 //    sfrt rt;
 
+    /* Set by sfvar_compile() for binary search lookups.  Changing the
+     * lists drops it and lookups walk the lists until recompiled. */
+    sfip_table_t* table;
+
     /* Linked list of IP variables for the variable table */
     sfip_var_t* next;
 
@@ -122,6 +129,9 @@ SfIpRet sfvar_compare(const sfip_var_t* one, const sfip_var_t* two);
 /* Free an allocated variable */
 void sfvar_free(sfip_var_t* var);
 
+/* Build the lookup table once the variable is complete */
+void sfvar_compile(sfip_var_t* var);
+
 // returns true if both args are valid and ip is contained by var
 bool sfvar_ip_in(sfip_var_t* var, const snort::SfIp* ip);
 
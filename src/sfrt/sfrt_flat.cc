@@ -328,6 +328,7 @@ uint32_t sfrt_flat_num_entries(table_flat_t* table)
     return table->num_ent - 1;
 }
 
+// the table is at the start of its segment so it is also the base
 uint32_t sfrt_flat_usage(table_flat_t* table)
 {
     uint32_t usage;
@@ -336,11 +337,12 @@ uint32_t sfrt_flat_usage(table_flat_t* table)
         return 0;
     }
 
-    usage = table->allocated + sfrt_dir_flat_usage(table->rt);
+    uint8_t* base = (uint8_t*)table;
+    usage = table->allocated + sfrt_dir_flat_usage(table->rt, base);
 
     if (table->rt6)
     {
-        usage += sfrt_dir_flat_usage(table->rt6);
+        usage += sfrt_dir_flat_usage(table->rt6, base);
     }
 
     return usage;
@@ -72,7 +72,7 @@ TABLE_PTR sfrt_dir_flat_new(uint32_t mem_cap, int count,...);
 tuple_flat_t sfrt_dir_flat_lookup(const uint32_t* addr, int numAddrDwords, TABLE_PTR table);
 int sfrt_dir_flat_insert(const uint32_t* addr, int numAddrDwords, int len, word data_index,
                     int behavior, TABLE_PTR, updateEntryInfoFunc updateEntry, INFO *data);
-uint32_t sfrt_dir_flat_usage(TABLE_PTR);
+uint32_t sfrt_dir_flat_usage(TABLE_PTR, uint8_t* base);
 
 #endif /* SFRT_FLAT_DIR_H */
 
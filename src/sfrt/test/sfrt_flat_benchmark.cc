@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// sfrt_flat_benchmark.cc
+// benchmarks for the flat routing table lookups used by reputation
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <arpa/inet.h>
+
+#include <cassert>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "catch/catch.hpp"
+
+#include "sfip/sf_cidr.h"
+#include "sfrt/sfrt.h"
+#include "sfrt/sfrt_flat.h"
+#include "utils/segment_mem.h"
+
+using namespace snort;
+
+namespace snort
+{
+char* snort_strdup(const char* str)
+{
+    assert(str);
+    size_t n = strlen(str) + 1;
+    char* p = new char[n];
+    memcpy(p, str, n);
+    return p;
+}
+}
+
+#define NUM_V4_ENTRIES 8192
+#define NUM_V6_ENTRIES 1024
+#define NUM_LOOKUPS 16384
+#define SEGMENT_SIZE (128 << 20)
+
+static int64_t update_entry(INFO* current, INFO new_entry, SaveDest, uint8_t*)
+{
+    *current = new_entry;
+    return 0;
+}
+
+static void add_v4(table_flat_t* table, uint32_t addr, unsigned bits)
+{
+    SfCidr cidr;
+    uint32_t a = htonl(addr);
+    cidr.set(&a, AF_INET);
+    cidr.set_bits(96 + bits);
+
+    INFO info = segment_snort_calloc(1, sizeof(uint32_t));
+    sfrt_flat_insert(&cidr, cidr.get_bits(), info, RT_FAVOR_ALL, table, update_entry);
+}
+
+static void add_v6(table_flat_t* table, const uint32_t* addr, unsigned bits)
+{
+    SfCidr cidr;
+    cidr.set(addr, AF_INET6);
+    cidr.set_bits(bits);
+
+    INFO info = segment_snort_calloc(1, sizeof(uint32_t));
+    sfrt_flat_insert(&cidr, cidr.get_bits(), info, RT_FAVOR_ALL, table, update_entry);
+}
+
+TEST_CASE("sfrt_flat lookup", "[sfrt]")
+{
+    std::vector<uint8_t> segment(SEGMENT_SIZE);
+    segment_meminit(segment.data(), segment.size());
+
+    table_flat_t* table = sfrt_flat_new(DIR_8x16, IPv6, NUM_V4_ENTRIES + NUM_V6_ENTRIES,
+        SEGMENT_SIZE >> 20);
+    REQUIRE(table);
+
+    std::mt19937 rng(1);
+    std::vector<uint32_t> v4;
+
+    // insert less specific blocks first as reputation lists are expected to
+    for ( unsigned i = 0; i < NUM_V4_ENTRIES / 4; ++i )
+        add_v4(table, rng() & 0xffff0000, 16);
+
+    for ( unsigned i = 0; i < NUM_V4_ENTRIES / 4; ++i )
+        add_v4(table, rng() & 0xffffff00, 24);
+
+    for ( unsigned i = 0; i < NUM_V4_ENTRIES / 2; ++i )
+    {
+        v4.emplace_back(rng());
+        add_v4(table, v4.back(), 32);
+    }
+
+    std::vector<SfIp> v6;
+
+    for ( unsigned i = 0; i < NUM_V6_ENTRIES; ++i )
+    {
+        uint32_t a[4] = { htonl(0x20010db8), rng(), rng(), rng() };
+        SfIp ip;
+        ip.set(a, AF_INET6);
+        v6.emplace_back(ip);
+        add_v6(table, a, i % 2 ? 128 : 64);
+    }
+
+    std::vector<SfIp> hits, misses;
+
+    for ( unsigned i = 0; i < NUM_LOOKUPS; ++i )
+    {
+        SfIp ip;
+        uint32_t a = htonl(v4[i % v4.size()]);
+        ip.set(&a, AF_INET);
+        hits.emplace_back(ip);
+
+        // 0.0.0.0/8 is never inserted above unless a random block lands there
+        a = htonl(rng() & 0x00ffffff);
+        ip.set(&a, AF_INET);
+        misses.emplace_back(ip);
+    }
+
+    REQUIRE(sfrt_flat_lookup(&hits[0], table));
+    REQUIRE(sfrt_flat_lookup(&v6[0], table));
+
+    BENCHMARK("ipv4 hit")
+    {
+        unsigned n = 0;
+
+        for ( const auto& ip : hits )
+            n += sfrt_flat_lookup(&ip, table) != nullptr;
+
+        return n;
+    };
+
+    BENCHMARK("ipv4 miss")
+    {
+        unsigned n = 0;
+
+        for ( const auto& ip : misses )
+            n += sfrt_flat_lookup(&ip, table) != nullptr;
+
+        return n;
+    };
+
+    BENCHMARK("ipv6 hit")
+    {
+        unsigned n = 0;
+
+        for ( const auto& ip : v6 )
+            n += sfrt_flat_lookup(&ip, table) != nullptr;
+
+        return n;
+    };
+}
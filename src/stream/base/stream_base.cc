@@ -76,6 +76,8 @@ const PegInfo base_pegs[] =
     { CountType::SUM, "reload_allowed_deletes", "number of allowed flows deleted by config reloads" },
     { CountType::SUM, "reload_blocked_deletes", "number of blocked flows deleted by config reloads" },
     { CountType::SUM, "reload_offloaded_deletes", "number of offloaded flows deleted by config reloads" },
+    { CountType::SUM, "flow_prefetches", "number of flow lookups prefetched ahead of their packet" },
+    { CountType::SUM, "flow_prefetch_hits", "number of prefetched flow lookups that found a flow" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -98,6 +100,8 @@ void base_prep()
     stream_base_stats.reload_allowed_flow_deletes = flow_con->get_deletes(FlowDeleteState::ALLOWED);
     stream_base_stats.reload_offloaded_flow_deletes= flow_con->get_deletes(FlowDeleteState::OFFLOADED);
     stream_base_stats.reload_blocked_flow_deletes= flow_con->get_deletes(FlowDeleteState::BLOCKED);
+    stream_base_stats.flow_prefetches = flow_con->get_prefetches();
+    stream_base_stats.flow_prefetch_hits = flow_con->get_prefetch_hits();
     ExpectCache* exp_cache = flow_con->get_exp_cache();
 
     if ( exp_cache )
@@ -259,7 +263,7 @@ void StreamBase::eval(Packet* p)
             bool new_flow = false;
             flow_con->process(PktType::IP, p, &new_flow);
             if ( new_flow )
-                DataBus::publish(STREAM_IP_NEW_FLOW_EVENT, p);
+                DataBus::publish(STREAM_IP_NEW_FLOW_EVENT_ID, p);
         }
         break;
 
@@ -277,7 +281,7 @@ void StreamBase::eval(Packet* p)
             bool new_flow = false;
             flow_con->process(PktType::UDP, p, &new_flow);
             if ( new_flow )
-                DataBus::publish(STREAM_UDP_NEW_FLOW_EVENT, p);
+                DataBus::publish(STREAM_UDP_NEW_FLOW_EVENT_ID, p);
         }
         break;
 
@@ -288,7 +292,7 @@ void StreamBase::eval(Packet* p)
             if ( !flow_con->process(PktType::ICMP, p, &new_flow) )
                 flow_con->process(PktType::IP, p, &new_flow);
             if ( new_flow )
-                DataBus::publish(STREAM_ICMP_NEW_FLOW_EVENT, p);
+                DataBus::publish(STREAM_ICMP_NEW_FLOW_EVENT_ID, p);
         }
         break;
 
@@ -104,7 +104,7 @@ bool StreamHAClient::consume(Flow*& flow, const FlowKey* key, HAMessage& msg, ui
             return false;
 
         BareDataEvent event;
-        DataBus::publish(STREAM_HA_NEW_FLOW_EVENT, event, flow);
+        DataBus::publish(STREAM_HA_NEW_FLOW_EVENT_ID, event, flow);
 
         flow->ha_state->clear(FlowHAState::NEW);
         flow->ha_state->add(FlowHAState::STANDBY);
@@ -75,6 +75,8 @@ struct BaseStats
      PegCount reload_allowed_flow_deletes;
      PegCount reload_blocked_flow_deletes;
      PegCount reload_offloaded_flow_deletes;
+     PegCount flow_prefetches;
+     PegCount flow_prefetch_hits;
 };
 
 extern const PegInfo base_pegs[];
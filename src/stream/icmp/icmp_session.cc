@@ -218,7 +218,7 @@ int IcmpSession::process(Packet* p)
 
     if (!(flow->ssn_state.session_flags & SSNFLAG_ESTABLISHED) and !(p->is_from_client()))
     {
-        DataBus::publish(STREAM_ICMP_BIDIRECTIONAL_EVENT, p);
+        DataBus::publish(STREAM_ICMP_BIDIRECTIONAL_EVENT_ID, p);
         flow->ssn_state.session_flags |= SSNFLAG_ESTABLISHED;
     }
 
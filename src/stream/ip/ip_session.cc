@@ -109,11 +109,11 @@ static inline void update_session(Packet* p, Flow* lws)
 
             if ( p->type() == PktType::ICMP and p->ptrs.icmph)
             {
-                DataBus::publish(STREAM_ICMP_BIDIRECTIONAL_EVENT, p);
+                DataBus::publish(STREAM_ICMP_BIDIRECTIONAL_EVENT_ID, p);
             }
             else
             {
-                DataBus::publish(STREAM_IP_BIDIRECTIONAL_EVENT, p);
+                DataBus::publish(STREAM_IP_BIDIRECTIONAL_EVENT_ID, p);
             }
         }
     }
@@ -23,6 +23,8 @@
 
 #include "stream.h"
 
+#include <daq_dlt.h>
+
 #include <cassert>
 #include <mutex>
 
@@ -37,6 +39,13 @@
 #include "main/snort_debug.h"
 #include "network_inspectors/packet_tracer/packet_tracer.h"
 #include "packet_io/active.h"
+#include "packet_io/sfdaq.h"
+#include "protocols/eth.h"
+#include "protocols/icmp4.h"
+#include "protocols/ipv4.h"
+#include "protocols/ipv6.h"
+#include "protocols/tcp.h"
+#include "protocols/udp.h"
 #include "protocols/vlan.h"
 #include "stream/base/stream_module.h"
 #include "target_based/host_attributes.h"
@@ -82,6 +91,155 @@ void Stream::delete_flow(Flow* flow)
     flow_con->release_flow(flow, PruneReason::NONE);
 }
 
+//-------------------------------------------------------------------------
+// prefetch foo
+//-------------------------------------------------------------------------
+
+// get the key of a plain ip / tcp, udp or icmp packet, possibly behind
+// ethernet and one vlan tag, straight from the frame so the flow can be
+// prefetched before the packet is decoded.  anything else, including
+// tunnels, fragments and ip6 extension headers, is skipped.  a wrong key
+// only costs a wasted prefetch.
+static bool get_key_hint(const SnortConfig* sc, int dlt, DAQ_Msg_h msg, FlowKey& key)
+{
+    if ( daq_msg_get_type(msg) != DAQ_MSG_TYPE_PACKET )
+        return false;
+
+    const DAQ_PktHdr_t* pkth = daq_msg_get_pkthdr(msg);
+    const uint8_t* data = daq_msg_get_data(msg);
+    uint32_t len = daq_msg_get_data_len(msg);
+
+    uint16_t vlan_id = 0;
+    uint16_t ether_type;
+
+    if ( dlt == DLT_EN10MB )
+    {
+        if ( len < eth::ETH_HEADER_LEN )
+            return false;
+
+        ether_type = to_utype(((const eth::EtherHdr*)data)->ethertype());
+        data += eth::ETH_HEADER_LEN;
+        len -= eth::ETH_HEADER_LEN;
+
+        if ( ether_type == to_utype(ProtocolId::ETHERTYPE_8021Q) )
+        {
+            if ( len < sizeof(vlan::VlanTagHdr) )
+                return false;
+
+            const vlan::VlanTagHdr* vh = (const vlan::VlanTagHdr*)data;
+            vlan_id = vh->vid();
+            ether_type = vh->proto();
+            data += sizeof(*vh);
+            len -= sizeof(*vh);
+        }
+    }
+    else if ( dlt == DLT_RAW and len )
+    {
+        ether_type = (data[0] >> 4) == 6 ?
+            to_utype(ProtocolId::ETHERTYPE_IPV6) : to_utype(ProtocolId::ETHERTYPE_IPV4);
+    }
+    else
+        return false;
+
+    SfIp src, dst;
+    IpProtocol proto;
+
+    if ( ether_type == to_utype(ProtocolId::ETHERTYPE_IPV4) )
+    {
+        if ( len < ip::IP4_HEADER_LEN )
+            return false;
+
+        const ip::IP4Hdr* ip4 = (const ip::IP4Hdr*)data;
+        unsigned hlen = ip4->hlen();
+
+        if ( ip4->ver() != 4 or hlen < ip::IP4_HEADER_LEN or len < hlen or
+            ip4->mf() or ip4->off() )
+            return false;
+
+        src.set(&ip4->ip_src, AF_INET);
+        dst.set(&ip4->ip_dst, AF_INET);
+        proto = ip4->proto();
+        data += hlen;
+        len -= hlen;
+    }
+    else if ( ether_type == to_utype(ProtocolId::ETHERTYPE_IPV6) )
+    {
+        if ( len < ip::IP6_HEADER_LEN )
+            return false;
+
+        const ip::IP6Hdr* ip6 = (const ip::IP6Hdr*)data;
+        src.set(ip6->get_src(), AF_INET6);
+        dst.set(ip6->get_dst(), AF_INET6);
+        proto = ip6->next();
+        data += ip::IP6_HEADER_LEN;
+        len -= ip::IP6_HEADER_LEN;
+    }
+    else
+        return false;
+
+    switch ( proto )
+    {
+    case IpProtocol::TCP:
+    {
+        if ( len < tcp::TCP_MIN_HEADER_LEN )
+            return false;
+
+        const tcp::TCPHdr* tcph = (const tcp::TCPHdr*)data;
+        key.init(sc, PktType::TCP, proto, &src, tcph->src_port(),
+            &dst, tcph->dst_port(), vlan_id, 0, *pkth);
+        return true;
+    }
+    case IpProtocol::UDP:
+    {
+        if ( len < udp::UDP_HEADER_LEN )
+            return false;
+
+        const udp::UDPHdr* udph = (const udp::UDPHdr*)data;
+        key.init(sc, PktType::UDP, proto, &src, udph->src_port(),
+            &dst, udph->dst_port(), vlan_id, 0, *pkth);
+        return true;
+    }
+    case IpProtocol::ICMPV4:
+    case IpProtocol::ICMPV6:
+    {
+        if ( !len )
+            return false;
+
+        const icmp::ICMPHdr* icmph = (const icmp::ICMPHdr*)data;
+        key.init(sc, PktType::ICMP, proto, &src, (uint16_t)icmph->type,
+            &dst, 0, vlan_id, 0, *pkth);
+        return true;
+    }
+    default:
+        break;
+    }
+    return false;
+}
+
+void Stream::prefetch_flows(const DAQ_Msg_h* msgs, unsigned num)
+{
+    if ( !flow_con )
+        return;
+
+    FlowKey keys[FlowControl::max_prefetch];
+    unsigned n = 0;
+
+    // a single message gains nothing but the last batch's keys are still dropped
+    if ( num > 1 )
+    {
+        const SnortConfig* sc = SnortConfig::get_conf();
+        int dlt = SFDAQ::get_base_protocol();
+
+        for ( unsigned i = 0; i < num and n < FlowControl::max_prefetch; ++i )
+        {
+            if ( get_key_hint(sc, dlt, msgs[i], keys[n]) )
+                ++n;
+        }
+    }
+
+    flow_con->prefetch(keys, n);
+}
+
 //-------------------------------------------------------------------------
 // key foo
 //-------------------------------------------------------------------------
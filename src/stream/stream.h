@@ -78,6 +78,9 @@ public:
 
     static void handle_timeouts(bool idle);
     static bool prune_flows();
+
+    // prefetch the flows of a batch of messages before they are processed
+    static void prefetch_flows(const DAQ_Msg_h*, unsigned num);
     static bool expected_flow(Flow*, Packet*);
 
     // Looks in the flow cache for flow session with specified key and returns
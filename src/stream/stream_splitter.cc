@@ -48,6 +48,9 @@ const StreamBuffer StreamSplitter::reassemble(
     if (n == 0)
         return { nullptr, 0 };
 
+    if ( (flags & PKT_PDU_IN_PLACE) and !offset )
+        return { p, n };
+
     unsigned max;
     uint8_t* pdu_buf = DetectionEngine::get_next_buffer(max);
 
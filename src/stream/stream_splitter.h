@@ -69,7 +69,9 @@ public:
     virtual bool init_partial_flush(Flow*) { return false; }
 
     // the last call to reassemble() will be made with len == 0 if
-    // finish() returned true as an opportunity for a final flush
+    // finish() returned true as an opportunity for a final flush.
+    // PKT_PDU_IN_PLACE is set with PKT_PDU_HEAD | PKT_PDU_TAIL when the
+    // whole PDU is in data and data may be used without copying.
     virtual const StreamBuffer reassemble(
         Flow*,
         unsigned total,        // total amount to flush (sum of iterations)
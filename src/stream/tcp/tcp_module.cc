@@ -115,6 +115,7 @@ const PegInfo tcp_pegs[] =
     { CountType::MAX, "max_segs", "maximum number of segments queued in any flow" },
     { CountType::MAX, "max_bytes", "maximum number of bytes queued in any flow" },
     { CountType::SUM, "zero_len_tcp_opt", "number of zero length tcp options" },
+    { CountType::SUM, "in_place_flushes", "PDUs inspected in the segment without copying" },
     { CountType::END, nullptr, nullptr }
 };
 
@@ -188,6 +189,9 @@ static const Parameter s_params[] =
     { "flush_factor", Parameter::PT_INT, "0:65535", "0",
       "flush upon seeing a drop in segment size after given number of non-decreasing segments" },
 
+    { "flush_in_place", Parameter::PT_BOOL, nullptr, "false",
+      "present PDUs contained in a single segment for inspection without copying" },
+
     { "max_window", Parameter::PT_INT, "0:1073725440", "0",
       "maximum allowed TCP window" },
 
@@ -352,6 +356,13 @@ bool StreamTcpModule::set(const char*, Value& v, SnortConfig*)
         else
             config->flags &= ~STREAM_CONFIG_SHOW_PACKETS;
     }
+    else if ( v.is("flush_in_place") )
+    {
+        if ( v.get_bool() )
+            config->flags |= STREAM_CONFIG_IN_PLACE_FLUSH;
+        else
+            config->flags &= ~STREAM_CONFIG_IN_PLACE_FLUSH;
+    }
     else if ( v.is("track_only") )
     {
         if ( v.get_bool() )
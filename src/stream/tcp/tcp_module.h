@@ -113,6 +113,7 @@ struct TcpStats
     PegCount max_segs;
     PegCount max_bytes;
     PegCount zero_len_tcp_opt;
+    PegCount in_place_flushes;
 };
 
 extern THREAD_LOCAL struct TcpStats tcpStats;
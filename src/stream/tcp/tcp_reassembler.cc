@@ -28,6 +28,7 @@
 #include "detection/detection_engine.h"
 #include "log/log.h"
 #include "main/analyzer.h"
+#include "main/snort_config.h"
 #include "memory/memory_cap.h"
 #include "packet_io/active.h"
 #include "profiler/profiler.h"
@@ -376,6 +377,15 @@ int TcpReassembler::flush_data_segments(TcpReassemblerState& trs, uint32_t flush
 {
     uint32_t flags = PKT_PDU_HEAD;
     uint32_t to_seq = trs.sos.seglist.cur_rseg->c_seq + flush_len;
+
+    // the segment is not released until after the pdu is inspected unless
+    // detection is offloaded, so a pdu within one segment can be used as is
+    if ( (trs.sos.session->tcp_config->flags & STREAM_CONFIG_IN_PLACE_FLUSH) and
+        trs.sos.seglist.cur_rseg->c_len >= flush_len and
+        pdu->context->conf->offload_threads == 0 )
+    {
+        flags |= PKT_PDU_IN_PLACE;
+    }
     uint32_t remaining_bytes = flush_len;
     uint32_t total_flushed = 0;
 
@@ -399,6 +409,9 @@ int TcpReassembler::flush_data_segments(TcpReassemblerState& trs, uint32_t flush
         {
             pdu->data = sb.data;
             pdu->dsize = sb.length;
+
+            if ( sb.data == tsn->payload() )
+                tcpStats.in_place_flushes++;
         }
 
         total_flushed += bytes_copied;
@@ -1131,52 +1144,8 @@ void TcpReassembler::insert_segment_in_empty_seglist(
 void TcpReassembler::init_overlap_editor(
     TcpReassemblerState& trs, TcpSegmentDescriptor& tsd)
 {
-    TcpSegmentNode* left = nullptr, *right = nullptr, *tsn = nullptr;
-    int32_t dist_head = 0, dist_tail = 0;
-
-    if ( trs.sos.seglist.head && trs.sos.seglist.tail )
-    {
-        if ( SEQ_GT(tsd.get_seq(), trs.sos.seglist.head->i_seq) )
-            dist_head = tsd.get_seq() - trs.sos.seglist.head->i_seq;
-        else
-            dist_head = trs.sos.seglist.head->i_seq - tsd.get_seq();
-
-        if ( SEQ_GT(tsd.get_seq(), trs.sos.seglist.tail->i_seq) )
-            dist_tail = tsd.get_seq() - trs.sos.seglist.tail->i_seq;
-        else
-            dist_tail = trs.sos.seglist.tail->i_seq - tsd.get_seq();
-    }
-
-    if ( SEQ_LEQ(dist_head, dist_tail) )
-    {
-        for ( tsn = trs.sos.seglist.head; tsn; tsn = tsn->next )
-        {
-            right = tsn;
-
-            if ( SEQ_GEQ(right->i_seq, tsd.get_seq() ) )
-                break;
-
-            left = right;
-        }
-
-        if ( tsn == nullptr )
-            right = nullptr;
-    }
-    else
-    {
-        for ( tsn = trs.sos.seglist.tail; tsn; tsn = tsn->prev )
-        {
-            left = tsn;
-
-            if ( SEQ_LT(left->i_seq, tsd.get_seq() ) )
-                break;
-
-            right = left;
-        }
-
-        if (tsn == nullptr)
-            left = nullptr;
-    }
+    TcpSegmentNode* left = trs.sos.seglist.find_left(tsd.get_seq());
+    TcpSegmentNode* right = left ? left->next : trs.sos.seglist.head;
 
     trs.sos.init_soe(tsd, left, right);
 }
@@ -93,6 +93,8 @@ TcpSegmentNode* TcpSegmentNode::create(
     memcpy(tsn->data, payload, len);
 
     tsn->prev = tsn->next = nullptr;
+    tsn->skip = nullptr;
+    tsn->height = 1;
     tsn->i_seq = tsn->c_seq = 0;
     tsn->offset = 0;
     tsn->ts = 0;
@@ -112,6 +114,13 @@ TcpSegmentNode* TcpSegmentNode::init(TcpSegmentNode& tns)
 
 void TcpSegmentNode::term()
 {
+    if ( skip )
+    {
+        snort_free(skip);
+        skip = nullptr;
+        height = 1;
+    }
+
 #ifdef USE_RESERVE
     if ( size == res_max and reserve_sz < num_res )
     {
@@ -152,3 +161,98 @@ bool TcpSegmentNode::is_retransmit(const uint8_t* rdata, uint16_t rsize,
 
     return false;
 }
+
+//-------------------------------------------------------------------------
+// TcpSegmentList index
+//-------------------------------------------------------------------------
+
+static THREAD_LOCAL uint32_t skip_rand = 2463534242;
+
+// each level holds 1/4 of the segments in the level below
+static unsigned random_height()
+{
+    skip_rand ^= skip_rand << 13;
+    skip_rand ^= skip_rand >> 17;
+    skip_rand ^= skip_rand << 5;
+
+    uint32_t r = skip_rand;
+    unsigned h = 1;
+
+    while ( !(r & 0x3) and h < TcpSegmentList::max_height )
+    {
+        ++h;
+        r >>= 2;
+    }
+    return h;
+}
+
+TcpSegmentNode* TcpSegmentList::find_left(uint32_t seq) const
+{
+    TcpSegmentNode* left = nullptr;
+    TcpSegmentNode* n;
+
+    for ( unsigned lvl = height; lvl-- > 0; )
+    {
+        while ( (n = next_at(left, lvl)) and SEQ_LT(n->i_seq, seq) )
+            left = n;
+    }
+    return left;
+}
+
+void TcpSegmentList::link(TcpSegmentNode* ss)
+{
+    unsigned h = random_height();
+
+    // segments with the same i_seq (split for overlaps) are only in the
+    // list so a search by i_seq can't land between them
+    if ( h == 1 or (ss->prev and ss->prev->i_seq == ss->i_seq) or
+        (ss->next and ss->next->i_seq == ss->i_seq) )
+        return;
+
+    ss->skip = (TcpSegmentNode**)snort_calloc(h - 1, sizeof(*ss->skip));
+    ss->height = h;
+
+    if ( h > height )
+        height = h;
+
+    TcpSegmentNode* left = nullptr;
+    TcpSegmentNode* n;
+
+    for ( unsigned lvl = height - 1; lvl > 0; --lvl )
+    {
+        while ( (n = next_at(left, lvl)) and SEQ_LT(n->i_seq, ss->i_seq) )
+            left = n;
+
+        if ( lvl < h )
+        {
+            ss->skip[lvl - 1] = n;
+            set_next_at(left, lvl, ss);
+        }
+    }
+}
+
+void TcpSegmentList::unlink(TcpSegmentNode* ss)
+{
+    TcpSegmentNode* left = nullptr;
+    TcpSegmentNode* n;
+
+    for ( unsigned lvl = height - 1; lvl > 0; --lvl )
+    {
+        while ( (n = next_at(left, lvl)) and n != ss and SEQ_LT(n->i_seq, ss->i_seq) )
+            left = n;
+
+        if ( lvl >= ss->height )
+            continue;
+
+        while ( (n = next_at(left, lvl)) != ss )
+        {
+            assert(n);
+            left = n;
+        }
+
+        set_next_at(left, lvl, ss->skip[lvl - 1]);
+    }
+
+    while ( height > 1 and !skip_head[height - 1] )
+        --height;
+}
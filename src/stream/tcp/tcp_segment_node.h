@@ -64,6 +64,7 @@ public:
 public:
     TcpSegmentNode* prev;
     TcpSegmentNode* next;
+    TcpSegmentNode** skip;      // TcpSegmentList index links for levels 1 .. height - 1
 
     struct timeval tv;
     uint32_t ts;
@@ -73,12 +74,25 @@ public:
     uint16_t c_len;             // length of data remaining for reassembly
     uint16_t offset;
     uint16_t size;              // actual allocated size (overlaps cause i_len to differ)
+    uint8_t height;
     uint8_t data[1];
 };
 
+// the index link and height took the header from 56 to 64 bytes on 64 bit
+// builds; the links for higher levels are allocated separately so it stays there
+static_assert(sizeof(TcpSegmentNode) <= 64, "TcpSegmentNode header grew");
+
+//-----------------------------------------------------------------
+// the segments are kept in a list ordered by i_seq with a skip list
+// index over it so the insertion point for out of order segments is
+// found in log time.  the list links are the bottom level of the index.
+//-----------------------------------------------------------------
+
 class TcpSegmentList
 {
 public:
+    static constexpr unsigned max_height = 12;
+
     uint32_t reset()
     {
         int i = 0;
@@ -93,9 +107,17 @@ public:
 
         head = tail = cur_rseg = cur_sseg = nullptr;
         count = 0;
+
+        for ( auto& sh : skip_head )
+            sh = nullptr;
+        height = 1;
+
         return i;
     }
 
+    // last segment with i_seq before seq or nullptr if none
+    TcpSegmentNode* find_left(uint32_t seq) const;
+
     void insert(TcpSegmentNode* prev, TcpSegmentNode* ss)
     {
         if ( prev )
@@ -121,10 +143,14 @@ public:
         }
 
         count++;
+        link(ss);
     }
 
     void remove(TcpSegmentNode* ss)
     {
+        if ( ss->height > 1 )
+            unlink(ss);
+
         if ( ss->prev )
             ss->prev->next = ss->next;
         else
@@ -143,6 +169,29 @@ public:
     TcpSegmentNode* cur_rseg = nullptr;
     TcpSegmentNode* cur_sseg = nullptr;
     uint32_t count = 0;
+
+private:
+    TcpSegmentNode* next_at(TcpSegmentNode* tsn, unsigned lvl) const
+    {
+        if ( !lvl )
+            return tsn ? tsn->next : head;
+
+        return tsn ? tsn->skip[lvl - 1] : skip_head[lvl];
+    }
+
+    void set_next_at(TcpSegmentNode* tsn, unsigned lvl, TcpSegmentNode* n)
+    {
+        if ( tsn )
+            tsn->skip[lvl - 1] = n;
+        else
+            skip_head[lvl] = n;
+    }
+
+    void link(TcpSegmentNode*);
+    void unlink(TcpSegmentNode*);
+
+    TcpSegmentNode* skip_head[max_height] = { };  // level 0 is head
+    unsigned height = 1;
 };
 
 #endif
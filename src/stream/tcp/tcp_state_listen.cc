@@ -141,7 +141,7 @@ bool TcpStateListen::data_seg_sent(TcpSegmentDescriptor& tsd, TcpStreamTracker&
         if ( !Stream::is_midstream(flow) )
         {
             flow->set_session_flags(SSNFLAG_MIDSTREAM);
-            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT, tsd.get_pkt());
+            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT_ID, tsd.get_pkt());
         }
 
         trk.init_on_data_seg_sent(tsd);
@@ -168,7 +168,7 @@ bool TcpStateListen::data_seg_recv(TcpSegmentDescriptor& tsd, TcpStreamTracker&
         if ( !Stream::is_midstream(flow) )
         {
             flow->set_session_flags(SSNFLAG_MIDSTREAM);
-            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT, tsd.get_pkt());
+            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT_ID, tsd.get_pkt());
         }
         trk.init_on_data_seg_recv(tsd);
         trk.normalizer.ecn_tracker(tsd.get_tcph(), trk.session->tcp_config->require_3whs());
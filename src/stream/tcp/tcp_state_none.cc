@@ -137,7 +137,7 @@ bool TcpStateNone::data_seg_sent(TcpSegmentDescriptor& tsd, TcpStreamTracker& tr
         if ( !Stream::is_midstream(flow) )
         {
             flow->set_session_flags(SSNFLAG_MIDSTREAM);
-            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT, tsd.get_pkt());
+            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT_ID, tsd.get_pkt());
         }
 
         trk.init_on_data_seg_sent(tsd);
@@ -164,7 +164,7 @@ bool TcpStateNone::data_seg_recv(TcpSegmentDescriptor& tsd, TcpStreamTracker& tr
         if ( !Stream::is_midstream(flow) )
         {
             flow->set_session_flags(SSNFLAG_MIDSTREAM);
-            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT, tsd.get_pkt());
+            DataBus::publish(STREAM_TCP_MIDSTREAM_EVENT_ID, tsd.get_pkt());
         }
 
         trk.init_on_data_seg_recv(tsd);
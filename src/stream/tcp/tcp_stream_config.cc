@@ -38,6 +38,7 @@ TcpStreamConfig::TcpStreamConfig() = default;
 void TcpStreamConfig::show() const
 {
     ConfigLogger::log_value("flush_factor", flush_factor);
+    ConfigLogger::log_flag("flush_in_place", (flags & STREAM_CONFIG_IN_PLACE_FLUSH));
     ConfigLogger::log_value("max_pdu", paf_max);
     ConfigLogger::log_value("max_window", max_window);
     ConfigLogger::log_flag("no_ack", no_ack);
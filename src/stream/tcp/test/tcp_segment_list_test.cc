@@ -0,0 +1,254 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2021-2021 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// tcp_segment_list_test.cc author Russ Combs <rucombs@cisco.com>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+
+#include "stream/tcp/tcp_module.h"
+#include "stream/tcp/tcp_segment_node.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+THREAD_LOCAL TcpStats tcpStats;
+
+//-------------------------------------------------------------------------
+// helpers
+//-------------------------------------------------------------------------
+
+// seqs start near the top so the list wraps
+static const uint32_t base_seq = 0xfffff000;
+
+static TcpSegmentNode* make_node(uint32_t seq)
+{
+    alignas(TcpSegmentNode) uint8_t buf[sizeof(TcpSegmentNode)] = { };
+    TcpSegmentNode* tmpl = (TcpSegmentNode*)buf;
+    tmpl->c_len = 1;
+
+    TcpSegmentNode* tsn = TcpSegmentNode::init(*tmpl);
+    tsn->i_seq = tsn->c_seq = seq;
+    return tsn;
+}
+
+// the linear equivalent of find_left
+static TcpSegmentNode* walk_left(const TcpSegmentList& seglist, uint32_t seq)
+{
+    TcpSegmentNode* left = nullptr;
+
+    for ( TcpSegmentNode* tsn = seglist.head; tsn and SEQ_LT(tsn->i_seq, seq); tsn = tsn->next )
+        left = tsn;
+
+    return left;
+}
+
+// add in the same place the reassembler would
+static TcpSegmentNode* add(TcpSegmentList& seglist, uint32_t seq)
+{
+    TcpSegmentNode* tsn = make_node(seq);
+    seglist.insert(seglist.find_left(seq), tsn);
+    return tsn;
+}
+
+static void check_order(const TcpSegmentList& seglist)
+{
+    unsigned n = 0;
+    TcpSegmentNode* prev = nullptr;
+
+    for ( TcpSegmentNode* tsn = seglist.head; tsn; tsn = tsn->next )
+    {
+        CHECK(tsn->prev == prev);
+
+        if ( prev )
+            CHECK(!SEQ_LT(tsn->i_seq, prev->i_seq));
+
+        prev = tsn;
+        ++n;
+    }
+    CHECK(seglist.tail == prev);
+    CHECK(seglist.count == n);
+}
+
+static void check_find(const TcpSegmentList& seglist, uint32_t end)
+{
+    for ( uint32_t seq = base_seq - 1; seq != end + 2; ++seq )
+        CHECK(seglist.find_left(seq) == walk_left(seglist, seq));
+}
+
+//-------------------------------------------------------------------------
+// tests
+//-------------------------------------------------------------------------
+
+TEST_GROUP(tcp_segment_list)
+{
+    TcpSegmentList seglist;
+
+    void setup() override
+    { TcpSegmentNode::setup(); }
+
+    void teardown() override
+    {
+        seglist.reset();
+        TcpSegmentNode::clear();
+    }
+};
+
+TEST(tcp_segment_list, empty)
+{
+    CHECK(!seglist.find_left(base_seq));
+    CHECK(!seglist.head);
+    CHECK(!seglist.tail);
+}
+
+TEST(tcp_segment_list, in_order)
+{
+    const unsigned n = 2000;
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        TcpSegmentNode* tsn = add(seglist, base_seq + 2 * i);
+        CHECK(seglist.tail == tsn);
+    }
+
+    check_order(seglist);
+    check_find(seglist, base_seq + 2 * n);
+}
+
+TEST(tcp_segment_list, out_of_order)
+{
+    // a permutation of the even offsets
+    const unsigned n = 2000;
+
+    for ( unsigned i = 0; i < n; ++i )
+        add(seglist, base_seq + 2 * ((i * 7919) % n));
+
+    check_order(seglist);
+    check_find(seglist, base_seq + 2 * n);
+
+    // each lands on the previous one
+    for ( unsigned i = n; i > 0; --i )
+    {
+        TcpSegmentNode* tsn = add(seglist, base_seq + 2 * i - 1);
+        CHECK(tsn->prev and tsn->prev->i_seq == base_seq + 2 * i - 2);
+    }
+
+    check_order(seglist);
+    check_find(seglist, base_seq + 2 * n);
+}
+
+TEST(tcp_segment_list, overlap)
+{
+    // segments split for overlaps share i_seq and stay in arrival order
+    const unsigned n = 500;
+
+    for ( unsigned i = 0; i < n; ++i )
+        add(seglist, base_seq + 4 * i);
+
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        uint32_t seq = base_seq + 4 * i;
+        TcpSegmentNode* left = seglist.find_left(seq);
+        TcpSegmentNode* orig = left ? left->next : seglist.head;
+        CHECK(orig->i_seq == seq);
+
+        TcpSegmentNode* split = make_node(seq);
+        seglist.insert(orig, split);
+        CHECK(split->height == 1);
+        CHECK(orig->next == split);
+    }
+
+    check_order(seglist);
+    check_find(seglist, base_seq + 4 * n);
+
+    // a search by i_seq lands before the first of the group
+    for ( unsigned i = 1; i < n; ++i )
+    {
+        TcpSegmentNode* left = seglist.find_left(base_seq + 4 * i);
+        CHECK(left->i_seq == base_seq + 4 * (i - 1));
+        CHECK(left->next->i_seq == base_seq + 4 * i);
+    }
+}
+
+TEST(tcp_segment_list, unlink_head_tail)
+{
+    const unsigned n = 1000;
+
+    for ( unsigned i = 0; i < n; ++i )
+        add(seglist, base_seq + 2 * i);
+
+    // drop from both ends so every tower is taken out of the index
+    for ( unsigned i = 0; i < n / 2; ++i )
+    {
+        TcpSegmentNode* tsn = seglist.head;
+        seglist.remove(tsn);
+        tsn->term();
+
+        tsn = seglist.tail;
+        seglist.remove(tsn);
+        tsn->term();
+
+        if ( !(i % 50) )
+        {
+            check_order(seglist);
+            check_find(seglist, base_seq + 2 * n);
+        }
+    }
+
+    CHECK(!seglist.head);
+    CHECK(!seglist.tail);
+    CHECK(!seglist.count);
+    CHECK(!seglist.find_left(base_seq + 2 * n));
+
+    // the emptied index is still usable
+    add(seglist, base_seq + 10);
+    add(seglist, base_seq);
+    CHECK(seglist.head->i_seq == base_seq);
+    CHECK(seglist.find_left(base_seq + 5) == seglist.head);
+}
+
+TEST(tcp_segment_list, unlink_middle)
+{
+    const unsigned n = 1000;
+    std::vector<TcpSegmentNode*> v;
+
+    for ( unsigned i = 0; i < n; ++i )
+        v.emplace_back(add(seglist, base_seq + 2 * i));
+
+    for ( unsigned i = 1; i < n; i += 2 )
+    {
+        seglist.remove(v[i]);
+        v[i]->term();
+    }
+
+    check_order(seglist);
+    check_find(seglist, base_seq + 2 * n);
+    CHECK(seglist.count == n / 2);
+}
+
+//-------------------------------------------------------------------------
+// main
+//-------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
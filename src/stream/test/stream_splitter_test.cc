@@ -165,6 +165,24 @@ TEST(other_splitter, stop_and_wait)
     CHECK(flushed == 2);
 }
 
+TEST(other_splitter, reassemble_in_place)
+{
+    LogSplitter s(true);
+    const uint8_t data[] = "in place";
+    unsigned copied = 0;
+
+    StreamBuffer sb = s.reassemble(nullptr, sizeof(data), 0, data, sizeof(data),
+        PKT_PDU_HEAD | PKT_PDU_TAIL | PKT_PDU_IN_PLACE, copied);
+
+    CHECK(sb.data == data);
+    CHECK(sb.length == sizeof(data));
+    CHECK(copied == sizeof(data));
+
+    sb = s.reassemble(nullptr, 0, 0, nullptr, 0, PKT_PDU_IN_PLACE, copied);
+    CHECK(sb.data == nullptr);
+    CHECK(copied == 0);
+}
+
 //-------------------------------------------------------------------------
 // main
 //-------------------------------------------------------------------------
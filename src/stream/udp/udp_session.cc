@@ -89,7 +89,7 @@ static int ProcessUdp(Flow* lwssn, Packet* p, StreamUdpConfig*)
             (lwssn->ssn_state.session_flags & SSNFLAG_SEEN_RESPONDER))
         {
             lwssn->ssn_state.session_flags |= SSNFLAG_ESTABLISHED;
-            DataBus::publish(STREAM_UDP_BIDIRECTIONAL_EVENT, p);
+            DataBus::publish(STREAM_UDP_BIDIRECTIONAL_EVENT_ID, p);
         }
     }
 
@@ -124,7 +124,7 @@ bool UdpSession::setup(Packet* p)
 
     SESSION_STATS_ADD(udpStats)
 
-    DataBus::publish(FLOW_STATE_EVENT, p);
+    DataBus::publish(FLOW_STATE_EVENT_ID, p);
 
     if ( flow->ssn_state.ignore_direction != SSN_DIR_NONE )
     {
@@ -93,6 +93,12 @@ void LogCount(const char* s, uint64_t c, FILE* fh)
     }
 }
 
+void LogTime(const char* s, uint64_t usecs, FILE* fh)
+{
+    LogfRespond(s_ctrlcon, fh, "%25.25s: " STDu64 ".%06u\n", s,
+        usecs / 1000000, (unsigned)(usecs % 1000000));
+}
+
 void LogStat(const char* s, uint64_t n, uint64_t tot, FILE* fh)
 {
     if ( n )
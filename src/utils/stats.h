@@ -105,6 +105,7 @@ SO_PUBLIC void LogLabel(const char*, FILE* = stdout);
 SO_PUBLIC void LogText(const char*, FILE* = stdout);
 SO_PUBLIC void LogValue(const char*, const char*, FILE* = stdout);
 SO_PUBLIC void LogCount(const char*, uint64_t, FILE* = stdout);
+SO_PUBLIC void LogTime(const char*, uint64_t usecs, FILE* = stdout);
 
 SO_PUBLIC void LogStat(const char*, uint64_t n, uint64_t tot, FILE* = stdout);
 SO_PUBLIC void LogStat(const char*, double, FILE* = stdout);